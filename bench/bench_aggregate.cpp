@@ -0,0 +1,83 @@
+/*
+ * bench_aggregate.cpp - part of the ESP32-ANDRTF3 library
+ *
+ * Copyright (C) 2025-2026 packerlschupfer
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+
+/*
+ * Aggregation kernel throughput (host)
+ *
+ * Runs accumulateScalar() and accumulate() over one 30-day column per
+ * sensor at a 5 min interval (4000 sensors by default, about 1% missing
+ * samples). Prints the best of five runs for each kernel. The results
+ * must match.
+ *
+ *   g++ -std=gnu++17 -O2 -Isrc -I<host include dir> bench/bench_aggregate.cpp \
+ *       src/ANDRTF3Aggregate.cpp src/ANDRTF3History.cpp -o bench_aggregate
+ *   ./bench_aggregate [sensors]
+ */
+
+#include "ANDRTF3Aggregate.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+using namespace andrtf3;
+
+typedef void (*Kernel)(const int16_t*, size_t, int16_t, int16_t, AggregateStats&);
+
+static AggregateStats run(const char* name, Kernel kernel, const std::vector<int16_t>& column) {
+    AggregateStats stats;
+    double bestMs = 1e9;
+    for (int r = 0; r < 5; r++) {
+        stats.clear();
+        auto t0 = std::chrono::steady_clock::now();
+        kernel(column.data(), column.size(), 200, 240, stats);
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+        if (ms < bestMs) bestMs = ms;
+    }
+    printf("%-8s %8.2f ms %7.2f Gsamples/s  mean=%d min=%d max=%d n=%u band=%u\n",
+           name, bestMs, column.size() / bestMs / 1e6, stats.mean(), stats.min, stats.max,
+           (unsigned)stats.count, (unsigned)stats.inBand);
+    return stats;
+}
+
+int main(int argc, char** argv) {
+    const size_t sensors = argc > 1 ? (size_t)atoi(argv[1]) : 4000;
+    const size_t samples = sensors * 8640u;    // 30 days at 5 min
+
+    std::vector<int16_t> column(samples);
+    srand(1);
+    for (size_t i = 0; i < samples; i++) {
+        column[i] = (rand() % 97 == 0) ? Aggregator::INVALID_SAMPLE : (int16_t)(150 + rand() % 150);
+    }
+
+    printf("%zu sensors, %zu samples\n", sensors, samples);
+    AggregateStats scalar = run("scalar", Aggregator::accumulateScalar, column);
+    AggregateStats fast = run(Aggregator::kernelName(), Aggregator::accumulate, column);
+
+    if (scalar.sum != fast.sum || scalar.count != fast.count || scalar.min != fast.min ||
+        scalar.max != fast.max || scalar.inBand != fast.inBand) {
+        printf("MISMATCH between kernels\n");
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,107 @@
+/*
+ * bench_executor.cpp - part of the ESP32-ANDRTF3 library
+ *
+ * Copyright (C) 2025-2026 packerlschupfer
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+
+/*
+ * StageExecutor scaling curve (Linux host)
+ *
+ * Pushes the same reading stream through an inline loop and through a
+ * StageExecutor with 1, 2, 4 ... workers, and prints throughput and
+ * speed-up for each worker count. Build from the repository root:
+ *
+ *   g++ -std=gnu++17 -O2 -Isrc -I<host include dir> \
+ *       bench/bench_executor.cpp src/ANDRTF3Executor.cpp -lpthread -o bench_executor
+ *   ./bench_executor [readings] [stage cost] [max workers]
+ *
+ * Defaults: 400000 readings, a stage cost of 400 hash rounds per reading
+ * and max workers = 2 x hardware concurrency. See bench/README.md.
+ */
+
+#include "ANDRTF3Executor.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+
+using namespace andrtf3;
+using Clock = std::chrono::steady_clock;
+
+static volatile uint32_t sink;
+static int stageCost = 400;
+
+// Stand-in for a rollup or filter: a fixed amount of work per reading
+static void stage(const GatewayReading& reading, void*) {
+    uint32_t h = (uint32_t)reading.celsius;
+    for (int i = 0; i < stageCost; i++) h = h * 2654435761u + (uint32_t)i;
+    sink = h;
+}
+
+static GatewayReading makeReading(int i) {
+    GatewayReading r = {};
+    r.address = (uint8_t)(i & 0xFF);
+    r.bus = (uint16_t)((i >> 8) & 0x0F);
+    r.celsius = (int16_t)(200 + (i & 0x3F));
+    return r;
+}
+
+static double seconds(Clock::time_point start) {
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+int main(int argc, char** argv) {
+    const int readings = argc > 1 ? atoi(argv[1]) : 400000;
+    stageCost = argc > 2 ? atoi(argv[2]) : 400;
+    const unsigned cores = std::thread::hardware_concurrency();
+    const int maxWorkers = argc > 3 ? atoi(argv[3]) : (int)(cores ? 2 * cores : 8);
+
+    printf("%d readings, stage cost %d, %u hardware threads\n", readings, stageCost, cores);
+
+    Clock::time_point t0 = Clock::now();
+    for (int i = 0; i < readings; i++) stage(makeReading(i), nullptr);
+    const double inlineSec = seconds(t0);
+    printf("%-8s %10s %10s %10s %10s\n", "workers", "k/s", "vs inline", "vs 1", "steals");
+    printf("%-8s %10.0f %10.2f %10s %10s\n", "inline", readings / inlineSec / 1000, 1.0, "-", "-");
+
+    double oneWorkerSec = 0;
+    for (int workers = 1; workers <= maxWorkers; workers *= 2) {
+        StageExecutor::Config config = StageExecutor::getDefaultConfig();
+        config.workers = (uint8_t)workers;
+        config.mailboxDepth = 4096;
+        StageExecutor executor(config);
+        if (!executor.addStage(stage, nullptr)) return 1;
+        executor.start();
+
+        t0 = Clock::now();
+        for (int i = 0; i < readings; i++) {
+            GatewayReading r = makeReading(i);
+            while (!executor.submit(r)) std::this_thread::yield();
+        }
+        executor.drain();
+        const double sec = seconds(t0);
+        if (workers == 1) oneWorkerSec = sec;
+
+        printf("%-8d %10.0f %10.2f %10.2f %10lu\n", workers, readings / sec / 1000,
+               inlineSec / sec, oneWorkerSec / sec, (unsigned long)executor.getStats().steals);
+        executor.stop();
+    }
+    return 0;
+}
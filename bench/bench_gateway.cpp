@@ -0,0 +1,104 @@
+/*
+ * bench_gateway.cpp - part of the ESP32-ANDRTF3 library
+ *
+ * Copyright (C) 2025-2026 packerlschupfer
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+
+/*
+ * Gateway CPU cost per bus (Linux host)
+ *
+ * Starts one RtuTcpEmulator per bus on loopback, each answering after a
+ * fixed service time, and lets one Gateway poll them all. After a one
+ * second warm-up it samples Gateway::Stats for three seconds and prints
+ * the read rate and the CPU time used by the loop thread and the workers.
+ *
+ *   g++ -std=gnu++17 -O2 -Isrc -I<host include dir> \
+ *       bench/bench_gateway.cpp <every .cpp in src> -lpthread -o bench_gateway
+ *   ./bench_gateway [buses] [service us] [sensors per bus] [workers]
+ *
+ * Defaults: 64 buses, 20000 us service time, 8 sensors per bus, 2 workers.
+ */
+
+#include "ANDRTF3Gateway.h"
+#include "ANDRTF3RtuTcp.h"
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <unistd.h>
+#include <vector>
+
+using namespace andrtf3;
+
+static std::atomic<uint64_t> received{0};
+
+static void onReading(const GatewayReading&, void*) {
+    received.fetch_add(1, std::memory_order_relaxed);
+}
+
+int main(int argc, char** argv) {
+    const int buses = argc > 1 ? atoi(argv[1]) : 64;
+    const int serviceUs = argc > 2 ? atoi(argv[2]) : 20000;
+    const int perBus = argc > 3 ? atoi(argv[3]) : 8;
+    const int workers = argc > 4 ? atoi(argv[4]) : 2;
+    const int windowSec = 3;
+
+    Gateway::Config config = Gateway::getDefaultConfig();
+    config.workers = (uint8_t)workers;
+    Gateway gateway(config);
+    gateway.setSink(onReading, nullptr);
+
+    std::vector<std::unique_ptr<RtuTcpEmulator>> emulators;
+    for (int b = 0; b < buses; b++) {
+        emulators.emplace_back(new RtuTcpEmulator());
+        RtuTcpEmulator& emulator = *emulators.back();
+        if (!emulator.start()) {
+            fprintf(stderr, "emulator %d failed to start\n", b);
+            return 1;
+        }
+        emulator.setServiceTimeUs((uint32_t)serviceUs);
+        for (int unit = 1; unit <= perBus; unit++) emulator.setRegister((uint8_t)unit, 50, (uint16_t)(200 + unit));
+
+        int bus = gateway.addTcpBus("127.0.0.1", emulator.getPort());
+        if (bus < 0) {
+            fprintf(stderr, "addTcpBus failed at bus %d\n", b);
+            return 1;
+        }
+        for (int unit = 1; unit <= perBus; unit++) gateway.addSensor(bus, (uint8_t)unit, 1);
+    }
+
+    gateway.start();
+    sleep(1);
+    Gateway::Stats s0 = gateway.getStats();
+    sleep(windowSec);
+    Gateway::Stats s1 = gateway.getStats();
+    gateway.stop();
+
+    const double reads = (double)(s1.responses - s0.responses) / windowSec;
+    const double loopCpu = (double)(s1.loopCpuUs - s0.loopCpuUs) / windowSec / 1e6;
+    const double workerCpu = (double)(s1.workerCpuUs - s0.workerCpuUs) / windowSec / 1e6;
+    const double cpuMsPer1000 = reads > 0 ? (loopCpu + workerCpu) * 1e6 / reads : 0;
+
+    printf("%d buses x %d sensors, service %d us, %d workers\n", buses, perBus, serviceUs, workers);
+    printf("%.0f reads/s, loop %.1f%% worker %.1f%% of a core\n", reads, loopCpu * 100, workerCpu * 100);
+    printf("%.2f ms CPU per 1000 reads, timeouts %lu dropped %lu, sink %lu\n", cpuMsPer1000,
+           (unsigned long)s1.timeouts, (unsigned long)s1.dropped, (unsigned long)received.load());
+    return 0;
+}
@@ -0,0 +1,147 @@
+/*
+ * bench_snapshot.cpp - part of the ESP32-ANDRTF3 library
+ *
+ * Copyright (C) 2025-2026 packerlschupfer
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+
+/*
+ * FleetSnapshot query cost (Linux host)
+ *
+ * A writer process publishes into a shared-memory FleetSnapshot every
+ * 50 us, far faster than any real bus. The reader then compares:
+ *   - read() of the whole table straight from shared memory (seqlock),
+ *   - the same table fetched over a Unix socket from a server process
+ *     (the copy-out path the snapshot replaces),
+ *   - readOne() of a single record.
+ *
+ *   g++ -std=gnu++17 -O2 -Isrc -I<host include dir> \
+ *       bench/bench_snapshot.cpp src/ANDRTF3Snapshot.cpp -o bench_snapshot
+ *   ./bench_snapshot [sensors] [queries]
+ */
+
+#include "ANDRTF3Snapshot.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+
+using namespace andrtf3;
+using Clock = std::chrono::steady_clock;
+
+static const char* SHM_NAME = "/andrtf3-bench";
+
+static double usPer(Clock::time_point start, Clock::time_point end, int n) {
+    return std::chrono::duration<double, std::micro>(end - start).count() / n;
+}
+
+static bool readAll(int fd, void* buf, size_t bytes) {
+    size_t got = 0;
+    while (got < bytes) {
+        ssize_t k = read(fd, (char*)buf + got, bytes - got);
+        if (k <= 0) return false;
+        got += (size_t)k;
+    }
+    return true;
+}
+
+static bool writeAll(int fd, const void* buf, size_t bytes) {
+    size_t off = 0;
+    while (off < bytes) {
+        ssize_t k = write(fd, (const char*)buf + off, bytes - off);
+        if (k <= 0) return false;
+        off += (size_t)k;
+    }
+    return true;
+}
+
+int main(int argc, char** argv) {
+    const int sensors = argc > 1 ? atoi(argv[1]) : 1000;
+    const int queries = argc > 2 ? atoi(argv[2]) : 20000;
+
+    FleetSnapshot writer;
+    FleetSnapshot::unlinkShared(SHM_NAME);
+    if (!writer.createShared(SHM_NAME, (uint16_t)sensors)) {
+        fprintf(stderr, "createShared failed\n");
+        return 1;
+    }
+    for (int i = 0; i < sensors; i++) writer.publish(i, (uint8_t)(i & 0xFF), 200, true, 0);
+
+    int sv[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, sv) != 0) return 1;
+
+    pid_t writerPid = fork();
+    if (writerPid == 0) {
+        for (uint32_t t = 0;; t++) {
+            writer.publish(t % sensors, 1, (int16_t)(t & 511), true, t);
+            usleep(50);
+        }
+    }
+
+    pid_t serverPid = fork();
+    if (serverPid == 0) {
+        FleetSnapshot view;
+        if (!view.openShared(SHM_NAME)) _exit(1);
+        std::vector<FleetSnapshot::Record> records(sensors);
+        char q;
+        while (read(sv[1], &q, 1) == 1) {
+            size_t n = view.read(records.data(), records.size());
+            if (!writeAll(sv[1], records.data(), n * sizeof(FleetSnapshot::Record))) break;
+        }
+        _exit(0);
+    }
+
+    FleetSnapshot reader;
+    if (!reader.openShared(SHM_NAME)) return 1;
+    std::vector<FleetSnapshot::Record> records(sensors);
+    const size_t tableBytes = sensors * sizeof(FleetSnapshot::Record);
+    long sum = 0;
+
+    Clock::time_point t0 = Clock::now();
+    for (int i = 0; i < queries; i++) sum += (long)reader.read(records.data(), records.size());
+    Clock::time_point t1 = Clock::now();
+    for (int i = 0; i < queries; i++) {
+        char q = 1;
+        if (write(sv[0], &q, 1) != 1 || !readAll(sv[0], records.data(), tableBytes)) break;
+        sum += (long)tableBytes;
+    }
+    Clock::time_point t2 = Clock::now();
+    for (int i = 0; i < queries; i++) {
+        FleetSnapshot::Record one;
+        sum += reader.readOne(i % sensors, one);
+    }
+    Clock::time_point t3 = Clock::now();
+
+    printf("%d sensors, %d queries\n", sensors, queries);
+    printf("seqlock full read: %8.2f us/query (retries %u)\n", usPer(t0, t1, queries), reader.getRetryCount());
+    printf("socket full query: %8.2f us/query\n", usPer(t1, t2, queries));
+    printf("seqlock readOne:   %8.3f us/query\n", usPer(t2, t3, queries));
+
+    kill(writerPid, SIGKILL);
+    close(sv[0]);
+    kill(serverPid, SIGKILL);
+    waitpid(writerPid, nullptr, 0);
+    waitpid(serverPid, nullptr, 0);
+    FleetSnapshot::unlinkShared(SHM_NAME);
+    return sum == 0;
+}
@@ -100,7 +100,7 @@ void setup() {
     }
 
     Serial.println("\nSetup complete. Reading every 5 seconds.");
-    Serial.println("Press 's' for status, 'a' to toggle async mode\n");
+    Serial.println("Press 's' for status, 'a' to toggle async mode, 'i' to read via IDeviceInstance\n");
 }
 
 // =============================================================================
@@ -171,8 +171,21 @@ void loop() {
                 useAsyncMode = !useAsyncMode;
                 Serial.printf("\nAsync mode: %s\n", useAsyncMode ? "ON" : "OFF");
                 break;
+            case 'i':
+            case 'I': {
+                // Same read through the generic device interface a supervisor uses
+                IDeviceInstance& dev = *sensor;
+                dev.requestData();
+                if (dev.waitForData().isOk()) {
+                    auto data = dev.getData(IDeviceInstance::DeviceDataType::TEMPERATURE);
+                    if (data.isOk()) Serial.printf("\nIDeviceInstance: %.1f C\n", data.value()[0]);
+                } else {
+                    Serial.println("\nIDeviceInstance: no data");
+                }
+                break;
+            }
             default:
-                Serial.println("\nCommands: s=status, a=toggle async");
+                Serial.println("\nCommands: s=status, a=toggle async, i=read via IDeviceInstance");
                 break;
         }
     }
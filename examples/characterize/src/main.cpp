@@ -0,0 +1,169 @@
+/**
+ * ANDRTF3 Thermal Characterization
+ *
+ * Commissioning routine: polls one sensor at close to 10 Hz, measures the
+ * noise floor while the sensor is left alone, then waits for a stimulus (a
+ * warm hand on the housing, a hair dryer, or carrying it to another room)
+ * and fits a first-order response. Prints the effective time constant,
+ * noise floor and a recommended poll interval, and the value to use as
+ * LagCompensator::Config::tauSeconds.
+ *
+ * With USE_EMULATOR set to 1 the same routine runs against a ThermalEmulator
+ * (no RS485 hardware needed) that steps the air temperature by 5°C.
+ *
+ * Hardware (USE_EMULATOR 0): same wiring as examples/basic.
+ */
+
+#include <Arduino.h>
+#include <ANDRTF3Characterizer.h>
+
+#define USE_EMULATOR     1
+
+#if !USE_EMULATOR
+#include <esp32ModbusRTU.h>
+#include <ModbusDevice.h>
+#include <ANDRTF3.h>
+#endif
+
+using namespace andrtf3;
+
+// =============================================================================
+// Configuration
+// =============================================================================
+
+#define POLL_INTERVAL_MS 100    // ~10 Hz, the sensor's practical maximum
+
+#if USE_EMULATOR
+#define EMU_TAU_MS       90000  // Emulated enclosure time constant
+#define EMU_NOISE_MILLI  30
+#define EMU_STEP_AT_MS   60000  // Stimulus 60 s in (after the 30 s baseline)
+#else
+#define RS485_RX_PIN     16
+#define RS485_TX_PIN     17
+#define RS485_BAUD       9600
+#define SENSOR_ADDRESS   3
+#endif
+
+// =============================================================================
+// Global Objects
+// =============================================================================
+
+static Characterizer characterizer;
+
+#if USE_EMULATOR
+static ThermalEmulator emulator(EMU_TAU_MS, 215, EMU_NOISE_MILLI);
+static uint32_t simTimeMs = 0;      // Emulated clock: runs the test faster than real time
+#else
+esp32ModbusRTU modbusMaster(&Serial1);
+static ANDRTF3* sensor = nullptr;
+
+extern void mainHandleData(uint8_t serverAddress, esp32Modbus::FunctionCode fc,
+                           uint16_t startingAddress, const uint8_t* data, size_t length);
+extern void handleError(uint8_t serverAddress, esp32Modbus::Error error);
+#endif
+
+static Characterizer::Phase lastPhase = Characterizer::Phase::FAILED;
+static bool reported = false;
+
+// Returns false if no reading was available this time
+static bool takeSample(int16_t& value, uint32_t& nowMs) {
+#if USE_EMULATOR
+    simTimeMs += POLL_INTERVAL_MS;
+    if (simTimeMs == EMU_STEP_AT_MS) {
+        emulator.setAir(265);
+    }
+    nowMs = simTimeMs;
+    value = emulator.read(nowMs);
+    return true;
+#else
+    nowMs = millis();
+    if (!sensor->readTemperature()) {
+        return false;
+    }
+    value = sensor->getTemperature();
+    return true;
+#endif
+}
+
+static void printReport() {
+    Characterizer::Report r = characterizer.getReport();
+    Serial.println("\n--- Characterization result ---");
+    Serial.printf("Status:            %s\n", characterizer.getPhaseName());
+    Serial.printf("Time constant:     %lu.%lu s\n",
+                  static_cast<unsigned long>(r.tauMs / 1000), static_cast<unsigned long>((r.tauMs % 1000) / 100));
+    Serial.printf("Noise floor (RMS): %u mdeg\n", r.noiseMilli);
+    Serial.printf("Baseline / step:   %d / %+d (deci-degrees)\n", r.baseline, r.stepDeci);
+    Serial.printf("Samples:           %lu at %u.%02u Hz\n",
+                  static_cast<unsigned long>(r.samples), r.sampleRateCentiHz / 100, r.sampleRateCentiHz % 100);
+    Serial.printf("Recommended poll:  %lu ms\n", static_cast<unsigned long>(r.recommendedPollMs));
+    Serial.printf("LagCompensator:    tauSeconds = %lu\n", static_cast<unsigned long>((r.tauMs + 500) / 1000));
+}
+
+// =============================================================================
+// Setup
+// =============================================================================
+
+void setup() {
+    Serial.begin(115200);
+    while (!Serial && millis() < 3000) delay(10);
+
+    Serial.println("\n=== ANDRTF3 Thermal Characterization ===");
+
+#if USE_EMULATOR
+    Serial.println("Running against the thermal emulator");
+    characterizer.begin(simTimeMs);
+#else
+    Serial1.begin(RS485_BAUD, SERIAL_8N1, RS485_RX_PIN, RS485_TX_PIN);
+    modbusMaster.onData([](uint8_t serverAddress, esp32Modbus::FunctionCode fc,
+                           uint16_t address, const uint8_t* data, size_t length) {
+        mainHandleData(serverAddress, fc, address, data, length);
+    });
+    modbusMaster.onError([](uint16_t /*serverAddress*/, esp32Modbus::Error error) {
+        handleError(0xFF, error);
+    });
+    modbusMaster.begin(1);
+
+    sensor = new ANDRTF3(SENSOR_ADDRESS);
+    ANDRTF3::Config config = sensor->getConfig();
+    config.timeout = 80;     // Keep up with 10 Hz polling
+    config.retries = 0;
+    sensor->setConfig(config);
+
+    Serial.println("Leave the sensor alone for the baseline...");
+    characterizer.begin(millis());
+#endif
+}
+
+// =============================================================================
+// Main Loop
+// =============================================================================
+
+void loop() {
+    if (reported) {
+        delay(1000);
+        return;
+    }
+
+    int16_t value;
+    uint32_t nowMs;
+    if (takeSample(value, nowMs)) {
+        Characterizer::Phase phase = characterizer.addSample(value, nowMs);
+        if (phase != lastPhase) {
+            Serial.printf("[%lu s] %s\n", static_cast<unsigned long>(nowMs / 1000), characterizer.getPhaseName());
+            lastPhase = phase;
+        }
+        if (phase == Characterizer::Phase::RESPONSE && (nowMs % 10000) < POLL_INTERVAL_MS) {
+            Serial.printf("[%lu s] %d.%d C, tau so far %lu ms\n", static_cast<unsigned long>(nowMs / 1000),
+                          value / 10, abs(value % 10),
+                          static_cast<unsigned long>(characterizer.getTauEstimateMs()));
+        }
+        if (phase == Characterizer::Phase::DONE || phase == Characterizer::Phase::FAILED) {
+            printReport();
+            reported = true;
+        }
+    }
+
+#if !USE_EMULATOR
+    delay(POLL_INTERVAL_MS);
+#endif
+}
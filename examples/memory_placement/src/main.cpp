@@ -0,0 +1,84 @@
+/**
+ * ANDRTF3 Memory Placement Benchmark
+ *
+ * Creates the same sensor twice, once with its cold state (config,
+ * statistics) in internal SRAM and once in PSRAM, and times readTemperature()
+ * against an in-memory transport so only driver code is measured. The hot
+ * state (reading, pending flags, timing) stays in internal SRAM both times,
+ * so the per-read latency should match.
+ *
+ * Needs a board with PSRAM (e.g. WROVER); without it both runs use internal
+ * SRAM. No RS485 hardware is needed.
+ */
+
+#include <Arduino.h>
+#include <ANDRTF3.h>
+#include <ANDRTF3Transport.h>
+#include <ANDRTF3Memory.h>
+
+using namespace andrtf3;
+
+// =============================================================================
+// Configuration
+// =============================================================================
+
+#define READS_PER_RUN    20000
+#define RUNS             5
+
+// Answers every read from memory: no bus time in the measurement
+class LoopbackTransport : public Transport {
+public:
+    const char* name() const override { return "loopback"; }
+    ModbusError readInputRegisters(uint8_t, uint16_t, uint16_t, uint16_t* out, uint32_t) override {
+        *out = 215;
+        return ModbusError::SUCCESS;
+    }
+};
+
+static LoopbackTransport transport;
+
+// =============================================================================
+// Benchmark
+// =============================================================================
+
+static void runPlacement(MemoryRegion cold) {
+    ANDRTF3::setMemoryPolicy({ MemoryRegion::INTERNAL, cold });
+    ANDRTF3* sensor = new ANDRTF3(3);
+    sensor->setTransport(&transport);
+
+    uint32_t best = UINT32_MAX;
+    for (int run = 0; run < RUNS; run++) {
+        uint32_t start = micros();
+        for (int i = 0; i < READS_PER_RUN; i++) {
+            (void)sensor->readTemperature();
+        }
+        uint32_t elapsed = micros() - start;
+        best = (elapsed < best) ? elapsed : best;
+    }
+
+    Serial.printf("cold in %-8s (asked %-8s): %lu ns per read\n",
+                  memory::regionName(sensor->getColdRegion()), memory::regionName(cold),
+                  static_cast<unsigned long>((best * 1000ULL) / READS_PER_RUN));
+    delete sensor;
+}
+
+// =============================================================================
+// Setup
+// =============================================================================
+
+void setup() {
+    Serial.begin(115200);
+    while (!Serial && millis() < 3000) delay(10);
+
+    Serial.println("\n=== ANDRTF3 Memory Placement Benchmark ===");
+    Serial.printf("Free internal: %u bytes, PSRAM: %u bytes\n\n",
+                  static_cast<unsigned>(memory::freeBytes(MemoryRegion::INTERNAL)),
+                  static_cast<unsigned>(memory::freeBytes(MemoryRegion::PSRAM)));
+
+    runPlacement(MemoryRegion::INTERNAL);
+    runPlacement(MemoryRegion::PSRAM);
+}
+
+void loop() {
+    delay(1000);
+}
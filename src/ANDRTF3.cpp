@@ -21,7 +21,11 @@
 
 #include "ANDRTF3.h"
 #include "ANDRTF3Logging.h"
+#include "ANDRTF3Scheduler.h"
+#include "ANDRTF3Transport.h"
 #include <ModbusErrorTracker.h>
+#include <new>
+#include <stdlib.h>
 
 namespace andrtf3 {
 
@@ -52,34 +56,124 @@ static const char* modbusErrorToString(ModbusError error) {
     }
 }
 
+// Placement of instances created from now on (hot in SRAM, cold in PSRAM if present)
+#if defined(ANDRTF3_IRAM_DECODE)
+// The IRAM response path updates statistics while PSRAM may be unreachable
+static MemoryPolicy s_memoryPolicy = { MemoryRegion::INTERNAL, MemoryRegion::INTERNAL };
+#else
+static MemoryPolicy s_memoryPolicy = { MemoryRegion::INTERNAL, MemoryRegion::PSRAM };
+#endif
+
 // Constructor
 ANDRTF3::ANDRTF3(uint8_t address)
     : QueuedModbusDevice(address),
+      _cold(nullptr),
+      _coldRegion(MemoryRegion::ANY),
+      _timeoutMs(0),
       _connected(false),
+      _requestSeq(0),
       _asyncStartTime(0),
+      _asyncDeadline(0),
+      _expiredUnanswered(0),
       _temperaturePtr(nullptr),
       _validityPtr(nullptr),
       _consecutive0x0000Errors(0),
-      _lastErrorTime(0) {
-    // _asyncPending is initialized via in-class initializer (std::atomic<bool>{false})
+      _lastErrorTime(0),
+      _verifyPending(false),
+      _updateGroup(nullptr),
+      _updateBits(0),
+      _eventGroup(xEventGroupCreate()),
+      _lagCompensator(nullptr),
+      _transport(nullptr),
+      _retainedSlot(-1),
+      _retainedBus(RetainedState::LOCAL_BUS),
+      _restored(false),
+      _finishError(nullptr),
+      _suspectRaw(0),
+      _suspectCount(0),
+      _suspectQueued(false) {
+    // _pendingSeq is initialized via in-class initializer (std::atomic<uint16_t>{0})
+    void* block = memory::allocate(sizeof(ColdState), s_memoryPolicy.cold, &_coldRegion);
+    if (block == nullptr) {
+        ANDRTF3_LOG_E("Out of memory for driver state (address %d)", address);
+        abort();
+    }
+    _cold = new (block) ColdState();
+    resetStats();
 
-    _config = getDefaultConfig();
-    _config.address = address;
+    _cold->config = getDefaultConfig();
+    _cold->config.address = address;
+    _timeoutMs = _cold->config.timeout;
 
     _lastReading.celsius = 0;
     _lastReading.timestamp = 0;
     _lastReading.valid = false; if (_validityPtr != nullptr) { *_validityPtr = false; } /*F46: propagate invalid to bound flag*/
 
+    restoreRetained();
+
     ANDRTF3_LOG_D("Constructor: Init celsius=%d, valid=%d",
                   _lastReading.celsius, _lastReading.valid);
 
     // Set init phase for proper operation
     setInitPhase(InitPhase::READY);
 
+    if (_eventGroup == nullptr) {
+        ANDRTF3_LOG_E("Failed to create event group");
+    }
+
     // Register device with ModbusDevice framework
     registerDevice();
 }
 
+ANDRTF3::~ANDRTF3() {
+    // Containers still holding this sensor drop it (each callback may call
+    // removeDetachHook(), so take the hook out first)
+    for (size_t i = 0; i < MAX_DETACH_HOOKS; i++) {
+        DetachHook hook = _cold->detachHooks[i];
+        _cold->detachHooks[i] = DetachHook{};
+        if (hook.callback != nullptr) {
+            hook.callback(*this, hook.context);
+        }
+    }
+    if (_eventGroup != nullptr) {
+        vEventGroupDelete(_eventGroup);
+    }
+    _cold->~ColdState();
+    memory::release(_cold);
+}
+
+// ========== Memory Placement ==========
+
+void ANDRTF3::setMemoryPolicy(const MemoryPolicy& policy) {
+#if defined(ANDRTF3_IRAM_DECODE)
+    if (policy.hot == MemoryRegion::PSRAM || policy.cold == MemoryRegion::PSRAM) {
+        ANDRTF3_LOG_W("PSRAM placement stalls the IRAM response path during flash writes");
+    }
+#endif
+    s_memoryPolicy = policy;
+}
+
+MemoryPolicy ANDRTF3::getMemoryPolicy() {
+    return s_memoryPolicy;
+}
+
+size_t ANDRTF3::coldStateBytes() noexcept {
+    return sizeof(ColdState);
+}
+
+void* ANDRTF3::operator new(size_t bytes) {
+    void* block = memory::allocate(bytes, s_memoryPolicy.hot);
+    if (block == nullptr) {
+        ANDRTF3_LOG_E("Out of memory for driver instance (%u bytes)", static_cast<unsigned>(bytes));
+        abort();
+    }
+    return block;
+}
+
+void ANDRTF3::operator delete(void* block) {
+    memory::release(block);
+}
+
 bool ANDRTF3::readTemperature() {
     bool success = performRead();
     
@@ -94,112 +188,97 @@ int16_t ANDRTF3::getTemperature() const noexcept {
     return _lastReading.celsius;
 }
 
+int16_t ANDRTF3::getCompensatedTemperature() const noexcept {
+    return (_lagCompensator != nullptr) ? _lagCompensator->getCompensated() : _lastReading.celsius;
+}
+
 bool ANDRTF3::requestTemperature() {
-    // Clear any stale pending state if timed out
-    if (_asyncPending.load() && (millis() - _asyncStartTime) > _config.timeout) {
-        _asyncPending.store(false);
-    }
+    finishDeferred();
 
-    if (_asyncPending.load()) {
+    // Expire a request that outlived its deadline
+    expirePending(millis());
+
+    if (_pendingSeq.load() != 0) {
         return false;
     }
 
-    _asyncPending.store(true);
-    _asyncStartTime = millis();
+    uint16_t seq = beginRequest(millis());
 
     // Perform synchronous read and process result immediately
-    auto result = readInputRegistersWithPriority(TEMP_REGISTER, 1, esp32Modbus::SENSOR);
+    std::vector<uint16_t> values;
+    ModbusError error = readTemperatureRegister(values);
     uint8_t addr = getServerAddress();
 
-    if (!result.isOk()) {
-        auto category = modbus::ModbusErrorTracker::categorizeError(result.error());
+    if (error != ModbusError::SUCCESS) {
+        auto category = modbus::ModbusErrorTracker::categorizeError(error);
         modbus::ModbusErrorTracker::recordError(addr, category);
-        _asyncPending.store(false);
-        _lastReading.valid = false; if (_validityPtr != nullptr) { *_validityPtr = false; } /*F46: propagate invalid to bound flag*/
-        _lastReading.error = modbusErrorToString(result.error());
+        completeRequest(seq, millis(), error != ModbusError::TIMEOUT);
+        abandonVerification();
+        publishInvalid(modbusErrorToString(error));
         _connected = false;
         return false;
     }
 
-    auto values = result.value();
     if (values.empty()) {
         modbus::ModbusErrorTracker::recordError(addr, modbus::ModbusErrorTracker::ErrorCategory::INVALID_DATA);
-        _asyncPending.store(false);
-        _lastReading.valid = false; if (_validityPtr != nullptr) { *_validityPtr = false; } /*F46: propagate invalid to bound flag*/
-        _lastReading.error = "No data returned";
+        completeRequest(seq, millis(), true);
+        abandonVerification();
+        publishInvalid("No data returned");
         _connected = false;
         return false;
     }
 
-    int16_t rawValue = static_cast<int16_t>(values[0]);
-
-    // Check for error codes
-    if (rawValue == 0 || values[0] == 0xFFFF) {
-        _consecutive0x0000Errors++;
-        modbus::ModbusErrorTracker::recordError(addr, modbus::ModbusErrorTracker::ErrorCategory::INVALID_DATA);
-
-        // Natural retry strategy: Use 5-second ModbusCoordinator tick interval
-        // First error: silent (wait for next poll to confirm)
-        // Second+ error: log ERROR (persistent fault confirmed)
-        if (_consecutive0x0000Errors >= 2) {
-            ANDRTF3_LOG_E("ERROR: Persistent 0x%04X (%d consecutive) - sensor fault confirmed",
-                          values[0], _consecutive0x0000Errors);
-        } else {
-            // First error: silent tracking (coordinator will retry in 5 seconds)
-            ANDRTF3_LOG_D("First 0x%04X detected - will verify on next poll (5s)", values[0]);
-        }
-
-        _asyncPending.store(false);
-        _lastReading.valid = false; if (_validityPtr != nullptr) { *_validityPtr = false; } /*F46: propagate invalid to bound flag*/
-        _lastReading.error = (values[0] == 0xFFFF) ? "Modbus error 0xFFFF" : "Sensor returned 0x0000";
-        _connected = (_consecutive0x0000Errors < 3);  // Only disconnect after 3+ consecutive errors
-        _lastErrorTime = millis();
-        return false;
-    }
-
-    // Validate range
-    if (rawValue < TEMP_MIN || rawValue > TEMP_MAX) {
-        modbus::ModbusErrorTracker::recordError(addr, modbus::ModbusErrorTracker::ErrorCategory::INVALID_DATA);
-        _asyncPending.store(false);
-        _lastReading.valid = false; if (_validityPtr != nullptr) { *_validityPtr = false; } /*F46: propagate invalid to bound flag*/
-        _lastReading.error = "Temperature out of range";
-        _connected = false;
+    // Fault codes (0x0000 / 0xFFFF) and out-of-range values
+    int16_t rawValue;
+    if (!decodeTemperature(values[0], rawValue)) {
+        completeRequest(seq, millis(), true);
+        rejectSuspectValue(values[0]);
         return false;
     }
 
-    // SUCCESS - store result immediately
-    modbus::ModbusErrorTracker::recordSuccess(addr);
-    _lastReading.celsius = rawValue;
-    _lastReading.timestamp = millis();
-    _lastReading.valid = true;
-    _lastReading.error = "";
-    _connected = true;
+    // SUCCESS - latency first, so the retained entry saved on publish carries it
+    completeRequest(seq, millis(), true);
     _consecutive0x0000Errors = 0;  // Reset error counter on success
+    resolveVerification(true);
+    publishReading(rawValue);
+    return true;
+}
 
-    // Update bound pointers
-    if (_temperaturePtr != nullptr) {
-        *_temperaturePtr = rawValue;
-    }
-    if (_validityPtr != nullptr) {
-        *_validityPtr = true;
+ModbusError ANDRTF3::readTemperatureRegister(std::vector<uint16_t>& values) {
+    if (_transport != nullptr) {
+        uint16_t raw = 0;
+        ModbusError error = _transport->readInputRegisters(getServerAddress(), TEMP_REGISTER,
+                                                           REGISTER_COUNT, &raw, _timeoutMs);
+        if (error == ModbusError::SUCCESS) {
+            values.assign(1, raw);
+        }
+        return error;
     }
 
-    _asyncPending.store(false);  // Already complete!
-    return true;
+    auto result = readInputRegistersWithPriority(TEMP_REGISTER, REGISTER_COUNT, esp32Modbus::SENSOR);
+    if (!result.isOk()) {
+        return result.error();
+    }
+    values = result.value();
+    return ModbusError::SUCCESS;
 }
 
 bool ANDRTF3::isReadComplete() const noexcept {
     // Sync read completes immediately, so always complete after requestTemperature()
-    return !_asyncPending.load();
+    return _pendingSeq.load() == 0;
 }
 
 bool ANDRTF3::getAsyncResult(TemperatureData& data) {
+    finishDeferred();
+
     // Result is already in _lastReading from requestTemperature()
     data = _lastReading;
     return _lastReading.valid;
 }
 
 void ANDRTF3::process() {
+    finishDeferred();
+
     // Process any queued async responses
     if (isAsyncEnabled()) {
         processQueue();
@@ -207,31 +286,41 @@ void ANDRTF3::process() {
 }
 
 bool ANDRTF3::performRead() {
+    finishDeferred();
+
     // Use the base class to read the temperature register with SENSOR priority
-    auto result = readInputRegistersWithPriority(TEMP_REGISTER, 1, esp32Modbus::SENSOR);
+    uint32_t start = millis();
+    _cold->stats.requests++;
+    std::vector<uint16_t> values;
+    ModbusError error = readTemperatureRegister(values);
     uint8_t addr = getServerAddress();
 
+    // Blocking call: the framework pairs request and response itself
+    if (error != ModbusError::TIMEOUT) {
+        _cold->stats.responses++;
+        recordLatency(millis() - start);
+    } else {
+        _cold->stats.timeouts++;
+    }
+
     ANDRTF3_LOG_D("performRead: ModbusResult ok=%d, error=%d",
-                  result.isOk(), static_cast<int>(result.error()));
+                  error == ModbusError::SUCCESS, static_cast<int>(error));
 
-    if (!result.isOk()) {
-        auto category = modbus::ModbusErrorTracker::categorizeError(result.error());
+    if (error != ModbusError::SUCCESS) {
+        auto category = modbus::ModbusErrorTracker::categorizeError(error);
         modbus::ModbusErrorTracker::recordError(addr, category);
-        _lastReading.valid = false; if (_validityPtr != nullptr) { *_validityPtr = false; } /*F46: propagate invalid to bound flag*/
-        _lastReading.error = modbusErrorToString(result.error());
+        abandonVerification();
+        publishInvalid(modbusErrorToString(error));
         _connected = false;
         return false;
     }
 
-    // Get the temperature value
-    auto values = result.value();
-
     ANDRTF3_LOG_D("performRead: values.size()=%d", values.size());
 
     if (values.empty()) {
         modbus::ModbusErrorTracker::recordError(addr, modbus::ModbusErrorTracker::ErrorCategory::INVALID_DATA);
-        _lastReading.valid = false; if (_validityPtr != nullptr) { *_validityPtr = false; } /*F46: propagate invalid to bound flag*/
-        _lastReading.error = "No data returned";
+        abandonVerification();
+        publishInvalid("No data returned");
         _connected = false;
         return false;
     }
@@ -244,97 +333,140 @@ bool ANDRTF3::performRead() {
     // Check for Modbus error codes:
     // 0x0000 = Sensor error or communication fault
     // 0xFFFF = Common Modbus error/no response (-1 as signed)
-    if (rawValue == 0 || values[0] == 0xFFFF) {
-        _consecutive0x0000Errors++;
-        modbus::ModbusErrorTracker::recordError(addr, modbus::ModbusErrorTracker::ErrorCategory::INVALID_DATA);
-
-        // Natural retry strategy: Use 5-second ModbusCoordinator tick interval
-        // First error: silent (wait for next poll to confirm)
-        // Second+ error: log ERROR (persistent fault confirmed)
-        if (_consecutive0x0000Errors >= 2) {
-            ANDRTF3_LOG_E("ERROR: Persistent 0x%04X (%d consecutive) - sensor fault confirmed",
-                          values[0], _consecutive0x0000Errors);
-        } else {
-            // First error: silent tracking (coordinator will retry in 5 seconds)
-            ANDRTF3_LOG_D("First 0x%04X detected - will verify on next poll (5s)", values[0]);
-        }
-
-        _lastReading.valid = false; if (_validityPtr != nullptr) { *_validityPtr = false; } /*F46: propagate invalid to bound flag*/
-        _lastReading.error = (values[0] == 0xFFFF) ? "Modbus error 0xFFFF" : "Sensor returned 0x0000";
-        _connected = (_consecutive0x0000Errors < 3);  // Only disconnect after 3+ consecutive errors
-        _lastErrorTime = millis();
+    // and for values outside the sensor range
+    if (!decodeTemperature(values[0], rawValue)) {
+        rejectSuspectValue(values[0]);
         // Do NOT update celsius value - keep previous reading
         return false;
     }
 
-    // Validate range
-    if (rawValue < TEMP_MIN || rawValue > TEMP_MAX) {
-        modbus::ModbusErrorTracker::recordError(addr, modbus::ModbusErrorTracker::ErrorCategory::INVALID_DATA);
-        _lastReading.valid = false; if (_validityPtr != nullptr) { *_validityPtr = false; } /*F46: propagate invalid to bound flag*/
-        _lastReading.error = "Temperature out of range";
-        _connected = false;
-        return false;
-    }
-
     // Store raw value (already in deci-degrees)
-    modbus::ModbusErrorTracker::recordSuccess(addr);
-    _lastReading.celsius = rawValue;
-    _lastReading.timestamp = millis();
-    _lastReading.valid = true;
-    _lastReading.error = "";
-    _connected = true;
     _consecutive0x0000Errors = 0;  // Reset error counter on success
+    resolveVerification(true);
+    publishReading(rawValue);
 
     return true;
 }
 
-void ANDRTF3::handleReadComplete(bool success, int16_t value) {
-    ANDRTF3_LOG_D("handleReadComplete: success=%d, value=%d, "
-                  "prev_celsius=%d, prev_valid=%d",
-                  success, value, _lastReading.celsius, _lastReading.valid);
+void ANDRTF3_IRAM ANDRTF3::publishReading(int16_t value) {
+    _lastReading.celsius = value;  // Already in deci-degrees
+    _lastReading.timestamp = millis();
+    _lastReading.valid = true;
+    _connected = true;
+    _restored = false;
+    settle(FINISH_PUBLISHED | FINISH_ERROR | FINISH_RETAINED);
 
-    if (success) {
-        _lastReading.celsius = value;  // Already in deci-degrees
-        _lastReading.timestamp = millis();
-        _lastReading.valid = true;
-        _lastReading.error = "";
-        _connected = true;
+    // Update bound pointers (unified mapping architecture)
+    // Value is already in tenths of degrees - perfect for Temperature_t!
+    if (_temperaturePtr != nullptr) {
+        *_temperaturePtr = value;  // Direct assignment (both are int16_t tenths)
+    }
+    if (_validityPtr != nullptr) {
+        *_validityPtr = true;
+    }
 
-        // Update bound pointers (unified mapping architecture)
-        // Value is already in tenths of degrees - perfect for Temperature_t!
-        if (_temperaturePtr != nullptr) {
-            *_temperaturePtr = value;  // Direct assignment (both are int16_t tenths)
-        }
-        if (_validityPtr != nullptr) {
-            *_validityPtr = true;
-        }
+    // Wake tasks waiting on this sensor (waitForData(), ANDRTF3Group)
+    if (_eventGroup != nullptr) {
+        xEventGroupClearBits(_eventGroup, DATA_ERROR_BIT);
+        xEventGroupSetBits(_eventGroup, DATA_READY_BIT);
+    }
+    if (_updateGroup != nullptr) {
+        xEventGroupSetBits(_updateGroup, _updateBits);
+    }
+}
 
-        if (value == 0) {
-            ANDRTF3_LOG_W("WARNING: handleReadComplete set celsius to 0 - suspicious!");
-        }
+void ANDRTF3_IRAM ANDRTF3::publishInvalid(const char* error) {
+    _lastReading.valid = false;
+    if (_validityPtr != nullptr) {
+        *_validityPtr = false;  // Propagate invalid to bound flag
+    }
+    _restored = false;
+    if (error != nullptr) {
+        _finishError = error;
+        settle(FINISH_ERROR | FINISH_RETAINED);
     } else {
-        _lastReading.valid = false; if (_validityPtr != nullptr) { *_validityPtr = false; } /*F46: propagate invalid to bound flag*/
-        _connected = false;
+        settle(FINISH_RETAINED);
+    }
 
-        // Update bound pointers for error case
+    // The previous reading is no longer current: waitForData() must not report it
+    if (_eventGroup != nullptr) {
+        xEventGroupClearBits(_eventGroup, DATA_READY_BIT);
+        xEventGroupSetBits(_eventGroup, DATA_ERROR_BIT);
+    }
+}
+
+void ANDRTF3::setTransport(Transport* transport) {
+    _transport = transport;
+
+    uint16_t bus = (transport != nullptr) ? transport->busId() : RetainedState::LOCAL_BUS;
+    if (bus == _retainedBus) {
+        return;
+    }
+    // Whatever came from the old bus's entry belongs to another sensor
+    _retainedBus = bus;
+    _consecutive0x0000Errors = 0;
+    _cold->stats.avgLatencyMs = 0;
+    if (_restored) {
+        _lastReading.valid = false;
         if (_validityPtr != nullptr) {
             *_validityPtr = false;
         }
+        _connected = false;
+        _restored = false;
+    }
+    restoreRetained();
+}
+
+void ANDRTF3::restoreRetained() {
+    RetainedState& retained = RetainedState::system();
+    int slot = retained.claim(getServerAddress(), _retainedBus);
+    _retainedSlot = static_cast<int8_t>(slot);
 
-        // Note: celsius value is NOT updated on error - retains previous value
+    RetainedState::Sensor state;
+    if (!retained.restore(slot, state)) {
+        return;
+    }
 
-        ANDRTF3_LOG_D("handleReadComplete: Error - celsius remains %d",
-                      _lastReading.celsius);
+    // Fault state and response time carry over even without a usable reading
+    _consecutive0x0000Errors = state.failures;
+    _cold->stats.avgLatencyMs = state.rttMs;
+    if (!state.valid) {
+        return;
     }
+
+    _lastReading.celsius = state.celsius;
+    _lastReading.timestamp = millis() - state.ageMs;
+    _lastReading.valid = true;
+    _connected = true;
+    _restored = true;
+    if (_temperaturePtr != nullptr) {
+        *_temperaturePtr = state.celsius;
+    }
+    if (_validityPtr != nullptr) {
+        *_validityPtr = true;
+    }
+    ANDRTF3_LOG_I("Restored addr=%d: %d (age %lu ms, rtt %u ms)", getServerAddress(),
+                  state.celsius, static_cast<unsigned long>(state.ageMs), state.rttMs);
 }
 
-// Handle async Modbus responses
-void ANDRTF3::onAsyncResponse(uint8_t functionCode, uint16_t address,
-                             const uint8_t* data, size_t length) {
-    ANDRTF3_LOG_D("onAsyncResponse: FC=0x%02X, addr=%d, len=%d",
-                  functionCode, address, length);
+void ANDRTF3::saveRetained() {
+    if (_retainedSlot < 0) {
+        return;
+    }
+    RetainedState::Sensor state;
+    state.celsius = _lastReading.celsius;
+    state.ageMs = 0;
+    state.rttMs = _cold->stats.avgLatencyMs;
+    state.failures = _consecutive0x0000Errors;
+    state.valid = _lastReading.valid;
+    RetainedState::system().save(_retainedSlot, state, _lastReading.timestamp, millis());
+}
 
-    uint8_t addr = getServerAddress();
+// Handle async Modbus responses
+void ANDRTF3_IRAM ANDRTF3::onAsyncResponse(uint8_t functionCode, uint16_t address,
+                                           const uint8_t* data, size_t length) {
+    ANDRTF3_HOT_LOG_D("onAsyncResponse: FC=0x%02X, addr=%d, len=%d",
+                      functionCode, address, length);
 
     // We only expect input register reads
     if (functionCode != FUNCTION_CODE) {
@@ -346,44 +478,274 @@ void ANDRTF3::onAsyncResponse(uint8_t functionCode, uint16_t address,
         return;
     }
 
+    // Correlate with the outstanding request; stale frames are dropped
+    // before they can touch the reading, the error counters or latency stats
+    uint32_t now = millis();
+    expirePending(now);
+    uint16_t seq = _pendingSeq.load();
+    if (seq == 0) {
+        if (_expiredUnanswered > 0) {
+            _expiredUnanswered--;
+            _cold->stats.lateResponses++;
+        } else {
+            _cold->stats.unsolicited++;
+        }
+        ANDRTF3_HOT_LOG_V("onAsyncResponse: no request outstanding, discarded");
+        return;
+    }
+    if (_expiredUnanswered > 0 && (now - _asyncStartTime) < MIN_TURNAROUND_MS) {
+        // Too soon to answer the current request: belongs to an expired one
+        _expiredUnanswered--;
+        _cold->stats.lateResponses++;
+        ANDRTF3_HOT_LOG_V("onAsyncResponse: late response for an expired request, discarded");
+        return;
+    }
+    if (!completeRequest(seq, now, true)) {
+        _cold->stats.lateResponses++;  // Lost the race against expiry
+        return;
+    }
+    _expiredUnanswered = 0;
+
     // Process temperature data
     if (length >= 2) {
         int16_t rawValue = (data[0] << 8) | data[1];
 
-        ANDRTF3_LOG_D("onAsyncResponse: data[0]=0x%02X, data[1]=0x%02X, "
-                      "rawValue=%d (0x%04X)", data[0], data[1], rawValue,
-                      static_cast<uint16_t>(rawValue));
+        ANDRTF3_HOT_LOG_D("onAsyncResponse: data[0]=0x%02X, data[1]=0x%02X, "
+                          "rawValue=%d (0x%04X)", data[0], data[1], rawValue,
+                          static_cast<uint16_t>(rawValue));
 
         // Check for Modbus error codes:
         // 0x0000 = Sensor error or communication fault
         // 0xFFFF = Common Modbus error/no response
+        // and for values outside the sensor range
         uint16_t unsignedValue = static_cast<uint16_t>(rawValue);
-        if (rawValue == 0 || unsignedValue == 0xFFFF) {
-            _consecutive0x0000Errors++;
-            modbus::ModbusErrorTracker::recordError(addr, modbus::ModbusErrorTracker::ErrorCategory::INVALID_DATA);
-            ANDRTF3_LOG_E("ERROR: Received 0x%04X (%d consecutive) - sensor error or communication fault!",
-                          unsignedValue, _consecutive0x0000Errors);
-            _lastReading.valid = false; if (_validityPtr != nullptr) { *_validityPtr = false; } /*F46: propagate invalid to bound flag*/
-            _lastReading.error = (unsignedValue == 0xFFFF) ? "Modbus error 0xFFFF" : "Sensor returned 0x0000";
-            _connected = (_consecutive0x0000Errors < 3);  // Only disconnect after 3+ consecutive errors
-            _lastErrorTime = millis();
+        if (!decodeTemperature(unsignedValue, rawValue)) {
+            rejectSuspectValue(unsignedValue);
             // Do NOT update celsius value - keep previous reading
         } else {
             _consecutive0x0000Errors = 0;  // Reset error counter on success
-            modbus::ModbusErrorTracker::recordSuccess(addr);
-            handleReadComplete(true, rawValue);
+            resolveVerification(true);
+            publishReading(rawValue);
         }
     } else {
-        modbus::ModbusErrorTracker::recordError(addr, modbus::ModbusErrorTracker::ErrorCategory::INVALID_DATA);
-        _lastReading.valid = false; if (_validityPtr != nullptr) { *_validityPtr = false; } /*F46: propagate invalid to bound flag*/
-        _lastReading.error = "Invalid response length";
+        settle(FINISH_BAD_DATA);
+        abandonVerification();
+        publishInvalid("Invalid response length");
         _connected = false;
 
-        ANDRTF3_LOG_D("onAsyncResponse: Invalid length %d, expected >= 2", length);
+        ANDRTF3_HOT_LOG_D("onAsyncResponse: Invalid length %d, expected >= 2", length);
+    }
+}
+
+// ========== Suspect Values ==========
+
+void ANDRTF3_IRAM ANDRTF3::rejectSuspectValue(uint16_t raw) {
+    _consecutive0x0000Errors++;
+    _suspectRaw = raw;
+    _suspectCount = _consecutive0x0000Errors;
+    _suspectQueued = false;
+
+    const char* reason = (raw == 0xFFFF) ? "Modbus error 0xFFFF"
+                       : (raw == 0)      ? "Sensor returned 0x0000"
+                                         : "Temperature out of range";
+    if (_verifyPending) {
+        // Second opinion agrees: a real fault, not a glitch
+        resolveVerification(false);
+    } else if (_consecutive0x0000Errors == 1) {
+        // First one: re-read in the next free bus slot instead of a whole poll period later
+        _verifyPending = true;
+        _suspectQueued = true;
+        _cold->stats.verifications++;
+        queueRead(millis() + VERIFY_DEADLINE_MS);
+    }
+    settle(FINISH_BAD_DATA | FINISH_SUSPECT);
+
+    publishInvalid(reason);
+    _connected = (_consecutive0x0000Errors < 3);  // Only disconnect after 3+ consecutive errors
+    _lastErrorTime = millis();
+}
+
+void ANDRTF3_IRAM ANDRTF3::resolveVerification(bool valid) {
+    if (!_verifyPending) {
+        return;
+    }
+    _verifyPending = false;
+    _queuedDeadline.store(NO_DEADLINE);
+    _readQueued.store(false);   // This read was the verification
+    if (valid) {
+        _cold->stats.verifyRecovered++;
+    } else {
+        _cold->stats.verifyConfirmed++;
+    }
+}
+
+void ANDRTF3_IRAM ANDRTF3::abandonVerification() {
+    // No second opinion (bus fault, deadline, cancel): back to the normal schedule
+    if (!_verifyPending) {
+        return;
+    }
+    _verifyPending = false;
+    _queuedDeadline.store(NO_DEADLINE);
+    _readQueued.store(false);
+    _cold->stats.verifyLost++;
+}
+
+// ========== Request Correlation ==========
+
+uint16_t ANDRTF3::beginRequest(uint32_t nowMs) {
+    uint16_t seq = ++_requestSeq;
+    if (seq == 0) {
+        seq = ++_requestSeq;  // 0 means "nothing outstanding"
     }
+    _asyncStartTime = nowMs;
+    _asyncDeadline = nowMs + _timeoutMs;
+    _cold->stats.requests++;
+    _pendingSeq.store(seq);
+    return seq;
+}
 
-    // Mark async operation complete (atomic store for thread safety)
-    _asyncPending.store(false);
+bool ANDRTF3_IRAM ANDRTF3::completeRequest(uint16_t seq, uint32_t nowMs, bool responded) {
+    // Only the request that is still outstanding can complete
+    uint16_t expected = seq;
+    if (!_pendingSeq.compare_exchange_strong(expected, 0)) {
+        return false;
+    }
+    if (responded) {
+        _cold->stats.responses++;
+        recordLatency(nowMs - _asyncStartTime);
+    } else {
+        _cold->stats.timeouts++;
+    }
+    return true;
+}
+
+void ANDRTF3_IRAM ANDRTF3::expirePending(uint32_t nowMs) {
+    uint16_t seq = _pendingSeq.load();
+    if (seq == 0 || !timeReached(nowMs, _asyncDeadline)) {
+        return;
+    }
+    if (_pendingSeq.compare_exchange_strong(seq, 0)) {
+        _cold->stats.timeouts++;
+        if (_expiredUnanswered < UINT8_MAX) {
+            _expiredUnanswered++;
+        }
+        ANDRTF3_HOT_LOG_D("Request #%u expired after %lu ms", seq,
+                          static_cast<unsigned long>(nowMs - _asyncStartTime));
+    }
+}
+
+void ANDRTF3_IRAM ANDRTF3::recordLatency(uint32_t latencyMs) {
+    uint16_t ms = static_cast<uint16_t>(latencyMs > 0xFFFF ? 0xFFFF : latencyMs);
+    _cold->stats.lastLatencyMs = ms;
+    if (ms < _cold->stats.minLatencyMs) {
+        _cold->stats.minLatencyMs = ms;
+    }
+    if (ms > _cold->stats.maxLatencyMs) {
+        _cold->stats.maxLatencyMs = ms;
+    }
+    // A restored estimate seeds the average; otherwise the first sample does
+    _cold->stats.avgLatencyMs = (_cold->stats.avgLatencyMs == 0)
+        ? ms
+        : static_cast<uint16_t>(_cold->stats.avgLatencyMs + (static_cast<int32_t>(ms) - _cold->stats.avgLatencyMs) / 8);
+    // Saved to RetainedState by the publishReading()/publishInvalid() that follows
+}
+
+// ========== Flash-side Follow-up ==========
+
+void ANDRTF3_IRAM ANDRTF3::settle(uint8_t work) {
+#if defined(ANDRTF3_TRACK_FLASH_CACHE)
+    if (!memory::flashCacheEnabled()) {
+        _finishPending.fetch_or(work);  // Caught up by process()
+        return;
+    }
+#endif
+    finish(work | _finishPending.exchange(0));
+}
+
+void ANDRTF3::finishDeferred() {
+#if defined(ANDRTF3_TRACK_FLASH_CACHE)
+    if (!memory::flashCacheEnabled()) {
+        return;
+    }
+#endif
+    uint8_t work = _finishPending.exchange(0);
+    if (work != 0) {
+        finish(work);
+    }
+}
+
+void ANDRTF3::finish(uint8_t work) {
+    uint8_t addr = getServerAddress();
+
+    if (work & FINISH_SUSPECT) {
+        // Logged as it was when rejected; a deferred catch-up may run much later
+        if (_suspectQueued) {
+            ANDRTF3_LOG_D("First 0x%04X - verification read queued", _suspectRaw);
+        } else {
+            ANDRTF3_LOG_E("ERROR: Persistent 0x%04X (%d consecutive) - sensor fault confirmed",
+                          _suspectRaw, _suspectCount);
+        }
+    }
+    if (work & FINISH_BAD_DATA) {
+        modbus::ModbusErrorTracker::recordError(addr, modbus::ModbusErrorTracker::ErrorCategory::INVALID_DATA);
+    }
+    if (work & FINISH_PUBLISHED) {
+        modbus::ModbusErrorTracker::recordSuccess(addr);
+        if (_lagCompensator != nullptr) {
+            _lagCompensator->update(_lastReading.celsius, _lastReading.timestamp);
+        }
+    }
+    if (work & FINISH_ERROR) {
+        _lastReading.error = (_lastReading.valid || _finishError == nullptr) ? "" : _finishError;
+    }
+    if (work & FINISH_RETAINED) {
+        saveRetained();
+    }
+}
+
+// ========== Deadline-carrying Queued Reads ==========
+
+void ANDRTF3_IRAM ANDRTF3::queueRead(uint32_t deadlineMs) {
+    // Deadline before flag; a queued read is coalesced, keeping the later deadline
+    raiseDeadline(_queuedDeadline, deadlineMs);
+    _readQueued.store(true);
+}
+
+bool ANDRTF3::cancelRead() {
+    _queuedDeadline.store(NO_DEADLINE);
+    if (_readQueued.exchange(false)) {
+        _cold->stats.cancelled++;
+        abandonVerification();
+        return true;
+    }
+    return false;
+}
+
+ANDRTF3::QueuedRead ANDRTF3::serviceQueuedRead() {
+    if (!_readQueued.exchange(false)) {
+        return QueuedRead::NONE;
+    }
+    uint32_t deadline = _queuedDeadline.exchange(NO_DEADLINE);
+    if (deadline == NO_DEADLINE) {
+        return QueuedRead::NONE;   // Raised after the previous read took the flag: served
+    }
+
+    // Drop if the answer would only arrive after the deadline
+    uint32_t expected = _cold->stats.avgLatencyMs;   // 0 until known
+    if (timeReached(millis() + expected, deadline)) {
+        _cold->stats.expiredDrops++;
+        abandonVerification();
+        ANDRTF3_LOG_D("Queued read dropped: deadline passed by %ld ms",
+                      static_cast<long>(millis() + expected - deadline));
+        return QueuedRead::DROPPED;
+    }
+
+    return requestTemperature() ? QueuedRead::COMPLETED : QueuedRead::FAILED;
+}
+
+void ANDRTF3::resetStats() {
+    _cold->stats = Stats{};
+    _cold->stats.minLatencyMs = 0xFFFF;
 }
 
 // Static methods
@@ -395,6 +757,14 @@ ANDRTF3::Config ANDRTF3::getDefaultConfig() {
     };
 }
 
+bool ANDRTF3_IRAM ANDRTF3::decodeTemperature(uint16_t raw, int16_t& celsius) {
+    celsius = static_cast<int16_t>(raw);
+    if (raw == 0 || raw == 0xFFFF) {
+        return false;
+    }
+    return celsius >= TEMP_MIN && celsius <= TEMP_MAX;
+}
+
 // ========== Unified Mapping API ==========
 
 void ANDRTF3::bindTemperaturePointers(int16_t* tempPtr, bool* validPtr) {
@@ -403,6 +773,16 @@ void ANDRTF3::bindTemperaturePointers(int16_t* tempPtr, bool* validPtr) {
     _temperaturePtr = tempPtr;
     _validityPtr = validPtr;
 
+    // Hand a reading restored after a reset to the application right away
+    if (_restored) {
+        if (tempPtr != nullptr) {
+            *tempPtr = _lastReading.celsius;
+        }
+        if (validPtr != nullptr) {
+            *validPtr = true;
+        }
+    }
+
     if (tempPtr != nullptr && validPtr != nullptr) {
         ANDRTF3_LOG_D("Temperature bound to temp=0x%p (int16_t tenths), valid=0x%p", tempPtr, validPtr);
     } else if (tempPtr == nullptr && validPtr == nullptr) {
@@ -412,4 +792,101 @@ void ANDRTF3::bindTemperaturePointers(int16_t* tempPtr, bool* validPtr) {
     }
 }
 
+void ANDRTF3::setUpdateNotification(EventGroupHandle_t group, EventBits_t bits) {
+    _updateGroup = group;
+    _updateBits = (group != nullptr) ? bits : 0;
+}
+
+bool ANDRTF3::addDetachHook(SensorDetachCallback callback, void* context) {
+    if (callback == nullptr) {
+        return false;
+    }
+    DetachHook* free = nullptr;
+    for (size_t i = 0; i < MAX_DETACH_HOOKS; i++) {
+        DetachHook& hook = _cold->detachHooks[i];
+        if (hook.callback == callback && hook.context == context) {
+            return true;
+        }
+        if (hook.callback == nullptr && free == nullptr) {
+            free = &hook;
+        }
+    }
+    if (free == nullptr) {
+        ANDRTF3_LOG_W("Address %d: no free detach hook", getServerAddress());
+        return false;
+    }
+    *free = DetachHook{ callback, context };
+    return true;
+}
+
+void ANDRTF3::removeDetachHook(SensorDetachCallback callback, void* context) {
+    for (size_t i = 0; i < MAX_DETACH_HOOKS; i++) {
+        DetachHook& hook = _cold->detachHooks[i];
+        if (hook.callback == callback && hook.context == context) {
+            hook = DetachHook{};
+        }
+    }
+}
+
+// ========== IDeviceInstance Interface ==========
+
+IDeviceInstance::DeviceResult<void> ANDRTF3::initialize() {
+    if (_eventGroup == nullptr) {
+        return IDeviceInstance::DeviceResult<void>(IDeviceInstance::DeviceError::NOT_INITIALIZED);
+    }
+    // Probe the sensor once so callers learn about wiring problems early
+    if (!readTemperature()) {
+        ANDRTF3_LOG_W("initialize: first read failed (%s)", _lastReading.error.c_str());
+        return IDeviceInstance::DeviceResult<void>(IDeviceInstance::DeviceError::COMMUNICATION_ERROR);
+    }
+    return IDeviceInstance::DeviceResult<void>();
+}
+
+IDeviceInstance::DeviceResult<void> ANDRTF3::requestData() {
+    if (!requestTemperature()) {
+        return IDeviceInstance::DeviceResult<void>(IDeviceInstance::DeviceError::COMMUNICATION_ERROR);
+    }
+    return IDeviceInstance::DeviceResult<void>();
+}
+
+IDeviceInstance::DeviceResult<void> ANDRTF3::processData() {
+    process();
+    return IDeviceInstance::DeviceResult<void>();
+}
+
+IDeviceInstance::DeviceResult<std::vector<float>> ANDRTF3::getData(IDeviceInstance::DeviceDataType dataType) {
+    if (dataType != IDeviceInstance::DeviceDataType::TEMPERATURE) {
+        return IDeviceInstance::DeviceResult<std::vector<float>>(IDeviceInstance::DeviceError::NOT_SUPPORTED);
+    }
+    if (!_lastReading.valid) {
+        return IDeviceInstance::DeviceResult<std::vector<float>>(IDeviceInstance::DeviceError::COMMUNICATION_ERROR);
+    }
+    return IDeviceInstance::DeviceResult<std::vector<float>>(
+        std::vector<float>{ static_cast<float>(_lastReading.celsius) / 10.0f });
+}
+
+IDeviceInstance::DeviceResult<void> ANDRTF3::performAction(int actionId, int actionParam) {
+    (void)actionId;
+    (void)actionParam;
+    return IDeviceInstance::DeviceResult<void>(IDeviceInstance::DeviceError::NOT_SUPPORTED);
+}
+
+IDeviceInstance::DeviceResult<void> ANDRTF3::waitForData() {
+    if (_eventGroup == nullptr) {
+        return IDeviceInstance::DeviceResult<void>(IDeviceInstance::DeviceError::NOT_INITIALIZED);
+    }
+
+    EventBits_t bits = xEventGroupWaitBits(_eventGroup, DATA_READY_BIT | DATA_ERROR_BIT,
+                                           pdTRUE,    // clear on exit
+                                           pdFALSE,   // either bit
+                                           pdMS_TO_TICKS(_timeoutMs));
+    if (bits & DATA_READY_BIT) {
+        return IDeviceInstance::DeviceResult<void>();
+    }
+    if (bits & DATA_ERROR_BIT) {
+        return IDeviceInstance::DeviceResult<void>(IDeviceInstance::DeviceError::COMMUNICATION_ERROR);
+    }
+    return IDeviceInstance::DeviceResult<void>(IDeviceInstance::DeviceError::TIMEOUT);
+}
+
 } // namespace andrtf3
\ No newline at end of file
@@ -24,7 +24,14 @@
 
 #include <Arduino.h>
 #include <QueuedModbusDevice.h>
+#include <IDeviceInstance.h>
+#include "ANDRTF3LagCompensator.h"
+#include "ANDRTF3Retained.h"
+#include "ANDRTF3Memory.h"
+#include <freertos/FreeRTOS.h>
+#include <freertos/event_groups.h>
 #include <atomic>
+#include <vector>
 
 // Import specific types from modbus namespace
 using modbus::QueuedModbusDevice;
@@ -33,6 +40,12 @@ using modbus::ModbusResult;
 
 namespace andrtf3 {
 
+class Transport;
+class ANDRTF3;
+
+// Called from ~ANDRTF3 for every container still holding the sensor
+typedef void (*SensorDetachCallback)(ANDRTF3& sensor, void* context);
+
 /**
  * ANDRTF3/MD Temperature Sensor Driver
  * 
@@ -44,9 +57,20 @@ namespace andrtf3 {
  * 
  * Register Map:
  * - 0x0032 (50): Temperature in deci-degrees Celsius
+ *
+ * Implements IDeviceInstance so supervisors can treat it like any other
+ * device: requestData()/waitForData()/getData(TEMPERATURE) plus the
+ * DATA_READY_BIT / DATA_ERROR_BIT event bits on getEventGroup().
  */
-class ANDRTF3 : public QueuedModbusDevice {
+class ANDRTF3 : public QueuedModbusDevice, public IDeviceInstance {
 public:
+    // Event bits on getEventGroup()
+    static constexpr EventBits_t DATA_READY_BIT = (1UL << 0);   // New valid reading
+    static constexpr EventBits_t DATA_ERROR_BIT = (1UL << 1);   // Read failed / invalid value
+
+    // Containers (group, pump, poller) one sensor can be registered with
+    static constexpr size_t MAX_DETACH_HOOKS = 4;
+
     // Configuration structure
     struct Config {
         uint8_t address;           // Modbus address (1-247, default: 3)
@@ -54,6 +78,33 @@ public:
         uint8_t retries;           // Number of retries (default: 3)
     };
 
+    /**
+     * Transaction statistics
+     *
+     * Every request carries a sequence tag and a deadline (start + timeout).
+     * A response is only accepted for the request that is still outstanding
+     * and within its deadline; anything else is discarded and counted, so
+     * latency figures and freshness are never taken from a stale frame.
+     * Counters are updated from the Modbus task and read without locking.
+     */
+    struct Stats {
+        uint32_t requests;         // Transactions started
+        uint32_t responses;        // Responses accepted for their own request
+        uint32_t timeouts;         // Requests that expired unanswered
+        uint32_t lateResponses;    // Discarded: arrived after their request expired
+        uint32_t unsolicited;      // Discarded: no request outstanding
+        uint32_t expiredDrops;     // Queued reads dropped before transmission
+        uint32_t cancelled;        // Queued reads cancelled by the application
+        uint32_t verifications;    // Re-reads queued after a suspect value
+        uint32_t verifyRecovered;  // ... answered with a valid value (transient glitch)
+        uint32_t verifyConfirmed;  // ... that repeated the fault
+        uint32_t verifyLost;       // ... that failed, expired or were cancelled
+        uint16_t lastLatencyMs;
+        uint16_t minLatencyMs;
+        uint16_t maxLatencyMs;
+        uint16_t avgLatencyMs;     // EWMA, alpha 1/8
+    };
+
     // Temperature data (fixed-point format: value * 10)
     struct TemperatureData {
         int16_t celsius;           // Temperature * 10 (261 = 26.1°C)
@@ -64,11 +115,36 @@ public:
 
     // Constructor/Destructor
     explicit ANDRTF3(uint8_t address = 3);
-    virtual ~ANDRTF3() = default;
+    virtual ~ANDRTF3();
+
+    ANDRTF3(const ANDRTF3&) = delete;
+    ANDRTF3& operator=(const ANDRTF3&) = delete;
+
+    /**
+     * @brief Choose where instances created afterwards keep their state
+     *
+     * Hot state (current reading, pending flags, timing) is the driver object
+     * itself, which new ANDRTF3(...) places in policy.hot. Cold state (config,
+     * statistics, identity) is a separate block in policy.cold. Default: hot
+     * in internal SRAM, cold in PSRAM (internal on boards without PSRAM).
+     * ANDRTF3_IRAM_DECODE builds default to internal SRAM for both, since the
+     * response path updates statistics while the flash cache may be off.
+     */
+    static void setMemoryPolicy(const MemoryPolicy& policy);
+    static MemoryPolicy getMemoryPolicy();
+    [[nodiscard]] MemoryRegion getColdRegion() const noexcept { return _coldRegion; }
+    // Size of the separately allocated cold block (on top of sizeof(ANDRTF3))
+    [[nodiscard]] static size_t coldStateBytes() noexcept;
+
+    static void* operator new(size_t bytes);
+    static void operator delete(void* block);
 
     // Configuration
-    void setConfig(const Config& config) { _config = config; }
-    [[nodiscard]] Config getConfig() const noexcept { return _config; }
+    void setConfig(const Config& config) {
+        _cold->config = config;
+        _timeoutMs = config.timeout;
+    }
+    [[nodiscard]] Config getConfig() const noexcept { return _cold->config; }
 
     // Device identification
     [[nodiscard]] uint8_t getDeviceAddress() const { return getServerAddress(); }
@@ -83,8 +159,56 @@ public:
     [[nodiscard]] bool isReadComplete() const noexcept;
     [[nodiscard]] bool getAsyncResult(TemperatureData& data);
 
+    // Outcome of serviceQueuedRead()
+    enum class QueuedRead : uint8_t {
+        NONE,                      // Nothing queued
+        DROPPED,                   // Expired before it reached the wire
+        COMPLETED,                 // Read and published
+        FAILED                     // Read attempted, failed
+    };
+
+    /**
+     * @brief Queue a read that is only worth doing before deadlineMs
+     *
+     * One read is kept per sensor; queueing again keeps a single request
+     * with the later deadline. The bus task transmits it with
+     * serviceQueuedRead(), which drops it instead if the answer could not
+     * arrive before the deadline (expected latency included).
+     */
+    void queueRead(uint32_t deadlineMs);
+    bool cancelRead();              // true if a queued read was removed
+    [[nodiscard]] bool hasQueuedRead() const noexcept { return _readQueued.load(); }
+    QueuedRead serviceQueuedRead();
+
     // Status
     [[nodiscard]] bool isConnected() const noexcept { return _connected; }
+    [[nodiscard]] Stats getStats() const noexcept { return _cold->stats; }
+    void resetStats();
+
+    /**
+     * @brief Read through another transport instead of the local RS485 bus
+     *
+     * E.g. an RtuTcpTransport for a sensor behind an Ethernet serial
+     * server. Reads become blocking transactions on that transport with
+     * Config::timeout; the async queue of the local bus is not used. Pass
+     * nullptr to return to the local bus.
+     *
+     * The sensor's RetainedState entry follows it to the transport's bus
+     * (Transport::busId()); state restored from the local bus's entry by
+     * the constructor is replaced by that bus's entry.
+     */
+    void setTransport(Transport* transport);
+    [[nodiscard]] Transport* getTransport() const noexcept { return _transport; }
+
+    /**
+     * True while the current reading was restored from RetainedState after
+     * a soft reset rather than read in this boot; cleared by the first live
+     * reading. getTemperatureData().timestamp reflects the saved age.
+     */
+    [[nodiscard]] bool isRestored() const noexcept { return _restored; }
+
+    // Sequence tag of the outstanding async request (0 = none)
+    [[nodiscard]] uint16_t getPendingSequence() const noexcept { return _pendingSeq.load(); }
 
     // Process queued operations
     void process();
@@ -107,20 +231,101 @@ public:
      */
     void bindTemperaturePointers(int16_t* tempPtr, bool* validPtr);
 
+    /**
+     * @brief Set event bits whenever a new valid reading is published
+     *
+     * Lets a task sleep on an event group until any of several sensors
+     * updates (see ANDRTF3Group). One target per sensor: a new group
+     * replaces the previous one; pass nullptr to detach.
+     *
+     * @param group Event group to signal
+     * @param bits Bits to set on each new reading
+     */
+    void setUpdateNotification(EventGroupHandle_t group, EventBits_t bits);
+    [[nodiscard]] EventGroupHandle_t getUpdateNotification() const { return _updateGroup; }
+
+    /**
+     * @brief Let a container forget this sensor when it is destroyed
+     *
+     * ANDRTF3Group, ResponsePump and ANDRTF3Poller register here when a
+     * sensor is added; ~ANDRTF3 calls each callback so none of them keeps a
+     * dangling pointer. Registering the same pair again is a no-op.
+     *
+     * @return false if MAX_DETACH_HOOKS containers are already registered
+     */
+    [[nodiscard]] bool addDetachHook(SensorDetachCallback callback, void* context);
+    void removeDetachHook(SensorDetachCallback callback, void* context);
+
+    /**
+     * @brief Run every valid reading through a lag compensator
+     *
+     * The raw value stays in getTemperature() / bound pointers; the
+     * compensated air temperature is available alongside it. Pass nullptr
+     * to detach.
+     */
+    void setLagCompensator(LagCompensator* compensator) { _lagCompensator = compensator; }
+
+    // Compensated air temperature (deci-degrees); raw value without a compensator
+    [[nodiscard]] int16_t getCompensatedTemperature() const noexcept;
+
+    // IDeviceInstance interface
+    IDeviceInstance::DeviceResult<void> initialize() override;
+    IDeviceInstance::DeviceResult<void> requestData() override;
+    IDeviceInstance::DeviceResult<void> processData() override;
+    IDeviceInstance::DeviceResult<std::vector<float>> getData(IDeviceInstance::DeviceDataType dataType) override;
+    IDeviceInstance::DeviceResult<void> performAction(int actionId, int actionParam) override;
+    EventGroupHandle_t getEventGroup() const override { return _eventGroup; }
+
+    /**
+     * @brief Block until the next reading is published (valid or not)
+     *
+     * Waits up to Config::timeout for DATA_READY_BIT or DATA_ERROR_BIT and
+     * clears them. Readings published before the call are reported
+     * immediately.
+     */
+    IDeviceInstance::DeviceResult<void> waitForData() override;
+
     // Static utility method
     static Config getDefaultConfig();
 
+    /**
+     * @brief Apply the driver's validity rules to a raw register value
+     * @return false for the 0x0000 / 0xFFFF fault codes and out-of-range values
+     */
+    static bool decodeTemperature(uint16_t raw, int16_t& celsius);
+
 protected:
     // QueuedModbusDevice interface
     void onAsyncResponse(uint8_t functionCode, uint16_t address,
                         const uint8_t* data, size_t length) override;
 
 private:
-    Config _config;
+    // Cold state, allocated per MemoryPolicy::cold
+    struct DetachHook {
+        SensorDetachCallback callback;
+        void* context;
+    };
+
+    struct ColdState {
+        Config config;
+        Stats stats;
+        DetachHook detachHooks[MAX_DETACH_HOOKS];
+    };
+    ColdState* _cold;
+    MemoryRegion _coldRegion;
+
+    // Hot state: touched on every read
+    uint32_t _timeoutMs;           // config.timeout, kept next to the request state
     TemperatureData _lastReading;
     bool _connected;
-    std::atomic<bool> _asyncPending{false};
+    // Request correlation: tag of the outstanding request (0 = none)
+    std::atomic<uint16_t> _pendingSeq{0};
+    uint16_t _requestSeq;
     uint32_t _asyncStartTime;
+    uint32_t _asyncDeadline;
+    uint8_t _expiredUnanswered;    // Expired requests whose response may still arrive
+    std::atomic<bool> _readQueued{false};
+    std::atomic<uint32_t> _queuedDeadline{0};    // NO_DEADLINE when nothing is queued
 
     // Unified mapping architecture (simple binding)
     int16_t* _temperaturePtr;  // Pointer to tenths of degrees (Temperature_t)
@@ -129,10 +334,60 @@ private:
     // Error tracking for smart retry
     uint8_t _consecutive0x0000Errors;
     uint32_t _lastErrorTime;
+    bool _verifyPending;           // A suspect value awaits its verification read
+
+    // Update notification target (ANDRTF3Group)
+    EventGroupHandle_t _updateGroup;
+    EventBits_t _updateBits;
+
+    // Own DATA_READY / DATA_ERROR event group (IDeviceInstance)
+    EventGroupHandle_t _eventGroup;
+
+    LagCompensator* _lagCompensator;
+
+    Transport* _transport;         // nullptr = local bus
+
+    // Warm state across soft resets (RetainedState::system() entry, -1 = none)
+    int8_t _retainedSlot;
+    uint16_t _retainedBus;         // Bus the entry is keyed by
+    bool _restored;
+
+    /**
+     * Follow-up work of the response path that calls into flash (error
+     * tracker, retained state, lag compensator, error text, logging). settle()
+     * runs it right away, or leaves it for process() while a flash write has
+     * the cache disabled; the reading itself is published either way.
+     */
+    enum FinishWork : uint8_t {
+        FINISH_RETAINED  = 1 << 0,  // saveRetained()
+        FINISH_PUBLISHED = 1 << 1,  // Error tracker success, lag compensator
+        FINISH_ERROR     = 1 << 2,  // Error text: "" if valid, else _finishError
+        FINISH_BAD_DATA  = 1 << 3,  // Error tracker: invalid data
+        FINISH_SUSPECT   = 1 << 4   // Log the rejected value (_suspect*)
+    };
+    std::atomic<uint8_t> _finishPending{0};
+    const char* _finishError;      // String literal for FINISH_ERROR
+    uint16_t _suspectRaw;          // Captured when rejected, logged later
+    uint8_t _suspectCount;
+    bool _suspectQueued;           // Rejection queued a verification read
 
     // Internal methods
     bool performRead();
-    void handleReadComplete(bool success, int16_t value);
+    ModbusError readTemperatureRegister(std::vector<uint16_t>& values);
+    void publishReading(int16_t value);
+    void publishInvalid(const char* error);
+    void rejectSuspectValue(uint16_t raw);
+    void resolveVerification(bool valid);
+    void abandonVerification();
+    void restoreRetained();
+    void saveRetained();
+    uint16_t beginRequest(uint32_t nowMs);
+    bool completeRequest(uint16_t seq, uint32_t nowMs, bool responded);
+    void expirePending(uint32_t nowMs);
+    void recordLatency(uint32_t latencyMs);
+    void settle(uint8_t work);
+    void finish(uint8_t work);
+    void finishDeferred();
     
     // Constants
     static constexpr uint16_t TEMP_REGISTER = 50;      // Temperature register (0-based)
@@ -140,6 +395,11 @@ private:
     static constexpr uint16_t REGISTER_COUNT = 1;      // Single register
     static constexpr int16_t TEMP_MIN = -400;          // -40.0°C
     static constexpr int16_t TEMP_MAX = 1250;          // +125.0°C
+    // Fastest possible answer (8-byte request + 7-byte response at 9600 baud);
+    // anything sooner after a request answers an earlier, expired one
+    static constexpr uint32_t MIN_TURNAROUND_MS = 15;
+    // A verification re-read not on the wire by then is left to the next poll
+    static constexpr uint32_t VERIFY_DEADLINE_MS = 100;
 };
 
 } // namespace andrtf3
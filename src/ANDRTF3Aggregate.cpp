@@ -0,0 +1,177 @@
+/*
+ * ANDRTF3Aggregate.cpp - part of the ESP32-ANDRTF3 library
+ *
+ * Copyright (C) 2025-2026 packerlschupfer
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "ANDRTF3Aggregate.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace andrtf3 {
+
+void Aggregator::accumulateScalar(const int16_t* values, size_t count,
+                                  int16_t bandLow, int16_t bandHigh, AggregateStats& stats) {
+    for (size_t i = 0; i < count; i++) {
+        int16_t v = values[i];
+        if (v == INVALID_SAMPLE) {
+            continue;
+        }
+        stats.sum += v;
+        stats.count++;
+        if (v < stats.min) stats.min = v;
+        if (v > stats.max) stats.max = v;
+        if (v >= bandLow && v <= bandHigh) stats.inBand++;
+    }
+}
+
+#if defined(__SSE2__)
+
+// 16-bit lane counters and 32-bit madd sums stay exact for this many vectors
+static constexpr size_t SSE_CHUNK_VECTORS = 16384;
+
+static int64_t hsum32(__m128i v) {
+    int32_t lanes[4];
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(lanes), v);
+    return static_cast<int64_t>(lanes[0]) + lanes[1] + lanes[2] + lanes[3];
+}
+
+static uint32_t hsum16(__m128i v) {
+    uint16_t lanes[8];
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(lanes), v);
+    uint32_t total = 0;
+    for (int i = 0; i < 8; i++) total += lanes[i];
+    return total;
+}
+
+static int16_t hreduce16(__m128i v, bool wantMax) {
+    int16_t lanes[8];
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(lanes), v);
+    int16_t r = lanes[0];
+    for (int i = 1; i < 8; i++) {
+        r = wantMax ? (lanes[i] > r ? lanes[i] : r) : (lanes[i] < r ? lanes[i] : r);
+    }
+    return r;
+}
+
+void Aggregator::accumulate(const int16_t* values, size_t count,
+                            int16_t bandLow, int16_t bandHigh, AggregateStats& stats) {
+    const __m128i invalid = _mm_set1_epi16(INVALID_SAMPLE);
+    const __m128i low = _mm_set1_epi16(bandLow);
+    const __m128i high = _mm_set1_epi16(bandHigh);
+    const __m128i ones = _mm_set1_epi16(1);
+    const __m128i maxFill = _mm_set1_epi16(INT16_MAX);
+    __m128i vmin = _mm_set1_epi16(stats.min);
+    __m128i vmax = _mm_set1_epi16(stats.max);
+
+    size_t i = 0;
+    while (count - i >= 8) {
+        size_t vectors = (count - i) / 8;
+        if (vectors > SSE_CHUNK_VECTORS) {
+            vectors = SSE_CHUNK_VECTORS;
+        }
+        __m128i sum = _mm_setzero_si128();
+        __m128i valid = _mm_setzero_si128();
+        __m128i band = _mm_setzero_si128();
+
+        for (size_t n = 0; n < vectors; n++, i += 8) {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(values + i));
+            __m128i isInvalid = _mm_cmpeq_epi16(v, invalid);
+            __m128i masked = _mm_andnot_si128(isInvalid, v);             // Invalid -> 0
+            sum = _mm_add_epi32(sum, _mm_madd_epi16(masked, ones));
+            valid = _mm_add_epi16(valid, _mm_andnot_si128(isInvalid, ones));
+            // INVALID_SAMPLE == INT16_MIN never wins max; swap in INT16_MAX for min
+            vmin = _mm_min_epi16(vmin, _mm_or_si128(masked, _mm_and_si128(isInvalid, maxFill)));
+            vmax = _mm_max_epi16(vmax, v);
+            __m128i outside = _mm_or_si128(_mm_or_si128(_mm_cmplt_epi16(v, low), _mm_cmpgt_epi16(v, high)),
+                                           isInvalid);
+            band = _mm_add_epi16(band, _mm_andnot_si128(outside, ones));
+        }
+
+        stats.sum += hsum32(sum);
+        stats.count += hsum16(valid);
+        stats.inBand += hsum16(band);
+    }
+    stats.min = hreduce16(vmin, false);
+    stats.max = hreduce16(vmax, true);
+
+    accumulateScalar(values + i, count - i, bandLow, bandHigh, stats);
+}
+
+const char* Aggregator::kernelName() {
+    return "sse2";
+}
+
+#else
+
+// Block size keeps the 32-bit partial sum exact (32767 * 65536 < 2^31)
+static constexpr size_t AUTO_CHUNK = 65536;
+
+void Aggregator::accumulate(const int16_t* values, size_t count,
+                            int16_t bandLow, int16_t bandHigh, AggregateStats& stats) {
+    // Branch-free body with narrow accumulators so the loop vectorizes
+    int16_t mn = stats.min;
+    int16_t mx = stats.max;
+    for (size_t base = 0; base < count; base += AUTO_CHUNK) {
+        size_t end = (count - base < AUTO_CHUNK) ? count : base + AUTO_CHUNK;
+        int32_t sum = 0;
+        uint32_t valid = 0;
+        uint32_t band = 0;
+        for (size_t i = base; i < end; i++) {
+            int16_t v = values[i];
+            bool ok = (v != INVALID_SAMPLE);
+            sum += ok ? v : 0;
+            valid += ok;
+            int16_t forMin = ok ? v : INT16_MAX;
+            mn = (forMin < mn) ? forMin : mn;
+            mx = (v > mx) ? v : mx;                  // INVALID_SAMPLE never wins
+            band += ok & (v >= bandLow) & (v <= bandHigh);
+        }
+        stats.sum += sum;
+        stats.count += valid;
+        stats.inBand += band;
+    }
+    stats.min = mn;
+    stats.max = mx;
+}
+
+const char* Aggregator::kernelName() {
+    return "auto";
+}
+
+#endif
+
+size_t Aggregator::gatherColumn(const history::Record* records, size_t count, uint8_t address,
+                                int16_t* out, size_t maxOut) {
+    if (records == nullptr || out == nullptr) {
+        return 0;
+    }
+    size_t n = 0;
+    for (size_t i = 0; i < count && n < maxOut; i++) {
+        const history::Record& r = records[i];
+        if (address != 0 && r.address != address) {
+            continue;
+        }
+        out[n++] = (r.flags & history::FLAG_VALID) ? r.celsius : INVALID_SAMPLE;
+    }
+    return n;
+}
+
+} // namespace andrtf3
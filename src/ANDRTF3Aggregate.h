@@ -0,0 +1,100 @@
+/*
+ * ANDRTF3Aggregate.h - part of the ESP32-ANDRTF3 library
+ *
+ * Copyright (C) 2025-2026 packerlschupfer
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+
+#ifndef ANDRTF3_AGGREGATE_H
+#define ANDRTF3_AGGREGATE_H
+
+#include "ANDRTF3History.h"
+
+namespace andrtf3 {
+
+/**
+ * Running statistics over deci-degree samples
+ */
+struct AggregateStats {
+    int64_t sum;
+    uint32_t count;                // Valid samples
+    int16_t min;
+    int16_t max;
+    uint32_t inBand;               // Valid samples within [bandLow, bandHigh]
+
+    void clear() {
+        sum = 0;
+        count = 0;
+        min = INT16_MAX;
+        max = INT16_MIN;
+        inBand = 0;
+    }
+
+    // Mean in deci-degrees (rounded toward zero), 0 if empty
+    [[nodiscard]] int16_t mean() const {
+        return count ? static_cast<int16_t>(sum / static_cast<int64_t>(count)) : 0;
+    }
+
+    // Comfort compliance: share of valid samples inside the band
+    [[nodiscard]] uint16_t compliancePermille() const {
+        return count ? static_cast<uint16_t>((static_cast<uint64_t>(inBand) * 1000u) / count) : 0;
+    }
+};
+
+/**
+ * Bulk aggregation kernels over columnar int16 arrays
+ *
+ * Gateways summarize thousands of sensors over months of samples. The
+ * kernels take one flat int16_t column (deci-degrees, INVALID_SAMPLE for
+ * missing readings) and compute sum / count / min / max / in-band count in
+ * a single pass.
+ *
+ * accumulate() uses SSE2 on x86 hosts. Elsewhere it uses a branch-free loop
+ * that the compiler vectorizes for NEON at -O2/-O3 and that runs as plain
+ * scalar code on the ESP32. accumulateScalar() is the straightforward
+ * reference loop, kept for testing and benchmarks.
+ */
+class Aggregator {
+public:
+    static constexpr int16_t INVALID_SAMPLE = INT16_MIN;
+
+    /**
+     * @brief Merge a column into stats (call stats.clear() first)
+     * @param bandLow,bandHigh Inclusive comfort band, deci-degrees
+     */
+    static void accumulate(const int16_t* values, size_t count,
+                           int16_t bandLow, int16_t bandHigh, AggregateStats& stats);
+
+    static void accumulateScalar(const int16_t* values, size_t count,
+                                 int16_t bandLow, int16_t bandHigh, AggregateStats& stats);
+
+    // Name of the kernel accumulate() dispatches to ("sse2", "auto")
+    static const char* kernelName();
+
+    /**
+     * @brief Extract a column from history records
+     * @param address Only this sensor (0 = all sensors)
+     * @return number of samples written to out
+     */
+    static size_t gatherColumn(const history::Record* records, size_t count, uint8_t address,
+                               int16_t* out, size_t maxOut);
+};
+
+} // namespace andrtf3
+
+#endif // ANDRTF3_AGGREGATE_H
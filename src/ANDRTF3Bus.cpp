@@ -0,0 +1,179 @@
+/*
+ * ANDRTF3Bus.cpp - part of the ESP32-ANDRTF3 library
+ *
+ * Copyright (C) 2025-2026 packerlschupfer
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+
+#include "ANDRTF3Bus.h"
+#include "ANDRTF3.h"
+#include "ANDRTF3Logging.h"
+#include "ANDRTF3Scheduler.h"
+
+namespace andrtf3 {
+
+ANDRTF3Bus::ANDRTF3Bus(Transport* transport, uint32_t timeoutMs)
+    : _transport(transport),
+      _timeoutMs(timeoutMs),
+      _slots{},
+      _queued{},
+      _count(0),
+      _next(0),
+      _callback(nullptr),
+      _callbackContext(nullptr),
+      _completed(0),
+      _failed(0),
+      _expired(0) {
+}
+
+int ANDRTF3Bus::add(uint8_t address) {
+    if (address == 0 || address > 247) {
+        return -1;
+    }
+    if (_count >= MAX_SENSORS) {
+        ANDRTF3_LOG_W("Bus full (%d sensors), address %d not added", static_cast<int>(MAX_SENSORS), address);
+        return -1;
+    }
+    Slot& slot = _slots[_count];
+    slot.address = address;
+    slot.deadlineMs.store(0, std::memory_order_relaxed);
+    slot.reading.store(0, std::memory_order_relaxed);
+    slot.timestampMs.store(0, std::memory_order_relaxed);
+    return static_cast<int>(_count++);
+}
+
+bool ANDRTF3Bus::request(size_t slot, uint32_t deadlineMs) {
+    if (slot >= _count) {
+        return false;
+    }
+    Slot& s = _slots[slot];
+    uint32_t bit = 1UL << (slot % 32);
+    std::atomic<uint32_t>& word = _queued[slot / 32];
+
+    // Deadline before bit: service() that sees the bit also sees the deadline.
+    // A read already queued is coalesced and keeps the later deadline.
+    raiseDeadline(s.deadlineMs, deadlineMs);
+    if (word.fetch_or(bit, std::memory_order_release) & bit) {
+        _coalesced.fetch_add(1, std::memory_order_relaxed);
+    } else {
+        _requests.fetch_add(1, std::memory_order_relaxed);
+    }
+    return true;
+}
+
+bool ANDRTF3Bus::isQueued(size_t slot) const {
+    return slot < _count && (_queued[slot / 32].load(std::memory_order_acquire) & (1UL << (slot % 32))) != 0;
+}
+
+bool ANDRTF3Bus::service() {
+    if (_transport == nullptr) {
+        return false;
+    }
+    for (size_t i = 0; i < _count; i++) {
+        size_t index = (_next + i) % _count;
+        uint32_t bit = 1UL << (index % 32);
+        if ((_queued[index / 32].fetch_and(~bit, std::memory_order_acq_rel) & bit) == 0) {
+            continue;
+        }
+        _next = (index + 1) % _count;
+
+        Slot& slot = _slots[index];
+        uint32_t deadline = slot.deadlineMs.exchange(NO_DEADLINE, std::memory_order_acq_rel);
+        if (deadline == NO_DEADLINE) {
+            continue;   // Raised after the previous read took the bit: that read served it
+        }
+        uint32_t now = millis();
+        if (timeReached(now, deadline)) {
+            _expired++;
+            ANDRTF3_LOG_D("Bus: dropped expired read of addr=%d", slot.address);
+            continue;
+        }
+
+        uint16_t raw = 0;
+        ModbusError error = _transport->readInputRegisters(slot.address, TEMP_REGISTER, 1, &raw, _timeoutMs);
+        int16_t celsius = 0;
+        bool valid = (error == ModbusError::SUCCESS) && ANDRTF3::decodeTemperature(raw, celsius);
+        complete(index, valid, celsius);
+        return true;
+    }
+    return false;
+}
+
+void ANDRTF3Bus::complete(size_t index, bool valid, int16_t celsius) {
+    Slot& slot = _slots[index];
+    uint32_t previous = slot.reading.load(std::memory_order_relaxed);
+    uint32_t packed;
+    if (valid) {
+        _completed++;
+        slot.timestampMs.store(millis(), std::memory_order_relaxed);
+        packed = static_cast<uint16_t>(celsius) | READING_VALID | READING_SEEN;
+    } else {
+        _failed++;
+        // Keep the last valid value; count consecutive failures
+        uint32_t failures = previous >> FAILURE_SHIFT;
+        if (failures < 0xFF) {
+            failures++;
+        }
+        packed = (previous & (0xFFFFUL | READING_SEEN)) | (failures << FAILURE_SHIFT);
+        celsius = static_cast<int16_t>(previous & 0xFFFF);
+        ANDRTF3_LOG_D("Bus: read of addr=%d failed (%lu consecutive)", slot.address,
+                      static_cast<unsigned long>(failures));
+    }
+    slot.reading.store(packed, std::memory_order_release);
+
+    if (_callback != nullptr) {
+        _callback(index, slot.address, celsius, valid, _callbackContext);
+    }
+}
+
+bool ANDRTF3Bus::getReading(size_t slot, Reading& out) const {
+    if (slot >= _count) {
+        return false;
+    }
+    const Slot& s = _slots[slot];
+    uint32_t packed = s.reading.load(std::memory_order_acquire);
+    out.celsius = static_cast<int16_t>(packed & 0xFFFF);
+    out.timestampMs = (packed & READING_SEEN) ? s.timestampMs.load(std::memory_order_relaxed) : 0;
+    out.failures = static_cast<uint8_t>(packed >> FAILURE_SHIFT);
+    out.valid = (packed & READING_VALID) != 0;
+    return (packed & READING_SEEN) != 0;
+}
+
+ANDRTF3Bus::Stats ANDRTF3Bus::getStats() const {
+    Stats stats;
+    stats.requests = _requests.load(std::memory_order_relaxed);
+    stats.coalesced = _coalesced.load(std::memory_order_relaxed);
+    stats.completed = _completed;
+    stats.failed = _failed;
+    stats.expired = _expired;
+    return stats;
+}
+
+ANDRTF3Bus::Footprint ANDRTF3Bus::footprint(size_t sensors) {
+    Footprint fp;
+    fp.sensors = sensors;
+    fp.slotBytes = sizeof(Slot);
+    fp.sharedBytes = sizeof(ANDRTF3Bus) - MAX_SENSORS * sizeof(Slot);
+    fp.totalBytes = sizeof(ANDRTF3Bus);
+    fp.instanceBytes = sizeof(ANDRTF3) + ANDRTF3::coldStateBytes();
+    size_t perInstance = sensors * fp.instanceBytes;
+    fp.savedBytes = (perInstance > fp.totalBytes) ? perInstance - fp.totalBytes : 0;
+    return fp;
+}
+
+} // namespace andrtf3
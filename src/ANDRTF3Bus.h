@@ -0,0 +1,175 @@
+/*
+ * ANDRTF3Bus.h - part of the ESP32-ANDRTF3 library
+ *
+ * Copyright (C) 2025-2026 packerlschupfer
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+
+#ifndef ANDRTF3_BUS_H
+#define ANDRTF3_BUS_H
+
+#include "ANDRTF3Transport.h"
+#include <atomic>
+
+namespace andrtf3 {
+
+// Called by ANDRTF3Bus::service() after each completed read
+typedef void (*BusReadingCallback)(size_t slot, uint8_t address, int16_t celsius, bool valid, void* context);
+
+/**
+ * Shared-bus mode for large ANDRTF3 fleets
+ *
+ * A full ANDRTF3 instance carries its own framework queue, event group,
+ * error string and statistics. On a bus where every sensor has at most one
+ * request outstanding, that is mostly duplicated RAM. ANDRTF3Bus keeps one
+ * request bitmap and one transport for the whole bus, and a compact slot
+ * (16 bytes) per sensor holding the queued deadline and the latest
+ * reading.
+ *
+ * Any task may request(); requests coalesce per slot (one outstanding
+ * read per sensor, later deadline wins). The bus task calls service(), which
+ * performs one transaction for the next queued slot in round-robin order.
+ * Requests whose deadline passed are dropped before transmission. Values are
+ * validated like the driver's (ANDRTF3::decodeTemperature()). Readings can be
+ * fetched from any task without locks.
+ *
+ * footprint() reports the RAM of this mode against one ANDRTF3 object per
+ * sensor.
+ *
+ * Example usage:
+ * @code
+ * RtuTcpTransport transport("10.0.0.40", 502);   // Or LocalBusTransport on ESP32
+ * ANDRTF3Bus bus(&transport);
+ * for (uint8_t addr = 1; addr <= 40; addr++) bus.add(addr);
+ *
+ * // Any task:
+ * bus.request(slot, millis() + 1000);
+ * // Bus task:
+ * for (;;) { if (!bus.service()) vTaskDelay(pdMS_TO_TICKS(10)); }
+ * @endcode
+ */
+class ANDRTF3Bus {
+public:
+    static constexpr size_t MAX_SENSORS = 64;
+
+    struct Reading {
+        int16_t celsius;            // Last valid value (deci-degrees)
+        uint32_t timestampMs;       // When it was read (0 = never)
+        uint8_t failures;           // Consecutive failed reads since
+        bool valid;                 // Latest read succeeded
+    };
+
+    struct Stats {
+        uint32_t requests;          // request() calls that queued a read
+        uint32_t coalesced;         // request() calls merged into a queued read
+        uint32_t completed;         // Reads with a valid value
+        uint32_t failed;            // Transport errors and invalid values
+        uint32_t expired;           // Dropped before transmission (deadline passed)
+    };
+
+    struct Footprint {
+        size_t sensors;
+        size_t sharedBytes;         // Bus object without its slots
+        size_t slotBytes;           // Per sensor in this mode
+        size_t totalBytes;          // Whole bus object (MAX_SENSORS slots)
+        size_t instanceBytes;       // Per sensor as an ANDRTF3 object, see footprint()
+        size_t savedBytes;          // sensors * instanceBytes - totalBytes (0 if not smaller)
+    };
+
+    explicit ANDRTF3Bus(Transport* transport, uint32_t timeoutMs = 200);
+
+    ANDRTF3Bus(const ANDRTF3Bus&) = delete;
+    ANDRTF3Bus& operator=(const ANDRTF3Bus&) = delete;
+
+    /**
+     * @brief Add a sensor (before service() starts)
+     * @return slot index, or -1 if full or the address is invalid
+     */
+    [[nodiscard]] int add(uint8_t address);
+
+    /**
+     * @brief Queue one read of slot, worth doing until deadlineMs
+     * @return false if the slot does not exist
+     */
+    bool request(size_t slot, uint32_t deadlineMs);
+    [[nodiscard]] bool isQueued(size_t slot) const;
+
+    /**
+     * @brief Perform the next queued read (bus task)
+     * @return true if a transaction was performed
+     */
+    bool service();
+
+    [[nodiscard]] bool getReading(size_t slot, Reading& out) const;
+    [[nodiscard]] uint8_t getAddress(size_t slot) const { return slot < _count ? _slots[slot].address : 0; }
+    [[nodiscard]] size_t size() const noexcept { return _count; }
+
+    void setCallback(BusReadingCallback callback, void* context) {
+        _callback = callback;
+        _callbackContext = context;
+    }
+
+    [[nodiscard]] Stats getStats() const;
+
+    /**
+     * @brief RAM of this mode for a fleet of the given size
+     *
+     * All figures are sizeof() on the calling build, so a host build
+     * reports host sizes. instanceBytes is the ANDRTF3 object plus its
+     * cold block. It leaves out the framework's per-device queue, the
+     * event group and other RTOS objects, and String heap, so the real
+     * per-object cost on ESP32 is higher and savedBytes is a lower bound.
+     */
+    static Footprint footprint(size_t sensors);
+
+private:
+    static constexpr uint16_t TEMP_REGISTER = 50;       // Same register as ANDRTF3
+    static constexpr size_t WORDS = (MAX_SENSORS + 31) / 32;
+
+    // Reading word: celsius in the low 16 bits, flags and failure count above
+    static constexpr uint32_t READING_VALID = 1UL << 16;
+    static constexpr uint32_t READING_SEEN = 1UL << 17;  // At least one valid value
+    static constexpr uint32_t FAILURE_SHIFT = 24;
+
+    struct Slot {
+        std::atomic<uint32_t> deadlineMs;   // Of the queued read
+        std::atomic<uint32_t> reading;      // Packed, see READING_*
+        std::atomic<uint32_t> timestampMs;  // Of the last valid value
+        uint8_t address;
+    };
+
+    void complete(size_t index, bool valid, int16_t celsius);
+
+    Transport* _transport;
+    uint32_t _timeoutMs;
+    Slot _slots[MAX_SENSORS];
+    std::atomic<uint32_t> _queued[WORDS];
+    size_t _count;
+    size_t _next;                   // Round-robin position of service()
+    BusReadingCallback _callback;
+    void* _callbackContext;
+    std::atomic<uint32_t> _requests{0};
+    std::atomic<uint32_t> _coalesced{0};
+    uint32_t _completed;
+    uint32_t _failed;
+    uint32_t _expired;
+};
+
+} // namespace andrtf3
+
+#endif // ANDRTF3_BUS_H
@@ -0,0 +1,302 @@
+/*
+ * ANDRTF3Characterizer.cpp - part of the ESP32-ANDRTF3 library
+ *
+ * Copyright (C) 2025-2026 packerlschupfer
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "ANDRTF3Characterizer.h"
+#include "ANDRTF3Logging.h"
+#include <math.h>
+
+namespace andrtf3 {
+
+// Regression sums stay inside int64 up to this many fit points
+static constexpr int64_t MAX_FIT_POINTS = 8192;
+
+static int32_t abs32(int32_t v) {
+    return v < 0 ? -v : v;
+}
+
+static uint32_t isqrt64(uint64_t v) {
+    uint64_t r = 0;
+    uint64_t bit = 1ULL << 62;
+    while (bit > v) bit >>= 2;
+    while (bit != 0) {
+        if (v >= r + bit) {
+            v -= r + bit;
+            r = (r >> 1) + bit;
+        } else {
+            r >>= 1;
+        }
+        bit >>= 2;
+    }
+    return static_cast<uint32_t>(r);
+}
+
+// ========== Characterizer ==========
+
+Characterizer::Characterizer()
+    : Characterizer(getDefaultConfig()) {
+}
+
+Characterizer::Characterizer(const Config& config)
+    : _config(config) {
+    if (_config.slopeWindowMs < SLOPE_TAPS) {
+        _config.slopeWindowMs = SLOPE_TAPS;
+    }
+    begin(0);
+}
+
+Characterizer::Config Characterizer::getDefaultConfig() {
+    return {
+        30000,      // baselineMs
+        10000,      // slopeWindowMs
+        5,          // stepThreshold (0.5°C)
+        60000,      // settleMs
+        1800000,    // maxDurationMs (30 min)
+        1000,       // minPollMs
+        60000       // maxPollMs
+    };
+}
+
+void Characterizer::begin(uint32_t nowMs) {
+    _phase = Phase::BASELINE;
+    _startMs = nowMs;
+    _phaseStartMs = nowMs;
+    _samples = 0;
+    _lastMs = nowMs;
+    _baseSum = 0;
+    _baseSumSq = 0;
+    _baseCount = 0;
+    _baseline = 0;
+    _noiseMilli = 0;
+    _tapCount = 0;
+    _tapHead = 0;
+    _accSum = 0;
+    _accCount = 0;
+    _accStartMs = nowMs;
+    _n = _sx = _sy = _sxx = _sxy = 0;
+    _quietRef = 0;
+    _quietSinceMs = nowMs;
+    _last = 0;
+    _tauMs = 0;
+}
+
+const char* Characterizer::getPhaseName() const {
+    switch (_phase) {
+        case Phase::BASELINE:  return "baseline";
+        case Phase::WAIT_STEP: return "apply stimulus";
+        case Phase::RESPONSE:  return "response";
+        case Phase::DONE:      return "done";
+        case Phase::FAILED:    return "failed";
+    }
+    return "?";
+}
+
+Characterizer::Phase Characterizer::addSample(int16_t value, uint32_t nowMs) {
+    if (_phase == Phase::DONE || _phase == Phase::FAILED) {
+        return _phase;
+    }
+    _samples++;
+    _lastMs = nowMs;
+    _last = value;
+
+    if (nowMs - _startMs > _config.maxDurationMs) {
+        // A response followed for at least one time constant still fits well
+        uint32_t tau = (_phase == Phase::RESPONSE) ? getTauEstimateMs() : 0;
+        finish(tau > 0 && nowMs - _phaseStartMs >= tau, nowMs);
+        return _phase;
+    }
+
+    // Readings closer than 3 sigma (at least 0.2°C) to a reference count as quiet
+    int32_t quietBand = 3 * _noiseMilli / 100 + 1;
+    if (quietBand < 2) {
+        quietBand = 2;
+    }
+
+    switch (_phase) {
+        case Phase::BASELINE:
+            _baseSum += value;
+            _baseSumSq += static_cast<int64_t>(value) * value;
+            _baseCount++;
+            if (nowMs - _phaseStartMs >= _config.baselineMs && _baseCount >= 2) {
+                int64_t n = _baseCount;
+                _baseline = static_cast<int16_t>((_baseSum + n / 2) / n);
+                // Variance in deci^2, reported as RMS in milli-degrees
+                int64_t var100 = (n * _baseSumSq - _baseSum * _baseSum) * 10000 / (n * n);
+                _noiseMilli = static_cast<uint16_t>(isqrt64(static_cast<uint64_t>(var100 > 0 ? var100 : 0)));
+                _phase = Phase::WAIT_STEP;
+                _phaseStartMs = nowMs;
+                ANDRTF3_LOG_I("Characterize: baseline %d, noise %u mdeg; apply stimulus",
+                              _baseline, static_cast<unsigned>(_noiseMilli));
+            }
+            break;
+
+        case Phase::WAIT_STEP: {
+            int32_t threshold = _config.stepThreshold;
+            if (threshold < quietBand + 1) {
+                threshold = quietBand + 1;
+            }
+            if (abs32(static_cast<int32_t>(value) - _baseline) >= threshold) {
+                _phase = Phase::RESPONSE;
+                _phaseStartMs = nowMs;
+                _quietRef = value;
+                _quietSinceMs = nowMs;
+                _accStartMs = nowMs;
+                fitSample(value, nowMs);
+            }
+            break;
+        }
+
+        case Phase::RESPONSE: {
+            fitSample(value, nowMs);
+            uint32_t holdMs = 2 * getTauEstimateMs();
+            if (holdMs < _config.settleMs) {
+                holdMs = _config.settleMs;
+            }
+            if (abs32(static_cast<int32_t>(value) - _quietRef) > quietBand) {
+                _quietRef = value;
+                _quietSinceMs = nowMs;
+            } else if (nowMs - _quietSinceMs >= holdMs) {
+                finish(true, nowMs);
+            }
+            break;
+        }
+
+        default:
+            break;
+    }
+    return _phase;
+}
+
+void Characterizer::fitSample(int16_t value, uint32_t nowMs) {
+    // Samples are averaged into taps spaced slopeWindowMs / SLOPE_TAPS apart
+    // (at 10 Hz that averages away most of the 0.1°C quantization). Each new
+    // tap pairs with the oldest one for a slope over the whole window.
+    _accSum += value;
+    _accCount++;
+    const uint32_t spacing = _config.slopeWindowMs / SLOPE_TAPS;
+    if (nowMs - _accStartMs < spacing) {
+        return;
+    }
+
+    Tap tap = { _accStartMs + (nowMs - _accStartMs) / 2,
+                static_cast<int32_t>((_accSum * 100) / _accCount) };
+    _accSum = 0;
+    _accCount = 0;
+    _accStartMs = nowMs;
+
+    if (_tapCount < SLOPE_TAPS) {
+        _taps[(_tapHead + _tapCount) % SLOPE_TAPS] = tap;
+        _tapCount++;
+        return;
+    }
+
+    const Tap& oldest = _taps[_tapHead];
+    uint32_t dt = tap.ms - oldest.ms;
+    if (dt > 0 && _n < MAX_FIT_POINTS) {
+        // x = 2 * mid-level (milli), y = slope (milli/s * 1000)
+        int64_t x = static_cast<int64_t>(tap.milli) + oldest.milli;
+        int64_t y = (static_cast<int64_t>(tap.milli - oldest.milli) * 1000000) / dt;
+        _n++;
+        _sx += x;
+        _sy += y;
+        _sxx += x * x;
+        _sxy += x * y;
+    }
+    _taps[_tapHead] = tap;
+    _tapHead = (_tapHead + 1) % SLOPE_TAPS;
+}
+
+uint32_t Characterizer::getTauEstimateMs() const {
+    if (_phase == Phase::DONE) {
+        return _tauMs;
+    }
+    if (_n < 8) {
+        return 0;
+    }
+    int64_t varX = _n * _sxx - _sx * _sx;
+    int64_t covXY = _n * _sxy - _sx * _sy;
+    if (varX <= 0 || covXY >= 0) {
+        return 0;
+    }
+    // gradient = -1/tau in these units is -500 / tau_s
+    int64_t tauMs = (-500000 * (varX / 1000)) / (covXY / 1000 != 0 ? covXY / 1000 : -1);
+    return (tauMs > 0 && tauMs < INT32_MAX) ? static_cast<uint32_t>(tauMs) : 0;
+}
+
+void Characterizer::finish(bool ok, uint32_t nowMs) {
+    _tauMs = ok ? getTauEstimateMs() : 0;
+    _phase = (_tauMs > 0) ? Phase::DONE : Phase::FAILED;
+    ANDRTF3_LOG_I("Characterize: %s after %lu ms, tau %lu ms", getPhaseName(),
+                  static_cast<unsigned long>(nowMs - _startMs), static_cast<unsigned long>(_tauMs));
+}
+
+Characterizer::Report Characterizer::getReport() const {
+    Report r = {};
+    r.tauMs = (_phase == Phase::DONE) ? _tauMs : getTauEstimateMs();
+    r.noiseMilli = _noiseMilli;
+    r.baseline = _baseline;
+    r.stepDeci = static_cast<int16_t>(_last - _baseline);
+    r.samples = _samples;
+    uint32_t elapsed = _lastMs - _startMs;
+    r.sampleRateCentiHz = elapsed ? static_cast<uint16_t>((static_cast<uint64_t>(_samples) * 100000u) / elapsed) : 0;
+
+    // Five samples per time constant resolves the response; faster polling
+    // mostly samples noise
+    uint32_t poll = (r.tauMs / 5 + 50) / 100 * 100;
+    if (poll < _config.minPollMs) poll = _config.minPollMs;
+    if (poll > _config.maxPollMs) poll = _config.maxPollMs;
+    r.recommendedPollMs = poll;
+    return r;
+}
+
+// ========== ThermalEmulator ==========
+
+ThermalEmulator::ThermalEmulator(uint32_t tauMs, int16_t startDeci, uint16_t noiseMilli, uint32_t seed)
+    : _tauMs(tauMs > 0 ? tauMs : 1),
+      _airMilli(static_cast<int32_t>(startDeci) * 100),
+      _sensorMilli(static_cast<float>(startDeci) * 100.0f),
+      _noiseMilli(noiseMilli),
+      _lastMs(0),
+      _rng(seed ? seed : 1),
+      _started(false) {
+}
+
+int16_t ThermalEmulator::read(uint32_t nowMs) {
+    if (_started) {
+        uint32_t dt = nowMs - _lastMs;
+        float decay = expf(-static_cast<float>(dt) / static_cast<float>(_tauMs));
+        // Float state: truncating the per-step change would speed up the plant
+        _sensorMilli = static_cast<float>(_airMilli) + (_sensorMilli - static_cast<float>(_airMilli)) * decay;
+    }
+    _started = true;
+    _lastMs = nowMs;
+
+    // Uniform noise with the requested RMS (half-width = rms * sqrt(3))
+    _rng ^= _rng << 13;
+    _rng ^= _rng >> 17;
+    _rng ^= _rng << 5;
+    int32_t halfWidth = (static_cast<int32_t>(_noiseMilli) * 1732) / 1000;
+    int32_t noise = halfWidth ? static_cast<int32_t>(_rng % static_cast<uint32_t>(2 * halfWidth + 1)) - halfWidth : 0;
+
+    int32_t milli = static_cast<int32_t>(lroundf(_sensorMilli)) + noise;
+    return static_cast<int16_t>((milli >= 0 ? milli + 50 : milli - 50) / 100);
+}
+
+} // namespace andrtf3
@@ -0,0 +1,166 @@
+/*
+ * ANDRTF3Characterizer.h - part of the ESP32-ANDRTF3 library
+ *
+ * Copyright (C) 2025-2026 packerlschupfer
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+
+#ifndef ANDRTF3_CHARACTERIZER_H
+#define ANDRTF3_CHARACTERIZER_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+namespace andrtf3 {
+
+/**
+ * Thermal time-constant characterization (commissioning)
+ *
+ * Feed readings taken at a high rate (the sensor answers at close to 10 Hz)
+ * while the sensor is stimulated, for example with a warm hand, a hair dryer
+ * or moving it to another room:
+ *
+ *   BASELINE   quiet period; mean and noise floor are measured
+ *   WAIT_STEP  apply the stimulus now; waits for a departure from baseline
+ *   RESPONSE   first-order fit updated with every sample until settled
+ *   DONE       report ready (FAILED on timeout or an unusable response)
+ *
+ * The fit is the one LagCompensator uses: slope against level is a
+ * line with gradient -1/tau. Only running sums are kept, so the estimate is
+ * available live during the response and memory use is constant.
+ */
+class Characterizer {
+public:
+    static constexpr size_t SLOPE_TAPS = 32;
+
+    struct Config {
+        uint32_t baselineMs;        // Noise measurement period
+        uint32_t slopeWindowMs;     // Span of each slope in the fit
+        int16_t stepThreshold;      // Minimum departure from baseline (plus 3 sigma)
+        uint32_t settleMs;          // Minimum quiet hold that ends the response
+        uint32_t maxDurationMs;     // Give up after this long in total
+        uint32_t minPollMs;         // Recommended interval bounds
+        uint32_t maxPollMs;
+    };
+
+    enum class Phase : uint8_t {
+        BASELINE,
+        WAIT_STEP,
+        RESPONSE,
+        DONE,
+        FAILED
+    };
+
+    struct Report {
+        uint32_t tauMs;             // Effective first-order time constant
+        uint16_t noiseMilli;        // RMS noise during baseline, milli-degrees
+        int16_t baseline;           // Deci-degrees
+        int16_t stepDeci;           // Size of the observed step
+        uint32_t samples;
+        uint16_t sampleRateCentiHz; // Achieved rate (1000 = 10 Hz)
+        uint32_t recommendedPollMs; // tau / 5 within [minPollMs, maxPollMs]
+    };
+
+    Characterizer();
+    explicit Characterizer(const Config& config);
+
+    static Config getDefaultConfig();
+
+    void begin(uint32_t nowMs);
+
+    // Feed one valid reading (deci-degrees)
+    Phase addSample(int16_t value, uint32_t nowMs);
+
+    [[nodiscard]] Phase getPhase() const noexcept { return _phase; }
+    [[nodiscard]] const char* getPhaseName() const;
+
+    // Live estimate during RESPONSE (0 until enough data)
+    [[nodiscard]] uint32_t getTauEstimateMs() const;
+
+    // Valid in DONE; partial fields otherwise
+    [[nodiscard]] Report getReport() const;
+
+private:
+    struct Tap {
+        uint32_t ms;                // Mid-point of the averaged samples
+        int32_t milli;              // Average, milli-degrees
+    };
+
+    void fitSample(int16_t value, uint32_t nowMs);
+    void finish(bool ok, uint32_t nowMs);
+
+    Config _config;
+    Phase _phase;
+    uint32_t _startMs;
+    uint32_t _phaseStartMs;
+    uint32_t _samples;
+    uint32_t _lastMs;
+
+    // Baseline statistics
+    int64_t _baseSum;
+    int64_t _baseSumSq;
+    uint32_t _baseCount;
+    int16_t _baseline;
+    uint16_t _noiseMilli;
+
+    // Slope taps and regression sums
+    int32_t _accSum;            // Samples being averaged into the next tap
+    uint32_t _accCount;
+    uint32_t _accStartMs;
+    Tap _taps[SLOPE_TAPS];
+    size_t _tapCount;
+    size_t _tapHead;
+    int64_t _n, _sx, _sy, _sxx, _sxy;
+
+    int16_t _quietRef;
+    uint32_t _quietSinceMs;
+    int16_t _last;
+    uint32_t _tauMs;
+};
+
+/**
+ * First-order thermal plant with noise and 0.1°C quantization
+ *
+ * Stands in for a sensor when the characterization routine (or lag
+ * compensation) is exercised without hardware.
+ */
+class ThermalEmulator {
+public:
+    ThermalEmulator(uint32_t tauMs, int16_t startDeci, uint16_t noiseMilli, uint32_t seed = 1);
+
+    // Step the surrounding air temperature
+    void setAir(int16_t deci) { _airMilli = static_cast<int32_t>(deci) * 100; }
+
+    // Advance the plant to nowMs and return a quantized reading
+    int16_t read(uint32_t nowMs);
+
+    [[nodiscard]] int32_t getSensorMilli() const noexcept { return static_cast<int32_t>(_sensorMilli); }
+
+private:
+    uint32_t _tauMs;
+    int32_t _airMilli;
+    float _sensorMilli;
+    uint16_t _noiseMilli;
+    uint32_t _lastMs;
+    uint32_t _rng;
+    bool _started;
+};
+
+} // namespace andrtf3
+
+#endif // ANDRTF3_CHARACTERIZER_H
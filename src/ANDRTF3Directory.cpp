@@ -0,0 +1,451 @@
+/*
+ * ANDRTF3Directory.cpp - part of the ESP32-ANDRTF3 library
+ *
+ * Copyright (C) 2025-2026 packerlschupfer
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+
+#include "ANDRTF3Directory.h"
+#include "ANDRTF3Logging.h"
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace andrtf3 {
+
+namespace {
+
+uint64_t mix64(uint64_t x) {
+    // MurmurHash3 finalizer
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdULL;
+    x ^= x >> 33;
+    x *= 0xc4ceb9fe1a85ec53ULL;
+    x ^= x >> 33;
+    return x;
+}
+
+size_t bucketFor(uint64_t hash, uint32_t salt, size_t buckets) {
+    return static_cast<size_t>((mix64(hash ^ salt) >> 32) % buckets);
+}
+
+constexpr uint32_t MAX_SALTS = 16;
+constexpr uint32_t MAX_SEED = 0xFFFF;
+
+} // namespace
+
+// ========== PerfectHash ==========
+
+PerfectHash::PerfectHash()
+    : _seeds(nullptr),
+      _buckets(0),
+      _count(0),
+      _salt(0) {
+}
+
+PerfectHash::~PerfectHash() {
+    clear();
+}
+
+void PerfectHash::clear() {
+    delete[] _seeds;
+    _seeds = nullptr;
+    _buckets = 0;
+    _count = 0;
+}
+
+uint64_t PerfectHash::hashKey(const char* key, size_t length) {
+    // FNV-1a, 64 bit: distinct names practically never collide
+    uint64_t hash = 14695981039346656037ULL;
+    for (size_t i = 0; i < length; i++) {
+        hash ^= static_cast<uint8_t>(key[i]);
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+size_t PerfectHash::slotFor(uint64_t hash, uint16_t seed, uint32_t salt, size_t count) {
+    return static_cast<size_t>(mix64(hash ^ ((seed + 1ULL) * 0x9E3779B97F4A7C15ULL) ^ salt) % count);
+}
+
+bool PerfectHash::build(const char* const* keys, size_t count) {
+    clear();
+    if (count == 0) {
+        return true;
+    }
+
+    std::vector<uint64_t> hashes(count);
+    for (size_t i = 0; i < count; i++) {
+        hashes[i] = hashKey(keys[i], strlen(keys[i]));
+    }
+
+    // About four keys per bucket
+    size_t buckets = (count + 3) / 4;
+    std::vector<std::vector<size_t>> members(buckets);
+    std::vector<size_t> order(buckets);
+    std::vector<uint16_t> seeds(buckets);
+    std::vector<bool> taken(count);
+    std::vector<size_t> slots;
+
+    for (uint32_t salt = 0; salt < MAX_SALTS; salt++) {
+        for (auto& m : members) {
+            m.clear();
+        }
+        for (size_t i = 0; i < count; i++) {
+            members[bucketFor(hashes[i], salt, buckets)].push_back(i);
+        }
+        // Largest buckets first, while most slots are still free
+        for (size_t b = 0; b < buckets; b++) {
+            order[b] = b;
+        }
+        std::sort(order.begin(), order.end(), [&members](size_t a, size_t b) {
+            return members[a].size() > members[b].size();
+        });
+        std::fill(taken.begin(), taken.end(), false);
+
+        bool ok = true;
+        for (size_t b : order) {
+            const std::vector<size_t>& keysInBucket = members[b];
+            if (keysInBucket.empty()) {
+                seeds[b] = 0;
+                continue;
+            }
+            bool placed = false;
+            for (uint32_t seed = 0; seed <= MAX_SEED && !placed; seed++) {
+                slots.clear();
+                bool fits = true;
+                for (size_t key : keysInBucket) {
+                    size_t s = slotFor(hashes[key], static_cast<uint16_t>(seed), salt, count);
+                    if (taken[s] || std::find(slots.begin(), slots.end(), s) != slots.end()) {
+                        fits = false;
+                        break;
+                    }
+                    slots.push_back(s);
+                }
+                if (fits) {
+                    for (size_t s : slots) {
+                        taken[s] = true;
+                    }
+                    seeds[b] = static_cast<uint16_t>(seed);
+                    placed = true;
+                }
+            }
+            if (!placed) {
+                ok = false;
+                break;
+            }
+        }
+
+        if (ok) {
+            _seeds = new uint16_t[buckets];
+            memcpy(_seeds, seeds.data(), buckets * sizeof(uint16_t));
+            _buckets = buckets;
+            _count = count;
+            _salt = salt;
+            return true;
+        }
+    }
+
+    ANDRTF3_LOG_E("PerfectHash: no seeds found for %u keys (duplicates?)", static_cast<unsigned>(count));
+    return false;
+}
+
+size_t PerfectHash::slot(const char* key, size_t length) const {
+    if (_count == 0) {
+        return 0;
+    }
+    uint64_t hash = hashKey(key, length);
+    return slotFor(hash, _seeds[bucketFor(hash, _salt, _buckets)], _salt, _count);
+}
+
+// ========== SensorDirectory ==========
+
+SensorDirectory::SensorDirectory()
+    : _arena(nullptr),
+      _entries(nullptr),
+      _count(0),
+      _tagNames(nullptr),
+      _tagBits(nullptr),
+      _tagCount(0),
+      _words(0),
+      _errorLine(0) {
+}
+
+SensorDirectory::~SensorDirectory() {
+    clear();
+}
+
+void SensorDirectory::clear() {
+    delete[] _arena;
+    delete[] _entries;
+    delete[] _tagNames;
+    delete[] _tagBits;
+    _arena = nullptr;
+    _entries = nullptr;
+    _tagNames = nullptr;
+    _tagBits = nullptr;
+    _count = 0;
+    _tagCount = 0;
+    _words = 0;
+    _nameHash.clear();
+    _tagHash.clear();
+}
+
+bool SensorDirectory::load(const char* manifest, bool prefixTags) {
+    clear();
+    _errorLine = 0;
+    if (manifest == nullptr) {
+        return false;
+    }
+
+    struct Parsed {
+        std::string name;
+        uint16_t bus;
+        uint8_t address;
+        std::vector<std::string> tags;
+    };
+    std::vector<Parsed> sensors;
+    std::unordered_map<std::string, size_t> names;
+
+    // ---- Parse ----
+    size_t lineNumber = 0;
+    const char* line = manifest;
+    while (*line != '\0') {
+        lineNumber++;
+        const char* end = strchr(line, '\n');
+        if (end == nullptr) {
+            end = line + strlen(line);
+        }
+        const char* comment = static_cast<const char*>(memchr(line, '#', static_cast<size_t>(end - line)));
+        const char* stop = (comment != nullptr) ? comment : end;
+
+        std::vector<std::string> tokens;
+        const char* p = line;
+        while (p < stop) {
+            while (p < stop && (*p == ' ' || *p == '\t' || *p == '\r')) {
+                p++;
+            }
+            const char* start = p;
+            while (p < stop && *p != ' ' && *p != '\t' && *p != '\r') {
+                p++;
+            }
+            if (p > start) {
+                tokens.emplace_back(start, static_cast<size_t>(p - start));
+            }
+        }
+        line = (*end == '\n') ? end + 1 : end;
+
+        if (tokens.empty()) {
+            continue;
+        }
+
+        Parsed sensor;
+        sensor.name = tokens[0];
+        unsigned long bus = 0;
+        unsigned long address = 0;
+        char* rest = nullptr;
+        const char* addressText = (tokens.size() >= 2) ? tokens[1].c_str() : "";
+        const char* colon = strchr(addressText, ':');
+        if (colon != nullptr) {
+            bus = strtoul(addressText, &rest, 10);
+            if (rest != colon) {
+                rest = nullptr;
+            } else {
+                address = strtoul(colon + 1, &rest, 10);
+            }
+        } else {
+            address = strtoul(addressText, &rest, 10);
+        }
+        if (tokens.size() < 2 || rest == nullptr || *rest != '\0' || rest == addressText ||
+            address < 1 || address > 247 || bus > 0xFFFF ||
+            names.count(sensor.name) != 0 || sensors.size() >= MAX_SENSORS) {
+            ANDRTF3_LOG_E("Manifest line %u: invalid or duplicate entry", static_cast<unsigned>(lineNumber));
+            _errorLine = lineNumber;
+            return false;
+        }
+        sensor.bus = static_cast<uint16_t>(bus);
+        sensor.address = static_cast<uint8_t>(address);
+        sensor.tags.assign(tokens.begin() + 2, tokens.end());
+        if (prefixTags) {
+            for (size_t slash = sensor.name.find('/'); slash != std::string::npos;
+                 slash = sensor.name.find('/', slash + 1)) {
+                sensor.tags.push_back(sensor.name.substr(0, slash));
+            }
+        }
+        names[sensor.name] = sensors.size();
+        sensors.push_back(std::move(sensor));
+    }
+
+    // ---- Collect tags ----
+    std::unordered_map<std::string, size_t> tagIds;
+    std::vector<const std::string*> tagList;
+    for (const Parsed& sensor : sensors) {
+        for (const std::string& tag : sensor.tags) {
+            if (tagIds.emplace(tag, tagList.size()).second) {
+                tagList.push_back(&tagIds.find(tag)->first);
+            }
+        }
+    }
+    if (tagList.size() > MAX_TAGS) {
+        ANDRTF3_LOG_E("Manifest: %u tags (max %u)", static_cast<unsigned>(tagList.size()),
+                      static_cast<unsigned>(MAX_TAGS));
+        return false;
+    }
+
+    // ---- Copy strings into one arena ----
+    size_t arenaBytes = 0;
+    for (const Parsed& sensor : sensors) {
+        arenaBytes += sensor.name.size() + 1;
+    }
+    for (const std::string* tag : tagList) {
+        arenaBytes += tag->size() + 1;
+    }
+    _arena = new char[arenaBytes > 0 ? arenaBytes : 1];
+    char* cursor = _arena;
+    std::vector<const char*> nameKeys(sensors.size());
+    std::vector<const char*> tagKeys(tagList.size());
+    for (size_t i = 0; i < sensors.size(); i++) {
+        memcpy(cursor, sensors[i].name.c_str(), sensors[i].name.size() + 1);
+        nameKeys[i] = cursor;
+        cursor += sensors[i].name.size() + 1;
+    }
+    for (size_t i = 0; i < tagList.size(); i++) {
+        memcpy(cursor, tagList[i]->c_str(), tagList[i]->size() + 1);
+        tagKeys[i] = cursor;
+        cursor += tagList[i]->size() + 1;
+    }
+
+    // ---- Hash and place ----
+    if (!_nameHash.build(nameKeys.data(), nameKeys.size()) ||
+        !_tagHash.build(tagKeys.data(), tagKeys.size())) {
+        clear();
+        return false;
+    }
+
+    _count = sensors.size();
+    _tagCount = tagList.size();
+    _words = (_count + 31) / 32;
+    _entries = new Entry[_count > 0 ? _count : 1];
+    _tagNames = new const char*[_tagCount > 0 ? _tagCount : 1];
+    _tagBits = new uint32_t[_tagCount * _words > 0 ? _tagCount * _words : 1]();
+
+    std::vector<size_t> tagSlot(_tagCount);
+    for (size_t t = 0; t < _tagCount; t++) {
+        tagSlot[t] = _tagHash.slot(tagKeys[t], strlen(tagKeys[t]));
+        _tagNames[tagSlot[t]] = tagKeys[t];
+    }
+
+    for (size_t i = 0; i < sensors.size(); i++) {
+        size_t s = _nameHash.slot(nameKeys[i], sensors[i].name.size());
+        _entries[s].name = nameKeys[i];
+        _entries[s].bus = sensors[i].bus;
+        _entries[s].address = sensors[i].address;
+        _entries[s].sensor = nullptr;
+        for (const std::string& tag : sensors[i].tags) {
+            size_t t = tagSlot[tagIds[tag]];
+            _tagBits[t * _words + s / 32] |= (1UL << (s % 32));
+        }
+    }
+
+    ANDRTF3_LOG_I("Directory: %u sensors, %u tags", static_cast<unsigned>(_count),
+                  static_cast<unsigned>(_tagCount));
+    return true;
+}
+
+int SensorDirectory::find(const char* name) const {
+    return (name != nullptr) ? find(name, strlen(name)) : -1;
+}
+
+int SensorDirectory::find(const char* name, size_t length) const {
+    if (_count == 0 || name == nullptr) {
+        return -1;
+    }
+    size_t s = _nameHash.slot(name, length);
+    const char* stored = _entries[s].name;
+    if (strncmp(stored, name, length) != 0 || stored[length] != '\0') {
+        return -1;
+    }
+    return static_cast<int>(s);
+}
+
+ANDRTF3* SensorDirectory::getSensor(const char* name) const {
+    int index = find(name);
+    return (index >= 0) ? _entries[index].sensor : nullptr;
+}
+
+bool SensorDirectory::bind(size_t index, ANDRTF3* sensor) {
+    if (index >= _count) {
+        return false;
+    }
+    _entries[index].sensor = sensor;
+    return true;
+}
+
+int SensorDirectory::findTag(const char* tag) const {
+    if (_tagCount == 0 || tag == nullptr) {
+        return -1;
+    }
+    size_t length = strlen(tag);
+    size_t s = _tagHash.slot(tag, length);
+    if (strcmp(_tagNames[s], tag) != 0) {
+        return -1;
+    }
+    return static_cast<int>(s);
+}
+
+const uint32_t* SensorDirectory::getTagBits(int tag) const {
+    if (tag < 0 || static_cast<size_t>(tag) >= _tagCount) {
+        return nullptr;
+    }
+    return &_tagBits[static_cast<size_t>(tag) * _words];
+}
+
+size_t SensorDirectory::select(const char* const* tags, size_t tagCount, uint32_t* out) const {
+    if (out == nullptr || _words == 0) {
+        return 0;
+    }
+    for (size_t w = 0; w < _words; w++) {
+        out[w] = 0xFFFFFFFFu;
+    }
+    // Mask off bits past the last sensor
+    if (_count % 32 != 0) {
+        out[_words - 1] = (1UL << (_count % 32)) - 1;
+    }
+
+    for (size_t i = 0; i < tagCount; i++) {
+        const uint32_t* bits = getTagBits(findTag(tags[i]));
+        if (bits == nullptr) {
+            memset(out, 0, _words * sizeof(uint32_t));
+            return 0;
+        }
+        for (size_t w = 0; w < _words; w++) {
+            out[w] &= bits[w];
+        }
+    }
+
+    size_t matches = 0;
+    for (size_t w = 0; w < _words; w++) {
+        matches += static_cast<size_t>(__builtin_popcount(out[w]));
+    }
+    return matches;
+}
+
+} // namespace andrtf3
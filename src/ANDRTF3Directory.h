@@ -0,0 +1,149 @@
+/*
+ * ANDRTF3Directory.h - part of the ESP32-ANDRTF3 library
+ *
+ * Copyright (C) 2025-2026 packerlschupfer
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+
+#ifndef ANDRTF3_DIRECTORY_H
+#define ANDRTF3_DIRECTORY_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+namespace andrtf3 {
+
+class ANDRTF3;
+
+/**
+ * Minimal perfect hash over a fixed key set (hash-and-displace)
+ *
+ * Keys are spread over buckets; each bucket stores the seed that sends all
+ * its keys to distinct free slots, so every key maps to its own slot in
+ * [0, size()). Lookups hash once, read one seed and hash again: constant
+ * time, no allocation. Keys outside the set also map to some slot, so the
+ * caller compares the stored key.
+ */
+class PerfectHash {
+public:
+    PerfectHash();
+    ~PerfectHash();
+
+    PerfectHash(const PerfectHash&) = delete;
+    PerfectHash& operator=(const PerfectHash&) = delete;
+
+    // Keys must be distinct; returns false if no seeds were found
+    bool build(const char* const* keys, size_t count);
+    void clear();
+
+    [[nodiscard]] size_t slot(const char* key, size_t length) const;
+    [[nodiscard]] size_t size() const noexcept { return _count; }
+
+    static uint64_t hashKey(const char* key, size_t length);
+
+private:
+    static size_t slotFor(uint64_t hash, uint16_t seed, uint32_t salt, size_t count);
+
+    uint16_t* _seeds;
+    size_t _buckets;
+    size_t _count;
+    uint32_t _salt;
+};
+
+/**
+ * Sensor directory built from the fleet manifest at startup
+ *
+ * Resolves configuration names such as "B2/3.14/north" to bus/address and
+ * the bound ANDRTF3 instance, and tags to bitsets over sensor indices for
+ * group queries ("all sensors on floor 3"). Loading allocates; lookups and
+ * queries do not and run in constant time (per tag for select()).
+ *
+ * Manifest: one sensor per line, '#' starts a comment.
+ * @code
+ * # name             [bus:]address   tags...
+ * B2/3.14/north      0:3             floor:3 office critical
+ * B2/3.15/south      0:4             floor:3 office
+ * @endcode
+ * With prefix tags enabled, every '/'-separated prefix of a name is also a
+ * tag ("B2", "B2/3.14").
+ */
+class SensorDirectory {
+public:
+    static constexpr size_t MAX_SENSORS = 4096;
+    static constexpr size_t MAX_TAGS = 8192;         // Bitsets take MAX_TAGS x sensors / 8 bytes at most
+
+    struct Entry {
+        const char* name;
+        uint16_t bus;
+        uint8_t address;
+        ANDRTF3* sensor;            // nullptr until bind()
+    };
+
+    SensorDirectory();
+    ~SensorDirectory();
+
+    SensorDirectory(const SensorDirectory&) = delete;
+    SensorDirectory& operator=(const SensorDirectory&) = delete;
+
+    /**
+     * @brief Parse a manifest and build the indexes (replaces any previous one)
+     * @return false on a syntax error or duplicate name (see getErrorLine())
+     */
+    bool load(const char* manifest, bool prefixTags = true);
+    void clear();
+
+    // Index of a sensor, or -1
+    [[nodiscard]] int find(const char* name) const;
+    [[nodiscard]] int find(const char* name, size_t length) const;
+
+    [[nodiscard]] const Entry& getEntry(size_t index) const { return _entries[index]; }
+    [[nodiscard]] ANDRTF3* getSensor(const char* name) const;
+    bool bind(size_t index, ANDRTF3* sensor);
+
+    // Tag id, or -1; getTagBits() has getBitsetWords() words, bit i = sensor i
+    [[nodiscard]] int findTag(const char* tag) const;
+    [[nodiscard]] const uint32_t* getTagBits(int tag) const;
+    [[nodiscard]] size_t getBitsetWords() const noexcept { return _words; }
+
+    /**
+     * @brief Sensors carrying every one of the given tags
+     * @param out getBitsetWords() words
+     * @return number of matching sensors (0 if any tag is unknown)
+     */
+    size_t select(const char* const* tags, size_t tagCount, uint32_t* out) const;
+
+    [[nodiscard]] size_t size() const noexcept { return _count; }
+    [[nodiscard]] size_t getTagCount() const noexcept { return _tagCount; }
+    [[nodiscard]] size_t getErrorLine() const noexcept { return _errorLine; }
+
+private:
+    char* _arena;                   // All names and tags, NUL-terminated
+    Entry* _entries;                // Indexed by name hash slot
+    size_t _count;
+    const char** _tagNames;         // Indexed by tag hash slot
+    uint32_t* _tagBits;             // _tagCount x _words
+    size_t _tagCount;
+    size_t _words;
+    PerfectHash _nameHash;
+    PerfectHash _tagHash;
+    size_t _errorLine;
+};
+
+} // namespace andrtf3
+
+#endif // ANDRTF3_DIRECTORY_H
@@ -0,0 +1,240 @@
+/*
+ * ANDRTF3Drift.cpp - part of the ESP32-ANDRTF3 library
+ *
+ * Copyright (C) 2025-2026 packerlschupfer
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+
+#include "ANDRTF3Drift.h"
+#include "ANDRTF3Logging.h"
+
+#include <string.h>
+
+namespace andrtf3 {
+
+namespace {
+
+// Run length at which the offset estimate's average is halved, so the
+// estimate covers the last 16-32 departures and follows a ramp
+constexpr uint16_t MAX_RUN = 32;
+
+int32_t divRound(int32_t value, int32_t divisor) {
+    return (value >= 0) ? (value + divisor / 2) / divisor : -((-value + divisor / 2) / divisor);
+}
+
+int16_t toDeci(int32_t q4) {
+    int32_t deci = divRound(q4, 16);
+    if (deci > INT16_MAX) {
+        return INT16_MAX;
+    }
+    return static_cast<int16_t>((deci < INT16_MIN) ? INT16_MIN : deci);
+}
+
+// One side of the CUSUM; returns the updated sum and tracks the run behind it
+void accumulate(int32_t& cusum, int32_t& runSum, uint16_t& run, int32_t departure, int32_t allowance,
+                int32_t limit) {
+    int32_t next = cusum + departure - allowance;
+    if (next <= 0) {
+        cusum = 0;
+        runSum = 0;
+        run = 0;
+        return;
+    }
+    // Clamped so a sensor that recovers clears in bounded time
+    cusum = (next < 2 * limit) ? next : 2 * limit;
+    runSum += departure;
+    if (++run >= MAX_RUN) {
+        runSum /= 2;
+        run /= 2;
+    }
+}
+
+} // namespace
+
+DriftDetector::DriftDetector()
+    : DriftDetector(getDefaultConfig()) {
+}
+
+DriftDetector::DriftDetector(const Config& config)
+    : _config(config),
+      _entries{},
+      _zones{},
+      _callback(nullptr),
+      _callbackContext(nullptr),
+      _alarms(0) {
+    if (_config.minPeers == 0) {
+        _config.minPeers = 1;
+    }
+    if (_config.thresholdDeci == 0) {
+        _config.thresholdDeci = 1;
+    }
+    reset();
+}
+
+DriftDetector::Config DriftDetector::getDefaultConfig() {
+    return {
+        2,                        // envelopeDeci (±0.2 K)
+        10,                       // envelopePermille (±1% of reading)
+        60,                       // learnSamples (5 minutes at 5 s polling)
+        2,                        // minPeers
+        40                        // thresholdDeci (e.g. 1 K beyond the envelope for 4 readings)
+    };
+}
+
+void DriftDetector::reset() {
+    memset(_entries, 0, sizeof(_entries));
+    memset(_zones, 0, sizeof(_zones));
+    _alarms = 0;
+}
+
+void DriftDetector::contribute(Entry& entry, bool on) {
+    if (entry.contributing == on || !entry.placed) {
+        return;
+    }
+    Zone& zone = _zones[entry.zone];
+    if (on) {
+        zone.sum += entry.value;
+        zone.members++;
+    } else {
+        zone.sum -= entry.value;
+        zone.members--;
+    }
+    entry.contributing = on;
+}
+
+void DriftDetector::leaveZone(Entry& entry) {
+    contribute(entry, false);
+    memset(&entry, 0, sizeof(entry));
+}
+
+void DriftDetector::setDrifting(size_t slot, Entry& entry, bool drifting) {
+    entry.drifting = drifting;
+    // A drifting sensor must not pull the reference its peers are judged by
+    contribute(entry, !drifting && entry.current);
+    if (drifting) {
+        _alarms++;
+        ANDRTF3_LOG_W("Drift: slot %d in zone %d is %d deci-degrees off its peers",
+                      static_cast<int>(slot), entry.zone, entry.offsetDeci);
+    } else {
+        entry.offsetDeci = 0;
+        ANDRTF3_LOG_I("Drift: slot %d back within its envelope", static_cast<int>(slot));
+    }
+    if (_callback != nullptr) {
+        _callback(slot, drifting, entry.offsetDeci, _callbackContext);
+    }
+}
+
+bool DriftDetector::update(size_t slot, uint8_t zone, int16_t celsius) {
+    if (slot >= MAX_SLOTS || zone >= MAX_ZONES) {
+        return false;
+    }
+    Entry& e = _entries[slot];
+    if (e.placed && e.zone != zone) {
+        leaveZone(e);               // New surroundings: relearn the baseline
+    }
+    if (!e.placed) {
+        e.zone = zone;
+        e.placed = true;
+    }
+
+    Zone& z = _zones[zone];
+    if (e.contributing) {
+        z.sum += celsius - e.value;
+    }
+    e.value = celsius;
+    e.current = true;
+    if (!e.drifting) {
+        contribute(e, true);
+    }
+
+    int32_t peers = z.members - (e.contributing ? 1 : 0);
+    if (peers < _config.minPeers) {
+        return e.drifting;
+    }
+    int32_t peerSum = z.sum - (e.contributing ? celsius : 0);
+    int32_t residualQ4 = celsius * Q - (peerSum * Q) / peers;
+
+    if (e.samples < 0xFFFFFFFFu) {
+        e.samples++;
+    }
+    if (e.samples <= _config.learnSamples) {
+        e.baselineSumQ4 += residualQ4;
+        return false;
+    }
+
+    int32_t baselineQ4 = (_config.learnSamples > 0) ? e.baselineSumQ4 / _config.learnSamples : 0;
+    int32_t departure = residualQ4 - baselineQ4;
+    int32_t magnitude = (celsius < 0) ? -celsius : celsius;
+    int32_t allowance = _config.envelopeDeci * Q + (magnitude * _config.envelopePermille * Q) / 1000;
+    int32_t limit = static_cast<int32_t>(_config.thresholdDeci) * Q;
+
+    accumulate(e.cusumHighQ4, e.highSumQ4, e.highRun, departure, allowance, limit);
+    accumulate(e.cusumLowQ4, e.lowSumQ4, e.lowRun, -departure, allowance, limit);
+
+    // Offset estimate: mean departure over the run behind the larger side
+    if (e.cusumHighQ4 >= e.cusumLowQ4 && e.highRun > 0) {
+        e.offsetDeci = toDeci(e.highSumQ4 / e.highRun);
+    } else if (e.lowRun > 0) {
+        e.offsetDeci = toDeci(-(e.lowSumQ4 / e.lowRun));
+    }
+
+    if (!e.drifting && (e.cusumHighQ4 > limit || e.cusumLowQ4 > limit)) {
+        setDrifting(slot, e, true);
+    } else if (e.drifting && e.cusumHighQ4 == 0 && e.cusumLowQ4 == 0) {
+        setDrifting(slot, e, false);
+    }
+    return e.drifting;
+}
+
+void DriftDetector::invalidate(size_t slot) {
+    if (slot >= MAX_SLOTS) {
+        return;
+    }
+    Entry& e = _entries[slot];
+    contribute(e, false);
+    e.current = false;
+}
+
+bool DriftDetector::isDrifting(size_t slot) const {
+    return (slot < MAX_SLOTS) && _entries[slot].drifting;
+}
+
+int16_t DriftDetector::getOffset(size_t slot) const {
+    return isDrifting(slot) ? _entries[slot].offsetDeci : 0;
+}
+
+DriftDetector::Status DriftDetector::getStatus(size_t slot) const {
+    Status status = {};
+    if (slot >= MAX_SLOTS) {
+        return status;
+    }
+    const Entry& e = _entries[slot];
+    bool learned = _config.learnSamples > 0 && e.samples >= _config.learnSamples;
+    uint32_t learnedSamples = learned ? _config.learnSamples : e.samples;
+    status.baselineDeci = (learnedSamples > 0)
+        ? toDeci(e.baselineSumQ4 / static_cast<int32_t>(learnedSamples)) : 0;
+    status.offsetDeci = e.drifting ? e.offsetDeci : 0;
+    status.cusumHigh = divRound(e.cusumHighQ4, Q);
+    status.cusumLow = divRound(e.cusumLowQ4, Q);
+    status.samples = e.samples;
+    status.learning = e.samples < _config.learnSamples;
+    status.drifting = e.drifting;
+    return status;
+}
+
+} // namespace andrtf3
@@ -0,0 +1,149 @@
+/*
+ * ANDRTF3Drift.h - part of the ESP32-ANDRTF3 library
+ *
+ * Copyright (C) 2025-2026 packerlschupfer
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+
+#ifndef ANDRTF3_DRIFT_H
+#define ANDRTF3_DRIFT_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+namespace andrtf3 {
+
+// Called when a slot starts or stops drifting; offsetDeci is the estimated offset
+typedef void (*DriftCallback)(size_t slot, bool drifting, int16_t offsetDeci, void* context);
+
+/**
+ * Peer-relative calibration drift detector
+ *
+ * Compares each sensor with the mean of the other sensors in its zone and
+ * runs a two-sided CUSUM on the difference. A slowly drifting sensor passes
+ * every range check, but its distance from its peers keeps growing.
+ *
+ * Sensors in one zone rarely read the same (a sensor near a window reads
+ * lower), so the first learnSamples residuals of each sensor set its
+ * baseline offset, and only departures from that baseline count. Each
+ * sample's allowance is the sensor's accuracy envelope (±0.2 K ±1% of the
+ * reading by default), so the CUSUM only grows on offsets beyond the
+ * envelope. The offset estimate is the mean of the recent departures on the
+ * alarm side of the CUSUM.
+ *
+ * Each zone keeps a running sum of its members' latest readings, so an
+ * update is O(1) regardless of zone size. A drifting sensor leaves the sum,
+ * so it does not pull its peers' reference. Not thread-safe: feed it from
+ * the bus task (ANDRTF3Poller::setDriftDetector()).
+ *
+ * Slots are indexed like ANDRTF3Poller / GapTuner slots.
+ */
+class DriftDetector {
+public:
+    static constexpr size_t MAX_SLOTS = 64;
+    static constexpr size_t MAX_ZONES = 32;
+
+    struct Config {
+        int16_t envelopeDeci;       // Fixed part of the accuracy envelope (default: 2 = 0.2 K)
+        uint16_t envelopePermille;  // Proportional part, of |reading| (default: 10 = 1%)
+        uint16_t learnSamples;      // Residuals averaged into the baseline (0 = peers read alike)
+        uint8_t minPeers;           // Contributing peers needed to evaluate (at least 1)
+        uint16_t thresholdDeci;     // CUSUM alarm level, deci-degree samples beyond the envelope
+    };
+
+    struct Status {
+        int16_t baselineDeci;       // Learned offset from the peer mean
+        int16_t offsetDeci;         // Estimated drift beyond the baseline (0 unless drifting)
+        int32_t cusumHigh;          // Deci-degree samples above the envelope
+        int32_t cusumLow;           // Deci-degree samples below the envelope
+        uint32_t samples;           // Evaluated readings
+        bool learning;
+        bool drifting;
+    };
+
+    DriftDetector();
+    explicit DriftDetector(const Config& config);
+
+    static Config getDefaultConfig();
+
+    void reset();
+
+    void setCallback(DriftCallback callback, void* context) {
+        _callback = callback;
+        _callbackContext = context;
+    }
+
+    /**
+     * @brief Feed one valid reading of a slot
+     *
+     * The first update places the slot in zone; a different zone moves it.
+     *
+     * @return true if the slot is flagged as drifting
+     */
+    bool update(size_t slot, uint8_t zone, int16_t celsius);
+
+    // Slot has no current reading (read failed, sensor removed); O(1)
+    void invalidate(size_t slot);
+
+    [[nodiscard]] bool isDrifting(size_t slot) const;
+    [[nodiscard]] int16_t getOffset(size_t slot) const;
+    [[nodiscard]] Status getStatus(size_t slot) const;
+    [[nodiscard]] uint32_t getAlarmCount() const noexcept { return _alarms; }
+
+private:
+    // Residuals are kept in Q4 deci-degrees so the baseline and mean keep sub-LSB precision
+    static constexpr int32_t Q = 16;
+
+    struct Entry {
+        int32_t baselineSumQ4;      // Sum of learning residuals
+        int32_t highSumQ4;          // Departures since cusumHigh left zero
+        int32_t lowSumQ4;
+        int32_t cusumHighQ4;
+        int32_t cusumLowQ4;
+        uint32_t samples;
+        uint16_t highRun;
+        uint16_t lowRun;
+        int16_t value;              // Latest reading
+        int16_t offsetDeci;
+        uint8_t zone;
+        bool placed;                // Zone assigned
+        bool current;               // Has a reading
+        bool contributing;          // Reading is part of the zone sum
+        bool drifting;
+    };
+
+    struct Zone {
+        int32_t sum;                // Contributing members' latest readings
+        uint16_t members;           // Contributing members
+    };
+
+    void contribute(Entry& entry, bool on);
+    void leaveZone(Entry& entry);
+    void setDrifting(size_t slot, Entry& entry, bool drifting);
+
+    Config _config;
+    Entry _entries[MAX_SLOTS];
+    Zone _zones[MAX_ZONES];
+    DriftCallback _callback;
+    void* _callbackContext;
+    uint32_t _alarms;
+};
+
+} // namespace andrtf3
+
+#endif // ANDRTF3_DRIFT_H
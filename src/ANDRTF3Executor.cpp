@@ -0,0 +1,273 @@
+/*
+ * ANDRTF3Executor.cpp - part of the ESP32-ANDRTF3 library
+ *
+ * Copyright (C) 2025-2026 packerlschupfer
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+
+#include "ANDRTF3Executor.h"
+#include "ANDRTF3Logging.h"
+
+#if defined(__linux__)
+
+namespace andrtf3 {
+
+namespace {
+
+uint16_t shardOf(const GatewayReading& reading, uint16_t shards) {
+    // Fibonacci hash of (bus, address): neighbouring addresses spread out
+    uint32_t key = (static_cast<uint32_t>(reading.bus) << 8) | reading.address;
+    return static_cast<uint16_t>(((key * 2654435761u) >> 8) % shards);
+}
+
+} // namespace
+
+StageExecutor::StageExecutor()
+    : StageExecutor(getDefaultConfig()) {
+}
+
+StageExecutor::StageExecutor(const Config& config)
+    : _config(config),
+      _stages{},
+      _stageContexts{},
+      _stageCount(0),
+      _runnable(0),
+      _inFlight(0),
+      _running(false),
+      _stopping(false),
+      _submitted(0),
+      _executed(0),
+      _dropped(0),
+      _steals(0) {
+    if (_config.workers == 0) {
+        _config.workers = 1;
+    }
+    if (_config.shards == 0) {
+        _config.shards = 1;
+    }
+    if (_config.batch == 0) {
+        _config.batch = 1;
+    }
+}
+
+StageExecutor::~StageExecutor() {
+    stop();
+}
+
+StageExecutor::Config StageExecutor::getDefaultConfig() {
+    unsigned cores = std::thread::hardware_concurrency();
+    return {
+        static_cast<uint8_t>((cores == 0) ? 1 : (cores > 255 ? 255 : cores)),  // workers
+        256,      // shards
+        256,      // mailboxDepth
+        32        // batch
+    };
+}
+
+bool StageExecutor::addStage(ReadingStage stage, void* context) {
+    if (_running.load() || stage == nullptr || _stageCount >= MAX_STAGES) {
+        return false;
+    }
+    _stages[_stageCount] = stage;
+    _stageContexts[_stageCount] = context;
+    _stageCount++;
+    return true;
+}
+
+bool StageExecutor::start() {
+    if (_running.load()) {
+        return true;
+    }
+
+    _mailboxes.reset(new Mailbox[_config.shards]);
+    _workers.clear();
+    for (uint8_t i = 0; i < _config.workers; i++) {
+        _workers.emplace_back(new Worker());
+    }
+    _stopping.store(false);
+    _running.store(true);
+    for (size_t i = 0; i < _workers.size(); i++) {
+        _workers[i]->thread = std::thread(&StageExecutor::run, this, i);
+    }
+    ANDRTF3_LOG_D("StageExecutor: %u workers, %u shards, %u stages",
+                  _config.workers, _config.shards, static_cast<unsigned>(_stageCount));
+    return true;
+}
+
+void StageExecutor::stop() {
+    if (!_running.exchange(false)) {
+        return;
+    }
+    drain();
+    {
+        std::lock_guard<std::mutex> lock(_idleMutex);
+        _stopping.store(true);
+    }
+    _idle.notify_all();
+    for (auto& worker : _workers) {
+        worker->thread.join();
+    }
+}
+
+bool StageExecutor::submit(const GatewayReading& reading) {
+    if (!_running.load()) {
+        return false;
+    }
+
+    uint16_t shard = shardOf(reading, _config.shards);
+    Mailbox& mailbox = _mailboxes[shard];
+    bool wake = false;
+    {
+        std::lock_guard<std::mutex> lock(mailbox.mutex);
+        if (mailbox.pending.size() >= _config.mailboxDepth) {
+            _dropped++;
+            return false;
+        }
+        mailbox.pending.push_back(reading);
+        _inFlight++;
+        if (!mailbox.scheduled) {
+            mailbox.scheduled = true;
+            wake = true;
+        }
+    }
+    _submitted++;
+
+    if (wake) {
+        schedule(shard % _workers.size(), shard, false);
+    }
+    return true;
+}
+
+void StageExecutor::submitSink(const GatewayReading& reading, void* context) {
+    static_cast<StageExecutor*>(context)->submit(reading);
+}
+
+void StageExecutor::drain() {
+    std::unique_lock<std::mutex> lock(_idleMutex);
+    _drained.wait(lock, [this] { return _inFlight.load() == 0; });
+}
+
+StageExecutor::Stats StageExecutor::getStats() const {
+    Stats stats;
+    stats.submitted = _submitted.load();
+    stats.executed = _executed.load();
+    stats.dropped = _dropped.load();
+    stats.steals = _steals.load();
+    return stats;
+}
+
+void StageExecutor::schedule(size_t worker, uint16_t shard, bool front) {
+    {
+        std::lock_guard<std::mutex> lock(_workers[worker]->mutex);
+        if (front) {
+            _workers[worker]->runnable.push_front(shard);
+        } else {
+            _workers[worker]->runnable.push_back(shard);
+        }
+        _runnable++;
+    }
+    {
+        std::lock_guard<std::mutex> lock(_idleMutex);
+    }
+    _idle.notify_one();
+}
+
+bool StageExecutor::takeWork(size_t self, uint16_t& shard) {
+    {
+        Worker& own = *_workers[self];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.runnable.empty()) {
+            shard = own.runnable.back();
+            own.runnable.pop_back();
+            _runnable--;
+            return true;
+        }
+    }
+
+    // Steal the oldest mailbox of the next busy worker
+    for (size_t i = 1; i < _workers.size(); i++) {
+        Worker& victim = *_workers[(self + i) % _workers.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.runnable.empty()) {
+            shard = victim.runnable.front();
+            victim.runnable.pop_front();
+            _runnable--;
+            _steals++;
+            return true;
+        }
+    }
+    return false;
+}
+
+void StageExecutor::run(size_t self) {
+    std::vector<GatewayReading> batch;
+    batch.reserve(_config.batch);
+
+    for (;;) {
+        uint16_t shard;
+        if (takeWork(self, shard)) {
+            runMailbox(shard, batch);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(_idleMutex);
+        _idle.wait(lock, [this] { return _runnable.load() > 0 || _stopping.load(); });
+        if (_stopping.load() && _runnable.load() == 0) {
+            break;
+        }
+    }
+}
+
+void StageExecutor::runMailbox(uint16_t shard, std::vector<GatewayReading>& batch) {
+    Mailbox& mailbox = _mailboxes[shard];
+    {
+        std::lock_guard<std::mutex> lock(mailbox.mutex);
+        size_t n = mailbox.pending.size() < _config.batch ? mailbox.pending.size() : _config.batch;
+        batch.assign(mailbox.pending.begin(), mailbox.pending.begin() + static_cast<long>(n));
+        mailbox.pending.erase(mailbox.pending.begin(), mailbox.pending.begin() + static_cast<long>(n));
+    }
+
+    for (const GatewayReading& reading : batch) {
+        for (size_t s = 0; s < _stageCount; s++) {
+            _stages[s](reading, _stageContexts[s]);
+        }
+    }
+    _executed += batch.size();
+
+    bool more;
+    {
+        std::lock_guard<std::mutex> lock(mailbox.mutex);
+        more = !mailbox.pending.empty();
+        if (!more) {
+            mailbox.scheduled = false;
+        }
+    }
+    if (more) {
+        // Oldest end of the home deque: its other mailboxes go first, thieves may take it
+        schedule(shard % _workers.size(), shard, true);
+    }
+
+    if (_inFlight.fetch_sub(batch.size()) == batch.size()) {
+        std::lock_guard<std::mutex> lock(_idleMutex);
+        _drained.notify_all();
+    }
+}
+
+} // namespace andrtf3
+
+#endif // __linux__
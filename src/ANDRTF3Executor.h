@@ -0,0 +1,156 @@
+/*
+ * ANDRTF3Executor.h - part of the ESP32-ANDRTF3 library
+ *
+ * Copyright (C) 2025-2026 packerlschupfer
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+
+#ifndef ANDRTF3_EXECUTOR_H
+#define ANDRTF3_EXECUTOR_H
+
+#include "ANDRTF3Gateway.h"
+
+#if defined(__linux__)
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace andrtf3 {
+
+// One post-publish stage (filter, statistics, rollup, compression, alarms...)
+typedef void (*ReadingStage)(const GatewayReading& reading, void* context);
+
+/**
+ * Work-stealing executor for post-processing stages (Linux)
+ *
+ * Readings are sharded by (bus, address) into mailboxes. A mailbox with
+ * pending readings is scheduled as one unit on its home worker's deque;
+ * idle workers steal whole mailboxes from the other end of busy workers'
+ * deques. A mailbox is only ever run by one worker at a time, so every
+ * stage sees the readings of one sensor in submission order, while load
+ * still spreads across cores.
+ *
+ * Stages run in the order they were added. Different sensors are
+ * processed concurrently, so stage state must be kept per sensor (or be
+ * thread-safe).
+ *
+ * Plugs in behind Gateway:
+ * @code
+ * StageExecutor post;
+ * post.addStage(updateRollup, &rollups);
+ * post.addStage(evaluateAlarms, &alarms);
+ * post.start();
+ * gateway.setSink(StageExecutor::submitSink, &post);
+ * @endcode
+ */
+class StageExecutor {
+public:
+    static constexpr size_t MAX_STAGES = 8;
+
+    struct Config {
+        uint8_t workers;            // Threads (default: hardware concurrency)
+        uint16_t shards;            // Mailboxes (default: 256)
+        uint16_t mailboxDepth;      // Pending readings per mailbox before dropping (default: 256)
+        uint16_t batch;             // Readings run per turn before yielding the worker (default: 32)
+    };
+
+    struct Stats {
+        uint64_t submitted;
+        uint64_t executed;          // Readings that went through every stage
+        uint64_t dropped;           // Mailbox full
+        uint64_t steals;            // Mailboxes taken from another worker
+    };
+
+    StageExecutor();
+    explicit StageExecutor(const Config& config);
+    ~StageExecutor();
+
+    StageExecutor(const StageExecutor&) = delete;
+    StageExecutor& operator=(const StageExecutor&) = delete;
+
+    static Config getDefaultConfig();
+
+    // Call before start()
+    bool addStage(ReadingStage stage, void* context);
+
+    bool start();
+    // Finish everything submitted so far, then join the workers (stop producers first)
+    void stop();
+
+    // Thread-safe; false if the reading's mailbox is full or not running
+    bool submit(const GatewayReading& reading);
+
+    // GatewayReadingSink adapter; context is the executor
+    static void submitSink(const GatewayReading& reading, void* context);
+
+    // Block until every submitted reading has been executed
+    void drain();
+
+    [[nodiscard]] Stats getStats() const;
+    [[nodiscard]] size_t getWorkerCount() const noexcept { return _workers.size(); }
+
+private:
+    struct Mailbox {
+        std::mutex mutex;
+        std::deque<GatewayReading> pending;
+        bool scheduled = false;     // On some worker's deque or running
+    };
+
+    struct Worker {
+        std::mutex mutex;
+        std::deque<uint16_t> runnable;   // Owner pops back, thieves take front
+        std::thread thread;
+    };
+
+    void run(size_t self);
+    bool takeWork(size_t self, uint16_t& shard);
+    void schedule(size_t worker, uint16_t shard, bool front);
+    void runMailbox(uint16_t shard, std::vector<GatewayReading>& batch);
+
+    Config _config;
+    ReadingStage _stages[MAX_STAGES];
+    void* _stageContexts[MAX_STAGES];
+    size_t _stageCount;
+
+    std::unique_ptr<Mailbox[]> _mailboxes;
+    std::vector<std::unique_ptr<Worker>> _workers;
+
+    std::mutex _idleMutex;
+    std::condition_variable _idle;
+    std::condition_variable _drained;
+    std::atomic<uint32_t> _runnable;     // Mailboxes queued on deques
+    std::atomic<uint64_t> _inFlight;     // Submitted, not yet executed
+    std::atomic<bool> _running;
+    std::atomic<bool> _stopping;
+
+    std::atomic<uint64_t> _submitted;
+    std::atomic<uint64_t> _executed;
+    std::atomic<uint64_t> _dropped;
+    std::atomic<uint64_t> _steals;
+};
+
+} // namespace andrtf3
+
+#endif // __linux__
+
+#endif // ANDRTF3_EXECUTOR_H
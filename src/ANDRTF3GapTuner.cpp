@@ -0,0 +1,166 @@
+/*
+ * ANDRTF3GapTuner.cpp - part of the ESP32-ANDRTF3 library
+ *
+ * Copyright (C) 2025-2026 packerlschupfer
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "ANDRTF3GapTuner.h"
+
+namespace andrtf3 {
+
+GapTuner::GapTuner()
+    : GapTuner(getDefaultConfig()) {
+}
+
+GapTuner::GapTuner(const Config& config)
+    : _config(config),
+      _entries{},
+      _fallbacks(0) {
+    if (_config.windowReads == 0) {
+        _config.windowReads = 1;
+    }
+    if (_config.floorGapMs > _config.startGapMs) {
+        _config.floorGapMs = _config.startGapMs;
+    }
+    reset();
+}
+
+GapTuner::Config GapTuner::getDefaultConfig(uint32_t baudRate) {
+    return {
+        50,                       // startGapMs (documented bus settle time)
+        frameGapMs(baudRate),     // floorGapMs
+        2,                        // stepMs (minimum shrink per clean window)
+        50,                       // marginPercent
+        16,                       // windowReads
+        70,                       // maxErrorPermille (1 error in a 16-read window is tolerated)
+        100,                      // reprobeWindows
+        200                       // maxTimeoutMs (library default timeout)
+    };
+}
+
+uint16_t GapTuner::frameGapMs(uint32_t baudRate) {
+    if (baudRate == 0) {
+        return 0;
+    }
+    // Modbus spec fixes the interval at 1.75ms above 19200 baud
+    if (baudRate > 19200) {
+        return 2;
+    }
+    // 3.5 characters * 11 bits, in microseconds, rounded up to whole ms
+    uint32_t us = (35u * 11u * 100000u) / baudRate;
+    return static_cast<uint16_t>((us + 999u) / 1000u);
+}
+
+void GapTuner::reset() {
+    for (size_t i = 0; i < MAX_SLOTS; i++) {
+        Entry& e = _entries[i];
+        e.gapMs = _config.startGapMs;
+        e.lastGoodGapMs = _config.startGapMs;
+        e.maxRttMs = 0;
+        e.cleanWindows = 0;
+        e.reads = 0;
+        e.errors = 0;
+        e.state = State::PROBING;
+    }
+    _fallbacks = 0;
+}
+
+uint16_t GapTuner::getGapMs(size_t slot) const {
+    return (slot < MAX_SLOTS) ? _entries[slot].gapMs : _config.startGapMs;
+}
+
+uint16_t GapTuner::getRecommendedTimeoutMs(size_t slot) const {
+    if (slot >= MAX_SLOTS || _entries[slot].maxRttMs == 0) {
+        return _config.maxTimeoutMs;
+    }
+    uint32_t timeout = _entries[slot].maxRttMs * (100u + _config.marginPercent) / 100u;
+    return static_cast<uint16_t>((timeout < _config.maxTimeoutMs) ? timeout : _config.maxTimeoutMs);
+}
+
+GapTuner::State GapTuner::getState(size_t slot) const {
+    return (slot < MAX_SLOTS) ? _entries[slot].state : State::PROBING;
+}
+
+void GapTuner::onResult(size_t slot, bool success, uint32_t rttMs) {
+    if (slot >= MAX_SLOTS) {
+        return;
+    }
+    Entry& e = _entries[slot];
+
+    uint16_t rtt = static_cast<uint16_t>(rttMs > 0xFFFF ? 0xFFFF : rttMs);
+    if (success) {
+        // Decaying maximum: follows slow drifts down, jumps up immediately
+        e.maxRttMs = (rtt > e.maxRttMs) ? rtt : static_cast<uint16_t>(e.maxRttMs - e.maxRttMs / 64);
+    } else {
+        e.errors++;
+        // Ran into the timeout: the turnaround may have outgrown it, so widen
+        // it by the margin per timeout (up to maxTimeoutMs) until reads succeed
+        uint16_t timeout = getRecommendedTimeoutMs(slot);
+        if (e.maxRttMs != 0 && rtt >= timeout) {
+            e.maxRttMs = timeout;
+        }
+    }
+
+    if (++e.reads >= _config.windowReads) {
+        closeWindow(e);
+    }
+}
+
+void GapTuner::closeWindow(Entry& e) {
+    uint32_t errorPermille = (static_cast<uint32_t>(e.errors) * 1000u) / e.reads;
+    e.reads = 0;
+    e.errors = 0;
+
+    if (errorPermille > _config.maxErrorPermille) {
+        // Errors rose: back to the last clean gap plus margin and hold it.
+        // Repeated failures while locked keep widening up to the start gap.
+        uint32_t base = (e.state == State::LOCKED) ? e.gapMs : e.lastGoodGapMs;
+        uint32_t gap = base * (100u + _config.marginPercent) / 100u;
+        if (gap <= base) {
+            gap = base + 1;
+        }
+        e.gapMs = static_cast<uint16_t>((gap < _config.startGapMs) ? gap : _config.startGapMs);
+        e.lastGoodGapMs = e.gapMs;
+        e.state = State::LOCKED;
+        e.cleanWindows = 0;
+        _fallbacks++;
+        return;
+    }
+
+    e.lastGoodGapMs = e.gapMs;
+
+    if (e.state == State::LOCKED) {
+        if (++e.cleanWindows < _config.reprobeWindows) {
+            return;
+        }
+        e.state = State::PROBING;
+        e.cleanWindows = 0;
+    }
+
+    // Close a quarter of the distance to the floor, at least stepMs
+    if (e.gapMs > _config.floorGapMs) {
+        uint16_t step = static_cast<uint16_t>((e.gapMs - _config.floorGapMs) / 4);
+        if (step < _config.stepMs) {
+            step = _config.stepMs;
+        }
+        e.gapMs = (e.gapMs > _config.floorGapMs + step)
+                  ? static_cast<uint16_t>(e.gapMs - step) : _config.floorGapMs;
+    }
+}
+
+} // namespace andrtf3
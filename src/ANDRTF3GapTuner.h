@@ -0,0 +1,105 @@
+/*
+ * ANDRTF3GapTuner.h - part of the ESP32-ANDRTF3 library
+ *
+ * Copyright (C) 2025-2026 packerlschupfer
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#ifndef ANDRTF3_GAP_TUNER_H
+#define ANDRTF3_GAP_TUNER_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+namespace andrtf3 {
+
+/**
+ * Inter-frame gap and turnaround auto-tuner
+ *
+ * Starts every sensor at the conservative 50ms bus settle time and shrinks
+ * the idle gap before its transactions by a quarter of the remaining distance
+ * per clean window of reads, never below the Modbus 3.5-character minimum. When a window's error rate
+ * exceeds the threshold the gap falls back to the last clean value plus a
+ * safety margin and is held there; verification continues on every window,
+ * and after a long clean stretch probing resumes.
+ *
+ * Response times are tracked as a slowly decaying maximum to recommend a
+ * per-sensor timeout (maximum turnaround plus the same margin). A read that
+ * runs into that timeout widens it by the margin, up to maxTimeoutMs.
+ *
+ * Slots are indexed like ANDRTF3Poller / BusSimulator slots.
+ */
+class GapTuner {
+public:
+    static constexpr size_t MAX_SLOTS = 64;
+
+    struct Config {
+        uint16_t startGapMs;        // Conservative starting gap (default: 50)
+        uint16_t floorGapMs;        // Never go below (default: 3.5 chars)
+        uint16_t stepMs;            // Minimum shrink per clean window
+        uint8_t marginPercent;      // Safety margin on fallback and timeout
+        uint8_t windowReads;        // Reads per verification window
+        uint16_t maxErrorPermille;  // Window error rate that counts as "errors rose"
+        uint16_t reprobeWindows;    // Clean windows in LOCKED before probing again
+        uint16_t maxTimeoutMs;      // Upper bound for recommended timeouts
+    };
+
+    enum class State : uint8_t {
+        PROBING,                    // Shrinking the gap
+        LOCKED                      // Holding a verified gap
+    };
+
+    GapTuner();
+    explicit GapTuner(const Config& config);
+
+    static Config getDefaultConfig(uint32_t baudRate = 9600);
+
+    // Modbus RTU 3.5-character silent interval (11-bit characters), rounded up
+    static uint16_t frameGapMs(uint32_t baudRate);
+
+    void reset();
+
+    // Bus idle time to leave before a transaction to this slot
+    [[nodiscard]] uint16_t getGapMs(size_t slot) const;
+    [[nodiscard]] uint16_t getRecommendedTimeoutMs(size_t slot) const;
+    [[nodiscard]] State getState(size_t slot) const;
+    [[nodiscard]] uint32_t getFallbackCount() const noexcept { return _fallbacks; }
+
+    // Report the outcome of a transaction that used getGapMs(slot)
+    void onResult(size_t slot, bool success, uint32_t rttMs);
+
+private:
+    struct Entry {
+        uint16_t gapMs;
+        uint16_t lastGoodGapMs;
+        uint16_t maxRttMs;          // Decaying maximum of successful RTTs
+        uint16_t cleanWindows;
+        uint8_t reads;
+        uint8_t errors;
+        State state;
+    };
+
+    void closeWindow(Entry& entry);
+
+    Config _config;
+    Entry _entries[MAX_SLOTS];
+    uint32_t _fallbacks;
+};
+
+} // namespace andrtf3
+
+#endif // ANDRTF3_GAP_TUNER_H
@@ -0,0 +1,710 @@
+/*
+ * ANDRTF3Gateway.cpp - part of the ESP32-ANDRTF3 library
+ *
+ * Copyright (C) 2025-2026 packerlschupfer
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+
+#include "ANDRTF3Gateway.h"
+#include "ANDRTF3.h"
+#include "ANDRTF3GapTuner.h"
+#include "ANDRTF3Logging.h"
+
+#if defined(__linux__)
+
+#include <condition_variable>
+#include <mutex>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+namespace andrtf3 {
+
+namespace {
+
+uint64_t monotonicUs() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000ULL + static_cast<uint64_t>(ts.tv_nsec) / 1000ULL;
+}
+
+uint32_t monotonicMs() {
+    return static_cast<uint32_t>(monotonicUs() / 1000ULL);
+}
+
+uint64_t threadCpuUs() {
+    struct timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000ULL + static_cast<uint64_t>(ts.tv_nsec) / 1000ULL;
+}
+
+bool baudToSpeed(uint32_t baudRate, speed_t& speed) {
+    switch (baudRate) {
+        case 1200:   speed = B1200;   return true;
+        case 2400:   speed = B2400;   return true;
+        case 4800:   speed = B4800;   return true;
+        case 9600:   speed = B9600;   return true;
+        case 19200:  speed = B19200;  return true;
+        case 38400:  speed = B38400;  return true;
+        case 57600:  speed = B57600;  return true;
+        case 115200: speed = B115200; return true;
+        default:     return false;
+    }
+}
+
+} // namespace
+
+// ========== Bus ==========
+
+struct Gateway::Bus {
+    enum class State : uint8_t {
+        CLOSED,                     // Waiting for readyMs to (re)open
+        CONNECTING,                 // TCP connect in progress
+        IDLE,                       // Connected, no transaction
+        WAITING                     // Request sent, framing the response
+    };
+
+    uint16_t id;
+    bool serial;
+    char endpoint[64];              // Host (for logs) or device path
+    struct sockaddr_storage address;
+    socklen_t addressLength;
+    uint32_t baudRate;
+    uint16_t gapMs;
+
+    int fd = -1;                    // Only start() opens; ~Gateway closes what is >= 0
+    State state;
+    bool everOpened;
+    uint32_t readyMs;               // CLOSED: reopen at; IDLE: gap ends at
+    uint32_t deadlineMs;            // CONNECTING / WAITING timeout
+    uint32_t wakeMs;                // Earliest nextDueMs of the slots
+    uint64_t sentUs;
+    int current;                    // Slot awaiting a response
+
+    SchedulePolicy* policy;
+    RoundRobinPolicy ownPolicy;
+    SensorSlot slots[MAX_SENSORS_PER_BUS];
+    size_t count;
+
+    uint8_t rx[rtu::MAX_FRAME_BYTES];
+    size_t rxLength;
+
+    void updateWake(uint32_t nowMs) {
+        // Earliest due time, compared relative to now to stay wrap-safe
+        uint32_t best = UINT32_MAX;
+        for (size_t i = 0; i < count; i++) {
+            uint32_t wait = timeReached(nowMs, slots[i].nextDueMs) ? 0 : slots[i].nextDueMs - nowMs;
+            if (wait < best) {
+                best = wait;
+            }
+        }
+        wakeMs = nowMs + ((best == UINT32_MAX) ? 1000 : best);
+    }
+};
+
+// ========== Worker ==========
+
+class Gateway::Worker {
+public:
+    struct Job {
+        uint16_t bus;
+        uint8_t address;
+        uint8_t length;
+        ModbusError error;
+        uint32_t rttUs;
+        uint32_t timestampMs;
+        uint8_t frame[16];          // A one-register response is 7 bytes
+    };
+
+    Worker(Gateway& owner, size_t depth)
+        : _owner(owner), _depth(depth), _stopping(false),
+          _frameErrors(0), _invalidValues(0), _published(0), _cpuUs(0) {
+        _pending.reserve(depth);
+    }
+
+    void start() { _thread = std::thread(&Worker::run, this); }
+
+    void stop() {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _stopping = true;
+        }
+        _wake.notify_one();
+        if (_thread.joinable()) {
+            _thread.join();
+        }
+    }
+
+    bool post(const Job& job) {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (_pending.size() >= _depth) {
+                return false;
+            }
+            _pending.push_back(job);
+        }
+        _wake.notify_one();
+        return true;
+    }
+
+    uint64_t frameErrors() const { return _frameErrors.load(); }
+    uint64_t invalidValues() const { return _invalidValues.load(); }
+    uint64_t published() const { return _published.load(); }
+    uint64_t cpuUs() const { return _cpuUs.load(); }
+
+private:
+    void run() {
+        std::vector<Job> batch;
+        batch.reserve(_depth);
+        for (;;) {
+            {
+                std::unique_lock<std::mutex> lock(_mutex);
+                _wake.wait(lock, [this] { return _stopping || !_pending.empty(); });
+                if (_pending.empty()) {
+                    break;   // Stopping and drained
+                }
+                batch.swap(_pending);
+            }
+            for (const Job& job : batch) {
+                process(job);
+            }
+            batch.clear();
+            _cpuUs.store(threadCpuUs());
+        }
+        _cpuUs.store(threadCpuUs());
+    }
+
+    void process(const Job& job) {
+        GatewayReading reading;
+        reading.bus = job.bus;
+        reading.address = job.address;
+        reading.valid = false;
+        reading.celsius = 0;
+        reading.error = job.error;
+        reading.rttUs = job.rttUs;
+        reading.timestampMs = job.timestampMs;
+
+        if (job.error == ModbusError::SUCCESS) {
+            uint16_t raw = 0;
+            reading.error = rtu::parseReadResponse(job.frame, job.length, job.address, 0x04, 1, &raw);
+            if (reading.error == ModbusError::SUCCESS) {
+                reading.valid = ANDRTF3::decodeTemperature(raw, reading.celsius);
+                if (!reading.valid) {
+                    _invalidValues++;
+                }
+            } else {
+                _frameErrors++;
+            }
+        }
+
+        if (_owner._sink != nullptr) {
+            _owner._sink(reading, _owner._sinkContext);
+        }
+        _published++;
+    }
+
+    Gateway& _owner;
+    size_t _depth;
+    std::thread _thread;
+    std::mutex _mutex;
+    std::condition_variable _wake;
+    std::vector<Job> _pending;
+    bool _stopping;
+    std::atomic<uint64_t> _frameErrors;
+    std::atomic<uint64_t> _invalidValues;
+    std::atomic<uint64_t> _published;
+    std::atomic<uint64_t> _cpuUs;
+};
+
+// ========== Gateway ==========
+
+Gateway::Gateway()
+    : Gateway(getDefaultConfig()) {
+}
+
+Gateway::Gateway(const Config& config)
+    : _config(config),
+      _epollFd(-1),
+      _running(false),
+      _sink(nullptr),
+      _sinkContext(nullptr),
+      _requests(0),
+      _responses(0),
+      _timeouts(0),
+      _dropped(0),
+      _reconnects(0),
+      _loopCpuUs(0) {
+    if (_config.workers == 0) {
+        _config.workers = 1;
+    }
+}
+
+Gateway::~Gateway() {
+    stop();
+    for (auto& bus : _buses) {
+        if (bus->fd >= 0) {
+            ::close(bus->fd);
+        }
+    }
+}
+
+Gateway::Config Gateway::getDefaultConfig() {
+    return {
+        2,        // workers
+        200,      // timeoutMs
+        0,        // tcpGapMs
+        1000,     // reconnectMs
+        1024      // queueDepth
+    };
+}
+
+int Gateway::addTcpBus(const char* host, uint16_t port, SchedulePolicy* policy) {
+    if (_running.load() || host == nullptr || _buses.size() >= MAX_BUSES) {
+        return -1;
+    }
+
+    // Resolve once here; the loop must never block on DNS
+    struct addrinfo hints;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    char service[8];
+    snprintf(service, sizeof(service), "%u", port);
+    struct addrinfo* result = nullptr;
+    if (getaddrinfo(host, service, &hints, &result) != 0 || result == nullptr) {
+        ANDRTF3_LOG_W("Gateway: cannot resolve %s", host);
+        return -1;
+    }
+
+    std::unique_ptr<Bus> bus(new Bus());
+    bus->serial = false;
+    memcpy(&bus->address, result->ai_addr, result->ai_addrlen);
+    bus->addressLength = result->ai_addrlen;
+    freeaddrinfo(result);
+    strncpy(bus->endpoint, host, sizeof(bus->endpoint) - 1);
+    bus->baudRate = 0;
+    bus->gapMs = _config.tcpGapMs;
+    bus->policy = policy;
+
+    _buses.push_back(std::move(bus));
+    return static_cast<int>(_buses.size() - 1);
+}
+
+int Gateway::addSerialBus(const char* device, uint32_t baudRate, SchedulePolicy* policy) {
+    speed_t speed;
+    if (_running.load() || device == nullptr || _buses.size() >= MAX_BUSES || !baudToSpeed(baudRate, speed)) {
+        return -1;
+    }
+
+    std::unique_ptr<Bus> bus(new Bus());
+    bus->serial = true;
+    strncpy(bus->endpoint, device, sizeof(bus->endpoint) - 1);
+    bus->addressLength = 0;
+    bus->baudRate = baudRate;
+    bus->gapMs = GapTuner::frameGapMs(baudRate);
+    bus->policy = policy;
+
+    _buses.push_back(std::move(bus));
+    return static_cast<int>(_buses.size() - 1);
+}
+
+bool Gateway::addSensor(int busId, uint8_t address, uint32_t periodMs, uint8_t priority, uint8_t zone) {
+    if (_running.load() || busId < 0 || static_cast<size_t>(busId) >= _buses.size() || periodMs == 0) {
+        return false;
+    }
+    Bus& bus = *_buses[busId];
+    if (bus.count >= MAX_SENSORS_PER_BUS) {
+        ANDRTF3_LOG_W("Gateway bus %d full, address %d not added", busId, address);
+        return false;
+    }
+    bus.slots[bus.count].reset(address, periodMs, priority, zone);
+    bus.count++;
+    return true;
+}
+
+void Gateway::setSink(GatewayReadingSink sink, void* context) {
+    _sink = sink;
+    _sinkContext = context;
+}
+
+bool Gateway::start() {
+    if (_running.load()) {
+        return true;
+    }
+
+    _epollFd = epoll_create1(EPOLL_CLOEXEC);
+    if (_epollFd < 0) {
+        ANDRTF3_LOG_E("Gateway: epoll_create1 failed (%d)", errno);
+        return false;
+    }
+
+    uint32_t now = monotonicMs();
+    for (size_t i = 0; i < _buses.size(); i++) {
+        Bus& bus = *_buses[i];
+        bus.id = static_cast<uint16_t>(i);
+        bus.fd = -1;
+        bus.state = Bus::State::CLOSED;
+        bus.everOpened = false;
+        bus.readyMs = now;
+        bus.current = -1;
+        bus.rxLength = 0;
+        if (bus.policy == nullptr) {
+            bus.policy = &bus.ownPolicy;
+        }
+        bus.policy->reset();
+        for (size_t s = 0; s < bus.count; s++) {
+            bus.slots[s].nextDueMs = now;
+        }
+        bus.updateWake(now);
+    }
+
+    _workers.clear();
+    for (uint8_t i = 0; i < _config.workers; i++) {
+        _workers.emplace_back(new Worker(*this, _config.queueDepth));
+        _workers.back()->start();
+    }
+
+    _running.store(true);
+    _loop = std::thread(&Gateway::run, this);
+    ANDRTF3_LOG_I("Gateway: %u buses, %u workers", static_cast<unsigned>(_buses.size()), _config.workers);
+    return true;
+}
+
+void Gateway::stop() {
+    if (!_running.exchange(false)) {
+        return;
+    }
+    _loop.join();
+    for (auto& worker : _workers) {
+        worker->stop();
+    }
+    uint32_t now = monotonicMs();
+    for (auto& bus : _buses) {
+        closeBus(*bus, now, false);
+    }
+    ::close(_epollFd);
+    _epollFd = -1;
+}
+
+Gateway::Stats Gateway::getStats() const {
+    Stats stats;
+    stats.requests = _requests.load();
+    stats.responses = _responses.load();
+    stats.timeouts = _timeouts.load();
+    stats.frameErrors = 0;
+    stats.invalidValues = 0;
+    stats.published = 0;
+    stats.dropped = _dropped.load();
+    stats.reconnects = _reconnects.load();
+    stats.loopCpuUs = _loopCpuUs.load();
+    stats.workerCpuUs = 0;
+    for (const auto& worker : _workers) {
+        stats.frameErrors += worker->frameErrors();
+        stats.invalidValues += worker->invalidValues();
+        stats.published += worker->published();
+        stats.workerCpuUs += worker->cpuUs();
+    }
+    return stats;
+}
+
+void Gateway::run() {
+    struct epoll_event events[64];
+
+    while (_running.load()) {
+        uint32_t now = monotonicMs();
+        for (auto& bus : _buses) {
+            service(*bus, now);
+        }
+
+        int ready = epoll_wait(_epollFd, events, 64, nextWakeMs(monotonicMs()));
+        now = monotonicMs();
+        for (int i = 0; i < ready; i++) {
+            Bus& bus = *_buses[events[i].data.u32];
+            if (bus.fd < 0) {
+                continue;
+            }
+            if (bus.state == Bus::State::CONNECTING) {
+                onWritable(bus, now);
+            } else if (events[i].events & EPOLLIN) {
+                onReadable(bus, now);
+            } else if (events[i].events & (EPOLLERR | EPOLLHUP)) {
+                if (bus.state == Bus::State::WAITING) {
+                    finish(bus, false, nullptr, 0, now);
+                }
+                closeBus(bus, now, true);
+            }
+        }
+
+        _loopCpuUs.store(threadCpuUs());
+    }
+}
+
+void Gateway::service(Bus& bus, uint32_t nowMs) {
+    switch (bus.state) {
+        case Bus::State::CLOSED:
+            if (timeReached(nowMs, bus.readyMs) && !open(bus, nowMs)) {
+                bus.readyMs = nowMs + _config.reconnectMs;
+            }
+            break;
+
+        case Bus::State::CONNECTING:
+            if (timeReached(nowMs, bus.deadlineMs)) {
+                ANDRTF3_LOG_W("Gateway: connect to %s timed out", bus.endpoint);
+                closeBus(bus, nowMs, true);
+            }
+            break;
+
+        case Bus::State::WAITING:
+            if (timeReached(nowMs, bus.deadlineMs)) {
+                finish(bus, false, nullptr, 0, nowMs);
+                if (bus.serial) {
+                    tcflush(bus.fd, TCIFLUSH);   // Whatever arrives late is noise
+                    bus.rxLength = 0;
+                } else {
+                    // A late answer must not be paired with the next request
+                    closeBus(bus, nowMs, false);
+                }
+            }
+            break;
+
+        case Bus::State::IDLE: {
+            if (!timeReached(nowMs, bus.readyMs) || !timeReached(nowMs, bus.wakeMs)) {
+                break;
+            }
+            int index = bus.policy->selectNext(bus.slots, bus.count, nowMs);
+            if (index < 0) {
+                bus.updateWake(nowMs);
+                if (timeReached(nowMs, bus.wakeMs)) {
+                    bus.wakeMs = nowMs + 5;   // Due but held back by the policy
+                }
+                break;
+            }
+
+            uint8_t request[rtu::READ_REQUEST_BYTES];
+            rtu::buildReadRequest(bus.slots[index].address, 0x04, 50, 1, request);
+            ssize_t written = write(bus.fd, request, sizeof(request));
+            if (written != static_cast<ssize_t>(sizeof(request))) {
+                closeBus(bus, nowMs, true);
+                break;
+            }
+            _requests++;
+            bus.current = index;
+            bus.sentUs = monotonicUs();
+            bus.deadlineMs = nowMs + _config.timeoutMs;
+            bus.rxLength = 0;
+            bus.state = Bus::State::WAITING;
+            break;
+        }
+    }
+}
+
+void Gateway::onWritable(Bus& bus, uint32_t nowMs) {
+    int error = 0;
+    socklen_t length = sizeof(error);
+    if (getsockopt(bus.fd, SOL_SOCKET, SO_ERROR, &error, &length) != 0 || error != 0) {
+        closeBus(bus, nowMs, true);
+        return;
+    }
+    struct epoll_event event;
+    event.events = EPOLLIN;
+    event.data.u32 = bus.id;
+    epoll_ctl(_epollFd, EPOLL_CTL_MOD, bus.fd, &event);
+    bus.state = Bus::State::IDLE;
+    bus.readyMs = nowMs;
+}
+
+void Gateway::onReadable(Bus& bus, uint32_t nowMs) {
+    for (;;) {
+        if (bus.rxLength >= sizeof(bus.rx)) {
+            bus.rxLength = 0;   // Garbage; the response will time out
+        }
+        ssize_t n = read(bus.fd, bus.rx + bus.rxLength, sizeof(bus.rx) - bus.rxLength);
+        if (n > 0) {
+            bus.rxLength += static_cast<size_t>(n);
+            continue;
+        }
+        if (n == 0 && !bus.serial) {
+            if (bus.state == Bus::State::WAITING) {
+                finish(bus, false, nullptr, 0, nowMs);
+            }
+            closeBus(bus, nowMs, true);   // Server closed the connection
+            return;
+        }
+        break;   // EAGAIN (or no data on a tty)
+    }
+
+    if (bus.state != Bus::State::WAITING) {
+        bus.rxLength = 0;   // Nothing asked for
+        return;
+    }
+
+    size_t need = rtu::responseLength(bus.rx, bus.rxLength);
+    if (need == 0 || bus.rxLength < need) {
+        return;
+    }
+    if (bus.rx[0] != bus.slots[bus.current].address || need > sizeof(Worker::Job::frame)) {
+        bus.rxLength = 0;   // Stray or oversized frame; keep waiting for ours
+        return;
+    }
+    finish(bus, true, bus.rx, need, nowMs);
+}
+
+bool Gateway::open(Bus& bus, uint32_t nowMs) {
+    struct epoll_event event;
+    event.data.u32 = bus.id;
+
+    if (bus.serial) {
+        int fd = ::open(bus.endpoint, O_RDWR | O_NOCTTY | O_NONBLOCK | O_CLOEXEC);
+        if (fd < 0) {
+            ANDRTF3_LOG_W("Gateway: cannot open %s (%d)", bus.endpoint, errno);
+            return false;
+        }
+        struct termios tio;
+        speed_t speed = B9600;
+        baudToSpeed(bus.baudRate, speed);
+        if (tcgetattr(fd, &tio) == 0) {
+            cfmakeraw(&tio);
+            cfsetispeed(&tio, speed);
+            cfsetospeed(&tio, speed);
+            tio.c_cflag |= CLOCAL | CREAD;
+            tio.c_cc[VMIN] = 0;
+            tio.c_cc[VTIME] = 0;
+            tcsetattr(fd, TCSANOW, &tio);
+        }
+        bus.fd = fd;
+        bus.state = Bus::State::IDLE;
+        event.events = EPOLLIN;
+    } else {
+        int fd = socket(bus.address.ss_family, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (fd < 0) {
+            return false;
+        }
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        int rc = connect(fd, reinterpret_cast<struct sockaddr*>(&bus.address), bus.addressLength);
+        if (rc < 0 && errno != EINPROGRESS) {
+            ::close(fd);
+            return false;
+        }
+        bus.fd = fd;
+        if (rc == 0) {
+            bus.state = Bus::State::IDLE;
+            event.events = EPOLLIN;
+        } else {
+            bus.state = Bus::State::CONNECTING;
+            bus.deadlineMs = nowMs + _config.reconnectMs;
+            event.events = EPOLLOUT;
+        }
+    }
+
+    if (epoll_ctl(_epollFd, EPOLL_CTL_ADD, bus.fd, &event) != 0) {
+        ::close(bus.fd);
+        bus.fd = -1;
+        bus.state = Bus::State::CLOSED;
+        return false;
+    }
+    if (bus.everOpened) {
+        _reconnects++;
+    }
+    bus.everOpened = true;
+    bus.readyMs = nowMs;
+    bus.rxLength = 0;
+    return true;
+}
+
+void Gateway::closeBus(Bus& bus, uint32_t nowMs, bool backOff) {
+    if (bus.fd >= 0) {
+        epoll_ctl(_epollFd, EPOLL_CTL_DEL, bus.fd, nullptr);
+        ::close(bus.fd);
+        bus.fd = -1;
+    }
+    bus.state = Bus::State::CLOSED;
+    bus.current = -1;
+    bus.rxLength = 0;
+    bus.readyMs = backOff ? nowMs + _config.reconnectMs : nowMs;
+}
+
+void Gateway::finish(Bus& bus, bool responded, const uint8_t* frame, size_t length, uint32_t nowMs) {
+    SensorSlot& slot = bus.slots[bus.current];
+    uint32_t rttUs = static_cast<uint32_t>(monotonicUs() - bus.sentUs);
+
+    // Scheduling feedback from the framing alone; workers do the full decode
+    bool ok = responded && (frame[1] & 0x80) == 0 && length >= 7;
+    int16_t value = ok ? static_cast<int16_t>((frame[3] << 8) | frame[4]) : slot.lastValue;
+    slot.recordResult(ok, value, rttUs / 1000, nowMs);
+    bus.policy->onResult(slot, ok, nowMs);
+
+    Worker::Job job;
+    job.bus = bus.id;
+    job.address = slot.address;
+    job.length = static_cast<uint8_t>(responded ? length : 0);
+    job.error = responded ? ModbusError::SUCCESS : ModbusError::TIMEOUT;
+    job.rttUs = rttUs;
+    job.timestampMs = nowMs;
+    if (responded) {
+        memcpy(job.frame, frame, length);
+        _responses++;
+    } else {
+        _timeouts++;
+    }
+    if (!_workers[bus.id % _workers.size()]->post(job)) {
+        _dropped++;
+    }
+
+    bus.current = -1;
+    bus.rxLength = 0;
+    bus.state = Bus::State::IDLE;
+    bus.readyMs = nowMs + bus.gapMs;
+    bus.updateWake(nowMs);
+}
+
+int Gateway::nextWakeMs(uint32_t nowMs) const {
+    uint32_t best = 100;   // Upper bound so stop() is noticed
+    for (const auto& bus : _buses) {
+        uint32_t at;
+        switch (bus->state) {
+            case Bus::State::CLOSED:     at = bus->readyMs; break;
+            case Bus::State::CONNECTING: at = bus->deadlineMs; break;
+            case Bus::State::WAITING:    at = bus->deadlineMs; break;
+            case Bus::State::IDLE:
+            default:
+                at = timeReached(bus->readyMs, bus->wakeMs) ? bus->readyMs : bus->wakeMs;
+                break;
+        }
+        if (timeReached(nowMs, at)) {
+            return 0;
+        }
+        if (at - nowMs < best) {
+            best = at - nowMs;
+        }
+    }
+    return static_cast<int>(best);
+}
+
+} // namespace andrtf3
+
+#endif // __linux__
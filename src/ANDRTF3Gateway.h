@@ -0,0 +1,157 @@
+/*
+ * ANDRTF3Gateway.h - part of the ESP32-ANDRTF3 library
+ *
+ * Copyright (C) 2025-2026 packerlschupfer
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+
+#ifndef ANDRTF3_GATEWAY_H
+#define ANDRTF3_GATEWAY_H
+
+#include "ANDRTF3Scheduler.h"
+#include "ANDRTF3Transport.h"
+
+#if defined(__linux__)
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace andrtf3 {
+
+// One decoded reading handed to the application by a gateway worker
+struct GatewayReading {
+    uint16_t bus;
+    uint8_t address;
+    bool valid;
+    int16_t celsius;               // Deci-degrees (raw value if !valid)
+    ModbusError error;             // SUCCESS, TIMEOUT, CRC_ERROR, exception...
+    uint32_t rttUs;
+    uint32_t timestampMs;          // Gateway monotonic clock
+};
+
+// Called on a worker thread; readings of one bus always arrive in order
+// on the same worker
+typedef void (*GatewayReadingSink)(const GatewayReading& reading, void* context);
+
+/**
+ * Event-loop engine for many buses in one process (Linux)
+ *
+ * A single loop thread multiplexes every bus over epoll: RTU-over-TCP
+ * connections to serial servers and local serial ports alike. Each bus has
+ * one transaction in flight, its own SensorSlot table and SchedulePolicy
+ * (round-robin unless one is given), and its own timeout and inter-frame
+ * gap timers; the loop sleeps until the earliest of them.
+ *
+ * The loop only frames responses. CRC checking, ANDRTF3 value validation
+ * and the sink callback run on a small worker pool; a bus is always
+ * handled by the same worker, so per-sensor order is preserved without
+ * locks. No thread is created per bus.
+ */
+class Gateway {
+public:
+    static constexpr size_t MAX_BUSES = 256;
+    static constexpr size_t MAX_SENSORS_PER_BUS = 64;
+
+    struct Config {
+        uint8_t workers;            // Decode/publish threads (default: 2)
+        uint32_t timeoutMs;         // Response timeout (default: 200)
+        uint16_t tcpGapMs;          // Idle time between transactions on TCP buses (default: 0)
+        uint32_t reconnectMs;       // Back-off after a connection failure (default: 1000)
+        uint16_t queueDepth;        // Pending readings per worker before dropping (default: 1024)
+    };
+
+    struct Stats {
+        uint64_t requests;
+        uint64_t responses;         // Frames received and handed to workers
+        uint64_t timeouts;
+        uint64_t frameErrors;       // CRC / exception / framing, found by workers
+        uint64_t invalidValues;     // 0x0000, 0xFFFF or out of range
+        uint64_t published;         // Readings passed to the sink
+        uint64_t dropped;           // Worker queue full
+        uint64_t reconnects;
+        uint64_t loopCpuUs;         // CPU time of the loop thread
+        uint64_t workerCpuUs;       // CPU time of all workers
+    };
+
+    Gateway();
+    explicit Gateway(const Config& config);
+    ~Gateway();
+
+    Gateway(const Gateway&) = delete;
+    Gateway& operator=(const Gateway&) = delete;
+
+    static Config getDefaultConfig();
+
+    /**
+     * @brief Add a bus; call before start()
+     * @param policy Per-bus scheduling policy (not shared between buses), nullptr = round-robin
+     * @return bus id, or -1
+     */
+    int addTcpBus(const char* host, uint16_t port, SchedulePolicy* policy = nullptr);
+    int addSerialBus(const char* device, uint32_t baudRate, SchedulePolicy* policy = nullptr);
+
+    bool addSensor(int bus, uint8_t address, uint32_t periodMs, uint8_t priority = 0, uint8_t zone = 0);
+
+    void setSink(GatewayReadingSink sink, void* context);
+
+    // Spawn the loop thread and the workers / stop and join them
+    bool start();
+    void stop();
+    [[nodiscard]] bool isRunning() const noexcept { return _running.load(); }
+
+    [[nodiscard]] size_t getBusCount() const noexcept { return _buses.size(); }
+    [[nodiscard]] Stats getStats() const;
+
+private:
+    struct Bus;
+    class Worker;
+
+    void run();
+    void service(Bus& bus, uint32_t nowMs);
+    void onReadable(Bus& bus, uint32_t nowMs);
+    void onWritable(Bus& bus, uint32_t nowMs);
+    bool open(Bus& bus, uint32_t nowMs);
+    void closeBus(Bus& bus, uint32_t nowMs, bool backOff);
+    void finish(Bus& bus, bool responded, const uint8_t* frame, size_t length, uint32_t nowMs);
+    int nextWakeMs(uint32_t nowMs) const;
+
+    Config _config;
+    int _epollFd;
+    std::vector<std::unique_ptr<Bus>> _buses;
+    std::vector<std::unique_ptr<Worker>> _workers;
+    std::thread _loop;
+    std::atomic<bool> _running;
+    GatewayReadingSink _sink;
+    void* _sinkContext;
+
+    // Loop-thread counters; worker counters live in Worker
+    std::atomic<uint64_t> _requests;
+    std::atomic<uint64_t> _responses;
+    std::atomic<uint64_t> _timeouts;
+    std::atomic<uint64_t> _dropped;
+    std::atomic<uint64_t> _reconnects;
+    std::atomic<uint64_t> _loopCpuUs;
+};
+
+} // namespace andrtf3
+
+#endif // __linux__
+
+#endif // ANDRTF3_GATEWAY_H
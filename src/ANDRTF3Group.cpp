@@ -0,0 +1,141 @@
+/*
+ * ANDRTF3Group.cpp - part of the ESP32-ANDRTF3 library
+ *
+ * Copyright (C) 2025-2026 packerlschupfer
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "ANDRTF3Group.h"
+#include "ANDRTF3Logging.h"
+
+namespace andrtf3 {
+
+ANDRTF3Group::ANDRTF3Group()
+    : _eventGroup(xEventGroupCreate()),
+      _members{},
+      _count(0),
+      _memberMask(0) {
+    if (_eventGroup == nullptr) {
+        ANDRTF3_LOG_E("Group: failed to create event group");
+    }
+}
+
+ANDRTF3Group::~ANDRTF3Group() {
+    for (size_t i = 0; i < MAX_MEMBERS; i++) {
+        if (_members[i] != nullptr) {
+            detachNotification(*_members[i]);
+            _members[i]->removeDetachHook(onMemberDestroyed, this);
+        }
+    }
+    if (_eventGroup != nullptr) {
+        vEventGroupDelete(_eventGroup);
+    }
+}
+
+int ANDRTF3Group::add(ANDRTF3& sensor) {
+    if (_eventGroup == nullptr) {
+        return -1;
+    }
+
+    size_t freeBit = MAX_MEMBERS;
+    for (size_t i = 0; i < MAX_MEMBERS; i++) {
+        if (_members[i] == &sensor) {
+            return static_cast<int>(i);  // Already a member
+        }
+        if (_members[i] == nullptr && freeBit == MAX_MEMBERS) {
+            freeBit = i;
+        }
+    }
+    EventGroupHandle_t current = sensor.getUpdateNotification();
+    if (current != nullptr && current != _eventGroup) {
+        ANDRTF3_LOG_W("Group: address %d already notifies another group", sensor.getDeviceAddress());
+        return -1;
+    }
+    if (freeBit == MAX_MEMBERS) {
+        ANDRTF3_LOG_W("Group full (%d sensors), address %d not added",
+                      static_cast<int>(MAX_MEMBERS), sensor.getDeviceAddress());
+        return -1;
+    }
+    if (!sensor.addDetachHook(onMemberDestroyed, this)) {
+        return -1;
+    }
+
+    EventBits_t bit = static_cast<EventBits_t>(1UL << freeBit);
+    xEventGroupClearBits(_eventGroup, bit);
+    _members[freeBit] = &sensor;
+    _memberMask |= bit;
+    _count++;
+    sensor.setUpdateNotification(_eventGroup, bit);
+    return static_cast<int>(freeBit);
+}
+
+void ANDRTF3Group::remove(ANDRTF3& sensor) {
+    for (size_t i = 0; i < MAX_MEMBERS; i++) {
+        if (_members[i] == &sensor) {
+            detachNotification(sensor);
+            sensor.removeDetachHook(onMemberDestroyed, this);
+            _members[i] = nullptr;
+            _memberMask &= ~(1UL << i);
+            _count--;
+            xEventGroupClearBits(_eventGroup, static_cast<EventBits_t>(1UL << i));
+            return;
+        }
+    }
+}
+
+void ANDRTF3Group::detachNotification(ANDRTF3& sensor) {
+    // Someone may have pointed the sensor elsewhere since; leave that alone
+    if (sensor.getUpdateNotification() == _eventGroup) {
+        sensor.setUpdateNotification(nullptr, 0);
+    }
+}
+
+void ANDRTF3Group::onMemberDestroyed(ANDRTF3& sensor, void* context) {
+    static_cast<ANDRTF3Group*>(context)->remove(sensor);
+}
+
+uint32_t ANDRTF3Group::waitAny(TickType_t timeout) {
+    if (_eventGroup == nullptr || _memberMask == 0) {
+        return 0;
+    }
+    EventBits_t bits = xEventGroupWaitBits(_eventGroup, _memberMask,
+                                           pdTRUE,    // clear on exit
+                                           pdFALSE,   // any bit
+                                           timeout);
+    return static_cast<uint32_t>(bits) & _memberMask;
+}
+
+uint32_t ANDRTF3Group::waitAll(uint32_t mask, TickType_t timeout) {
+    mask &= _memberMask;
+    if (_eventGroup == nullptr || mask == 0) {
+        return 0;
+    }
+    EventBits_t bits = xEventGroupWaitBits(_eventGroup, mask,
+                                           pdTRUE,    // clear on exit (only if all set)
+                                           pdTRUE,    // all bits
+                                           timeout);
+    return static_cast<uint32_t>(bits) & mask;
+}
+
+uint32_t ANDRTF3Group::getPending() const {
+    if (_eventGroup == nullptr) {
+        return 0;
+    }
+    return static_cast<uint32_t>(xEventGroupGetBits(_eventGroup)) & _memberMask;
+}
+
+} // namespace andrtf3
@@ -0,0 +1,111 @@
+/*
+ * ANDRTF3Group.h - part of the ESP32-ANDRTF3 library
+ *
+ * Copyright (C) 2025-2026 packerlschupfer
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#ifndef ANDRTF3_GROUP_H
+#define ANDRTF3_GROUP_H
+
+#include "ANDRTF3.h"
+
+namespace andrtf3 {
+
+/**
+ * "Wait for any" over a set of ANDRTF3 sensors
+ *
+ * Each member gets one bit of a shared FreeRTOS event group, set by the
+ * driver whenever that sensor publishes a new valid reading. A control task
+ * blocks in waitAny() and wakes with a bitmask of the sensors that updated,
+ * instead of polling every sensor in a loop.
+ *
+ * Example usage:
+ * @code
+ * ANDRTF3Group zones;
+ * for (auto* s : zoneSensors) zones.add(*s);
+ *
+ * for (;;) {
+ *     uint32_t updated = zones.waitAny(pdMS_TO_TICKS(10000));
+ *     for (size_t i = 0; i < zones.size(); i++) {
+ *         if (updated & (1UL << i)) handleZone(i, zones.getMember(i)->getTemperature());
+ *     }
+ * }
+ * @endcode
+ */
+class ANDRTF3Group {
+public:
+    // Event groups carry 24 usable bits with 32-bit ticks
+    static constexpr size_t MAX_MEMBERS = 24;
+
+    ANDRTF3Group();
+    ~ANDRTF3Group();
+
+    ANDRTF3Group(const ANDRTF3Group&) = delete;
+    ANDRTF3Group& operator=(const ANDRTF3Group&) = delete;
+
+    /**
+     * @brief Add a sensor to the group
+     *
+     * A sensor has one update notification target, so it can belong to one
+     * group at a time: add() refuses a sensor that already notifies another
+     * event group. remove() and ~ANDRTF3Group only detach the notification
+     * while it still points at this group. A member that is destroyed leaves
+     * the group by itself.
+     *
+     * @return bit index of the sensor in waitAny() results, or -1 if full
+     *         or the sensor notifies another group
+     */
+    [[nodiscard]] int add(ANDRTF3& sensor);
+    void remove(ANDRTF3& sensor);
+
+    /**
+     * @brief Block until at least one member has a new reading
+     *
+     * Returned bits are cleared, so each update is reported once.
+     *
+     * @param timeout Ticks to wait (portMAX_DELAY = forever)
+     * @return bitmask of updated members (bit i = member i), 0 on timeout
+     */
+    uint32_t waitAny(TickType_t timeout = portMAX_DELAY);
+
+    /**
+     * @brief Block until every member in mask has a new reading
+     * @return the members of mask that updated (== mask unless timed out)
+     */
+    uint32_t waitAll(uint32_t mask, TickType_t timeout = portMAX_DELAY);
+
+    // Non-blocking: members updated since the last wait, without clearing
+    [[nodiscard]] uint32_t getPending() const;
+
+    [[nodiscard]] size_t size() const noexcept { return _count; }
+    [[nodiscard]] uint32_t getMemberMask() const noexcept { return _memberMask; }
+    [[nodiscard]] ANDRTF3* getMember(size_t bit) const { return bit < MAX_MEMBERS ? _members[bit] : nullptr; }
+
+private:
+    void detachNotification(ANDRTF3& sensor);
+    static void onMemberDestroyed(ANDRTF3& sensor, void* context);
+
+    EventGroupHandle_t _eventGroup;
+    ANDRTF3* _members[MAX_MEMBERS];
+    size_t _count;
+    uint32_t _memberMask;
+};
+
+} // namespace andrtf3
+
+#endif // ANDRTF3_GROUP_H
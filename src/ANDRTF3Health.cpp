@@ -0,0 +1,208 @@
+/*
+ * ANDRTF3Health.cpp - part of the ESP32-ANDRTF3 library
+ *
+ * Copyright (C) 2025-2026 packerlschupfer
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+
+#include "ANDRTF3Health.h"
+#include "ANDRTF3Logging.h"
+
+#include <string.h>
+
+namespace andrtf3 {
+
+namespace {
+
+const char* warningName(HealthWarning warning) {
+    return (warning == HealthWarning::RTT_RISING) ? "response time" : "error rate";
+}
+
+uint8_t evidencePercent(int32_t cusum, int32_t alarm) {
+    if (alarm <= 0) {
+        return 0;
+    }
+    int32_t percent = (cusum * 100) / alarm;
+    return static_cast<uint8_t>((percent < 200) ? percent : 200);
+}
+
+// One-sided CUSUM step, clamped so a recovered slot clears in bounded time
+int32_t cusumStep(int32_t cusum, int32_t excess, int32_t alarm) {
+    int32_t next = cusum + excess;
+    if (next <= 0) {
+        return 0;
+    }
+    return (next < 2 * alarm) ? next : 2 * alarm;
+}
+
+} // namespace
+
+HealthMonitor::HealthMonitor()
+    : HealthMonitor(getDefaultConfig()) {
+}
+
+HealthMonitor::HealthMonitor(const Config& config)
+    : _config(config),
+      _entries{},
+      _callback(nullptr),
+      _callbackContext(nullptr),
+      _warnings(0) {
+    if (_config.learnSamples == 0) {
+        _config.learnSamples = 1;
+    }
+    if (_config.alarmShifts == 0) {
+        _config.alarmShifts = 1;
+    }
+    if (_config.alarmFailures == 0) {
+        _config.alarmFailures = 1;
+    }
+    if (_config.ewmaShift > 8) {
+        _config.ewmaShift = 8;
+    }
+    reset();
+}
+
+HealthMonitor::Config HealthMonitor::getDefaultConfig() {
+    return {
+        50,                       // learnSamples
+        5,                        // riseMs
+        25,                       // risePercent
+        50,                       // errorRisePermille (5 percentage points)
+        5,                        // alarmShifts
+        3,                        // alarmFailures
+        3                         // ewmaShift (1/8)
+    };
+}
+
+void HealthMonitor::reset() {
+    memset(_entries, 0, sizeof(_entries));
+    _warnings = 0;
+}
+
+void HealthMonitor::rebaseline(size_t slot) {
+    if (slot >= MAX_SLOTS) {
+        return;
+    }
+    Entry& e = _entries[slot];
+    if (e.rttWarning) {
+        raise(slot, e.rttWarning, HealthWarning::RTT_RISING, false);
+    }
+    if (e.errorWarning) {
+        raise(slot, e.errorWarning, HealthWarning::ERRORS_RISING, false);
+    }
+    memset(&e, 0, sizeof(e));
+}
+
+int32_t HealthMonitor::rttShiftQ4(const Entry& entry) const {
+    int32_t relative = (entry.baselineRttQ4 * _config.risePercent) / 100;
+    int32_t absolute = static_cast<int32_t>(_config.riseMs) * Q;
+    int32_t shift = (relative > absolute) ? relative : absolute;
+    return (shift > 0) ? shift : Q;
+}
+
+void HealthMonitor::raise(size_t slot, bool& flag, HealthWarning warning, bool raised) {
+    flag = raised;
+    if (raised) {
+        _warnings++;
+        ANDRTF3_LOG_W("Health: slot %d %s rising", static_cast<int>(slot), warningName(warning));
+    } else {
+        ANDRTF3_LOG_I("Health: slot %d %s back to baseline", static_cast<int>(slot), warningName(warning));
+    }
+    if (_callback != nullptr) {
+        _callback(slot, warning, raised, _callbackContext);
+    }
+}
+
+void HealthMonitor::onResult(size_t slot, bool success, uint32_t rttMs) {
+    if (slot >= MAX_SLOTS) {
+        return;
+    }
+    Entry& e = _entries[slot];
+    int32_t divisor = 1 << _config.ewmaShift;
+    int32_t rttQ4 = static_cast<int32_t>((rttMs < 0xFFFF) ? rttMs : 0xFFFF) * Q;
+
+    e.reads++;
+    int32_t errorSample = success ? 0 : 1000 * Q;
+    e.errorEwmaQ4 += (errorSample - e.errorEwmaQ4) / divisor;
+    if (success) {
+        e.successes++;
+        e.rttEwmaQ4 = (e.rttEwmaQ4 == 0) ? rttQ4 : e.rttEwmaQ4 + (rttQ4 - e.rttEwmaQ4) / divisor;
+    }
+
+    if (!e.learned) {
+        if (success) {
+            e.learnRttSumQ4 += static_cast<uint32_t>(rttQ4);
+        } else if (e.learnFailures < 0xFFFF) {
+            e.learnFailures++;
+        }
+        // Needs at least one answer to know the baseline turnaround
+        if (e.reads >= _config.learnSamples && e.successes > 0) {
+            e.baselineRttQ4 = static_cast<int32_t>(e.learnRttSumQ4 / e.successes);
+            e.baselineErrorPermille = static_cast<uint16_t>((e.learnFailures * 1000u) / e.reads);
+            e.learned = true;
+        }
+        return;
+    }
+
+    if (success) {
+        int32_t shift = rttShiftQ4(e);
+        int32_t alarm = shift * _config.alarmShifts;
+        e.rttCusumQ4 = cusumStep(e.rttCusumQ4, rttQ4 - e.baselineRttQ4 - shift / 2, alarm);
+        if (!e.rttWarning && e.rttCusumQ4 > alarm) {
+            raise(slot, e.rttWarning, HealthWarning::RTT_RISING, true);
+        } else if (e.rttWarning && e.rttCusumQ4 == 0) {
+            raise(slot, e.rttWarning, HealthWarning::RTT_RISING, false);
+        }
+    }
+
+    int32_t allowance = e.baselineErrorPermille + _config.errorRisePermille / 2;
+    int32_t errorAlarm = static_cast<int32_t>(_config.alarmFailures) * 1000;
+    e.errorCusum = cusumStep(e.errorCusum, (success ? 0 : 1000) - allowance, errorAlarm);
+    if (!e.errorWarning && e.errorCusum > errorAlarm) {
+        raise(slot, e.errorWarning, HealthWarning::ERRORS_RISING, true);
+    } else if (e.errorWarning && e.errorCusum == 0) {
+        raise(slot, e.errorWarning, HealthWarning::ERRORS_RISING, false);
+    }
+}
+
+bool HealthMonitor::hasWarning(size_t slot) const {
+    return (slot < MAX_SLOTS) && (_entries[slot].rttWarning || _entries[slot].errorWarning);
+}
+
+HealthMonitor::Status HealthMonitor::getStatus(size_t slot) const {
+    Status status = {};
+    if (slot >= MAX_SLOTS) {
+        return status;
+    }
+    const Entry& e = _entries[slot];
+    status.baselineRttMs = static_cast<uint16_t>((e.baselineRttQ4 + Q / 2) / Q);
+    status.rttEwmaMs = static_cast<uint16_t>((e.rttEwmaQ4 + Q / 2) / Q);
+    status.baselineErrorPermille = e.baselineErrorPermille;
+    status.errorEwmaPermille = static_cast<uint16_t>((e.errorEwmaQ4 + Q / 2) / Q);
+    status.reads = e.reads;
+    if (e.learned) {
+        status.rttEvidencePercent = evidencePercent(e.rttCusumQ4, rttShiftQ4(e) * _config.alarmShifts);
+        status.errorEvidencePercent = evidencePercent(e.errorCusum, static_cast<int32_t>(_config.alarmFailures) * 1000);
+    }
+    status.learning = !e.learned;
+    status.rttWarning = e.rttWarning;
+    status.errorWarning = e.errorWarning;
+    return status;
+}
+
+} // namespace andrtf3
@@ -0,0 +1,137 @@
+/*
+ * ANDRTF3Health.h - part of the ESP32-ANDRTF3 library
+ *
+ * Copyright (C) 2025-2026 packerlschupfer
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+
+#ifndef ANDRTF3_HEALTH_H
+#define ANDRTF3_HEALTH_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+namespace andrtf3 {
+
+enum class HealthWarning : uint8_t {
+    RTT_RISING,                 // Turnaround time shifted up from its baseline
+    ERRORS_RISING               // Failure rate shifted up from its baseline
+};
+
+// Called when a warning is raised or cleared for a slot
+typedef void (*HealthCallback)(size_t slot, HealthWarning warning, bool raised, void* context);
+
+/**
+ * Response-time and error-rate trend monitor
+ *
+ * Rising turnaround times or retry rates on one address often come before
+ * a total failure (corroded terminals, a failing supply). Each slot learns
+ * a baseline RTT and failure rate over its first learnSamples reads. After
+ * that, a one-sided CUSUM per signal accumulates evidence of an upward
+ * shift. A warning is raised when the evidence crosses the alarm level, and
+ * cleared once the signal has been back at its baseline long enough to
+ * drain the CUSUM. Fast EWMAs of both signals are kept for dashboards.
+ *
+ * The RTT shift to detect is riseMs or risePercent of the baseline,
+ * whichever is larger. Half of it is the per-read allowance, so jitter
+ * around the baseline does not accumulate. Failures are scored as a
+ * Bernoulli CUSUM against baseline + errorRisePermille / 2, so the warning
+ * needs a cluster of failures rather than one unlucky read.
+ *
+ * O(1) per read, no allocation. After maintenance, rebaseline() relearns a
+ * slot. Slots are indexed like ANDRTF3Poller / GapTuner slots.
+ */
+class HealthMonitor {
+public:
+    static constexpr size_t MAX_SLOTS = 64;
+
+    struct Config {
+        uint16_t learnSamples;      // Reads that set the baseline
+        uint16_t riseMs;            // Smallest RTT shift worth a warning
+        uint8_t risePercent;        // ... or this share of the baseline RTT, if larger
+        uint16_t errorRisePermille; // Failure-rate shift worth a warning
+        uint8_t alarmShifts;        // RTT CUSUM alarm level, in multiples of the shift
+        uint8_t alarmFailures;      // Error CUSUM alarm level, in failures beyond the baseline rate
+        uint8_t ewmaShift;          // Dashboard EWMA weight 1/2^n
+    };
+
+    struct Status {
+        uint16_t baselineRttMs;
+        uint16_t rttEwmaMs;
+        uint16_t baselineErrorPermille;
+        uint16_t errorEwmaPermille;
+        uint32_t reads;
+        uint8_t rttEvidencePercent;     // CUSUM as a share of the alarm level (capped at 200)
+        uint8_t errorEvidencePercent;
+        bool learning;
+        bool rttWarning;
+        bool errorWarning;
+    };
+
+    HealthMonitor();
+    explicit HealthMonitor(const Config& config);
+
+    static Config getDefaultConfig();
+
+    void reset();
+    void rebaseline(size_t slot);
+
+    void setCallback(HealthCallback callback, void* context) {
+        _callback = callback;
+        _callbackContext = context;
+    }
+
+    // Report one transaction; rttMs is ignored for failures
+    void onResult(size_t slot, bool success, uint32_t rttMs);
+
+    [[nodiscard]] bool hasWarning(size_t slot) const;
+    [[nodiscard]] Status getStatus(size_t slot) const;
+    [[nodiscard]] uint32_t getWarningCount() const noexcept { return _warnings; }
+
+private:
+    static constexpr int32_t Q = 16;    // RTT sums in Q4 milliseconds
+
+    struct Entry {
+        uint32_t reads;
+        uint32_t successes;
+        uint32_t learnRttSumQ4;
+        uint16_t learnFailures;
+        int32_t baselineRttQ4;
+        uint16_t baselineErrorPermille;
+        int32_t rttEwmaQ4;
+        int32_t errorEwmaQ4;        // Permille, Q4
+        int32_t rttCusumQ4;
+        int32_t errorCusum;         // Permille
+        bool learned;
+        bool rttWarning;
+        bool errorWarning;
+    };
+
+    int32_t rttShiftQ4(const Entry& entry) const;
+    void raise(size_t slot, bool& flag, HealthWarning warning, bool raised);
+
+    Config _config;
+    Entry _entries[MAX_SLOTS];
+    HealthCallback _callback;
+    void* _callbackContext;
+    uint32_t _warnings;
+};
+
+} // namespace andrtf3
+
+#endif // ANDRTF3_HEALTH_H
@@ -0,0 +1,669 @@
+/*
+ * ANDRTF3History.cpp - part of the ESP32-ANDRTF3 library
+ *
+ * Copyright (C) 2025-2026 packerlschupfer
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "ANDRTF3History.h"
+#include "ANDRTF3Logging.h"
+#include <string.h>
+
+#if defined(__linux__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace andrtf3 {
+
+namespace history {
+
+uint32_t commitChecksum(const CommitSlot& slot) {
+    // FNV-1a over the fields that matter, seeded with the magic
+    uint32_t hash = 2166136261u ^ MAGIC;
+    uint8_t bytes[12];
+    memcpy(bytes, &slot.records, 8);
+    memcpy(bytes + 8, &slot.sequence, 4);
+    for (size_t i = 0; i < sizeof(bytes); i++) {
+        hash ^= bytes[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+uint64_t committedRecords(const FileHeader& header) {
+    const CommitSlot* best = nullptr;
+    for (size_t i = 0; i < 2; i++) {
+        const CommitSlot& slot = header.commits[i];
+        if (slot.sequence == 0 || slot.checksum != commitChecksum(slot)) {
+            continue;  // Never written or torn
+        }
+        if (best == nullptr || slot.sequence > best->sequence) {
+            best = &slot;
+        }
+    }
+    return (best != nullptr) ? best->records : 0;
+}
+
+static uint32_t newestSequence(const FileHeader& header) {
+    uint32_t seq = 0;
+    for (size_t i = 0; i < 2; i++) {
+        const CommitSlot& slot = header.commits[i];
+        if (slot.sequence > seq && slot.checksum == commitChecksum(slot)) {
+            seq = slot.sequence;
+        }
+    }
+    return seq;
+}
+
+} // namespace history
+
+#if defined(__linux__)
+
+using namespace history;
+
+// ========== HistoryWriter ==========
+
+HistoryWriter::HistoryWriter()
+    : _fd(-1),
+      _header{},
+      _records(0),
+      _committed(0),
+      _sequence(0),
+      _lastTimestamp(0),
+      _blockDirty(false),
+      _block{} {
+}
+
+HistoryWriter::~HistoryWriter() {
+    close();
+}
+
+bool HistoryWriter::open(const char* path, uint32_t busId) {
+    close();
+    if (path == nullptr) {
+        return false;
+    }
+
+    _fd = ::open(path, O_RDWR | O_CREAT, 0644);
+    if (_fd < 0) {
+        ANDRTF3_LOG_E("History: cannot open %s", path);
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(_fd, &st) != 0) {
+        close();
+        return false;
+    }
+
+    memset(_block, 0, sizeof(_block));
+
+    if (st.st_size == 0) {
+        // New file: header page only
+        _header = FileHeader{};
+        _header.magic = MAGIC;
+        _header.version = VERSION;
+        _header.recordBytes = sizeof(Record);
+        _header.blockBytes = BLOCK_BYTES;
+        _header.recordsPerBlock = RECORDS_PER_BLOCK;
+        _header.busId = busId;
+
+        uint8_t page[BLOCK_BYTES] = {};
+        memcpy(page, &_header, sizeof(_header));
+        if (pwrite(_fd, page, sizeof(page), 0) != static_cast<ssize_t>(sizeof(page)) || fsync(_fd) != 0) {
+            ANDRTF3_LOG_E("History: cannot initialize %s", path);
+            close();
+            return false;
+        }
+        return true;
+    }
+
+    if (pread(_fd, &_header, sizeof(_header), 0) != static_cast<ssize_t>(sizeof(_header)) ||
+        _header.magic != MAGIC || _header.version != VERSION ||
+        _header.recordBytes != sizeof(Record) || _header.blockBytes != BLOCK_BYTES ||
+        _header.recordsPerBlock != RECORDS_PER_BLOCK) {
+        ANDRTF3_LOG_E("History: %s is not a v%u history file", path, static_cast<unsigned>(VERSION));
+        close();
+        return false;
+    }
+    if (_header.busId != busId) {
+        ANDRTF3_LOG_W("History: %s belongs to bus %lu", path, static_cast<unsigned long>(_header.busId));
+    }
+
+    // Recover: everything past the last commit is discarded
+    _committed = committedRecords(_header);
+    _records = _committed;
+    _sequence = newestSequence(_header);
+
+    size_t usedBlocks = static_cast<size_t>((_committed + RECORDS_PER_BLOCK - 1) / RECORDS_PER_BLOCK);
+    if (ftruncate(_fd, static_cast<off_t>(blockOffset(usedBlocks))) != 0) {
+        ANDRTF3_LOG_W("History: cannot trim uncommitted tail of %s", path);
+    }
+
+    if (_committed > 0) {
+        size_t last = usedBlocks - 1;
+        size_t inBlock = static_cast<size_t>(_committed - static_cast<uint64_t>(last) * RECORDS_PER_BLOCK);
+        if (pread(_fd, _block, sizeof(_block), static_cast<off_t>(blockOffset(last))) !=
+            static_cast<ssize_t>(sizeof(_block))) {
+            close();
+            return false;
+        }
+        Record* records = reinterpret_cast<Record*>(_block + sizeof(BlockHeader));
+        _lastTimestamp = records[inBlock - 1].timestamp;
+
+        if (inBlock < RECORDS_PER_BLOCK) {
+            // Continue the partial block; drop any uncommitted records in it
+            memset(&records[inBlock], 0, (RECORDS_PER_BLOCK - inBlock) * sizeof(Record));
+            BlockHeader* bh = reinterpret_cast<BlockHeader*>(_block);
+            bh->count = static_cast<uint32_t>(inBlock);
+            bh->lastTimestamp = _lastTimestamp;
+        } else {
+            memset(_block, 0, sizeof(_block));
+        }
+    }
+
+    ANDRTF3_LOG_I("History: %s opened with %llu records", path,
+                  static_cast<unsigned long long>(_committed));
+    return true;
+}
+
+void HistoryWriter::close() {
+    if (_fd >= 0) {
+        ::close(_fd);
+    }
+    _fd = -1;
+    _records = 0;
+    _committed = 0;
+    _sequence = 0;
+    _lastTimestamp = 0;
+    _blockDirty = false;
+}
+
+bool HistoryWriter::append(uint32_t timestamp, uint8_t address, int16_t celsius, bool valid) {
+    if (_fd < 0 || timestamp < _lastTimestamp) {
+        return false;
+    }
+
+    size_t index = static_cast<size_t>(_records % RECORDS_PER_BLOCK);
+    if (index == 0) {
+        // Previous block is full: write it out and start a new one
+        if (_blockDirty && !flushBlock()) {
+            return false;
+        }
+        memset(_block, 0, sizeof(_block));
+    }
+
+    BlockHeader* bh = reinterpret_cast<BlockHeader*>(_block);
+    Record* records = reinterpret_cast<Record*>(_block + sizeof(BlockHeader));
+    records[index] = Record{ timestamp, address, static_cast<uint8_t>(valid ? FLAG_VALID : 0), celsius };
+    if (index == 0) {
+        bh->firstTimestamp = timestamp;
+    }
+    bh->lastTimestamp = timestamp;
+    bh->count = static_cast<uint32_t>(index + 1);
+
+    _records++;
+    _lastTimestamp = timestamp;
+    _blockDirty = true;
+    return true;
+}
+
+bool HistoryWriter::flushBlock() {
+    size_t block = static_cast<size_t>((_records - 1) / RECORDS_PER_BLOCK);
+    if (pwrite(_fd, _block, sizeof(_block), static_cast<off_t>(blockOffset(block))) !=
+        static_cast<ssize_t>(sizeof(_block))) {
+        ANDRTF3_LOG_E("History: block %u write failed", static_cast<unsigned>(block));
+        return false;
+    }
+    _blockDirty = false;
+    return true;
+}
+
+bool HistoryWriter::commit(bool sync) {
+    if (_fd < 0) {
+        return false;
+    }
+    if (_records == _committed) {
+        return true;
+    }
+    if (_blockDirty && !flushBlock()) {
+        return false;
+    }
+    // Data must be durable before the marker that makes it visible
+    if (sync && fdatasync(_fd) != 0) {
+        return false;
+    }
+
+    CommitSlot slot;
+    slot.records = _records;
+    slot.sequence = _sequence + 1;
+    slot.checksum = commitChecksum(slot);
+    size_t which = slot.sequence & 1u;  // Alternate so a torn write leaves the other slot intact
+    off_t offset = static_cast<off_t>(offsetof(FileHeader, commits) + which * sizeof(CommitSlot));
+    if (pwrite(_fd, &slot, sizeof(slot), offset) != static_cast<ssize_t>(sizeof(slot))) {
+        return false;
+    }
+    if (sync && fdatasync(_fd) != 0) {
+        return false;
+    }
+
+    _header.commits[which] = slot;
+    _sequence = slot.sequence;
+    _committed = _records;
+    return true;
+}
+
+// ========== HistoryReader ==========
+
+HistoryReader::HistoryReader()
+    : _fd(-1),
+      _map(nullptr),
+      _mapBytes(0),
+      _records(0) {
+}
+
+HistoryReader::~HistoryReader() {
+    close();
+}
+
+bool HistoryReader::open(const char* path) {
+    close();
+    if (path == nullptr) {
+        return false;
+    }
+    _fd = ::open(path, O_RDONLY);
+    if (_fd < 0) {
+        return false;
+    }
+    if (!refresh()) {
+        close();
+        return false;
+    }
+    const FileHeader* header = reinterpret_cast<const FileHeader*>(_map);
+    if (header->magic != MAGIC || header->version != VERSION ||
+        header->recordBytes != sizeof(Record) || header->blockBytes != BLOCK_BYTES) {
+        ANDRTF3_LOG_W("History: %s is not a v%u history file", path, static_cast<unsigned>(VERSION));
+        close();
+        return false;
+    }
+    return true;
+}
+
+void HistoryReader::close() {
+    if (_map != nullptr) {
+        munmap(const_cast<uint8_t*>(_map), _mapBytes);
+    }
+    if (_fd >= 0) {
+        ::close(_fd);
+    }
+    _fd = -1;
+    _map = nullptr;
+    _mapBytes = 0;
+    _records = 0;
+}
+
+bool HistoryReader::refresh() {
+    if (_fd < 0) {
+        return false;
+    }
+    struct stat st;
+    if (fstat(_fd, &st) != 0 || static_cast<size_t>(st.st_size) < BLOCK_BYTES) {
+        return false;
+    }
+
+    size_t bytes = static_cast<size_t>(st.st_size);
+    if (bytes != _mapBytes) {
+        void* map = mmap(nullptr, bytes, PROT_READ, MAP_SHARED, _fd, 0);
+        if (map == MAP_FAILED) {
+            return false;
+        }
+        if (_map != nullptr) {
+            munmap(const_cast<uint8_t*>(_map), _mapBytes);
+        }
+        _map = static_cast<const uint8_t*>(map);
+        _mapBytes = bytes;
+    }
+
+    // Only committed records that are actually mapped
+    uint64_t committed = committedRecords(*reinterpret_cast<const FileHeader*>(_map));
+    uint64_t mapped = static_cast<uint64_t>(_mapBytes / BLOCK_BYTES - 1) * RECORDS_PER_BLOCK;
+    _records = (committed < mapped) ? committed : mapped;
+    return true;
+}
+
+size_t HistoryReader::getBlockCount() const noexcept {
+    return static_cast<size_t>((_records + RECORDS_PER_BLOCK - 1) / RECORDS_PER_BLOCK);
+}
+
+uint32_t HistoryReader::getBusId() const {
+    return (_map != nullptr) ? reinterpret_cast<const FileHeader*>(_map)->busId : 0;
+}
+
+const BlockHeader* HistoryReader::block(size_t index) const {
+    return reinterpret_cast<const BlockHeader*>(_map + blockOffset(index));
+}
+
+const Record* HistoryReader::blockRecords(size_t index, size_t& count) const {
+    count = 0;
+    if (index >= getBlockCount()) {
+        return nullptr;
+    }
+    // Count from the commit, not the block header: a torn rewrite of the
+    // last block may leave its header ahead of the committed records
+    uint64_t before = static_cast<uint64_t>(index) * RECORDS_PER_BLOCK;
+    uint64_t remaining = _records - before;
+    count = static_cast<size_t>(remaining < RECORDS_PER_BLOCK ? remaining : RECORDS_PER_BLOCK);
+    return reinterpret_cast<const Record*>(_map + blockOffset(index) + sizeof(BlockHeader));
+}
+
+size_t HistoryReader::findBlock(uint32_t timestamp) const {
+    // First block whose firstTimestamp >= timestamp; the one before it may
+    // still hold records at or after timestamp in its tail
+    size_t lo = 0;
+    size_t hi = getBlockCount();
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (block(mid)->firstTimestamp < timestamp) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return (lo > 0) ? lo - 1 : 0;
+}
+
+size_t HistoryReader::scan(uint32_t from, uint32_t to,
+                           void (*visit)(const Record& record, void* context), void* context) const {
+    size_t visited = 0;
+    size_t blocks = getBlockCount();
+    for (size_t b = findBlock(from); b < blocks; b++) {
+        size_t count;
+        const Record* records = blockRecords(b, count);
+        for (size_t i = 0; i < count; i++) {
+            if (records[i].timestamp >= to) {
+                return visited;
+            }
+            if (records[i].timestamp >= from) {
+                if (visit != nullptr) {
+                    visit(records[i], context);
+                }
+                visited++;
+            }
+        }
+    }
+    return visited;
+}
+
+// ========== Downsampling ==========
+
+namespace {
+
+// Marks a bucket with no readings in the output array
+constexpr int16_t EMPTY_BUCKET = INT16_MIN;
+
+struct DownsampleState {
+    uint8_t address;
+    uint32_t from;
+    uint64_t span;
+    size_t buckets;
+    history::ChartPoint* out;
+    size_t maxPoints;
+    size_t count;               // Matching readings seen
+
+    // Pass 1 (LTTB): per-bucket sums, flushed into out[] as averages
+    size_t sumBucket;
+    int64_t sumTime;
+    int64_t sumValue;
+    uint32_t sumCount;
+
+    // Pass 2: selection within the current bucket
+    size_t bucket;
+    bool haveBest;
+    int64_t bestArea;
+    history::ChartPoint best;
+    bool haveAnchor;            // False until the first populated bucket closes
+    history::ChartPoint anchor; // Point selected in the previous bucket
+    history::ChartPoint other;  // MIN_MAX: second extreme
+};
+
+bool matches(const history::Record& record, const DownsampleState& state) {
+    return record.address == state.address && (record.flags & history::FLAG_VALID) != 0;
+}
+
+size_t bucketOf(uint32_t timestamp, const DownsampleState& state) {
+    size_t b = static_cast<size_t>((static_cast<uint64_t>(timestamp - state.from) * state.buckets) / state.span);
+    return (b < state.buckets) ? b : state.buckets - 1;
+}
+
+void flushAverage(DownsampleState& state) {
+    if (state.sumCount > 0) {
+        history::ChartPoint& average = state.out[state.sumBucket];
+        average.timestamp = state.from + static_cast<uint32_t>(state.sumTime / state.sumCount);
+        average.celsius = static_cast<int16_t>(state.sumValue / state.sumCount);
+    }
+    state.sumTime = 0;
+    state.sumValue = 0;
+    state.sumCount = 0;
+}
+
+void countAndAverage(const history::Record& record, void* context) {
+    DownsampleState& state = *static_cast<DownsampleState*>(context);
+    if (!matches(record, state)) {
+        return;
+    }
+    if (state.count < state.maxPoints) {
+        // Kept verbatim if the range turns out to fit
+        state.out[state.count].timestamp = record.timestamp;
+        state.out[state.count].celsius = record.celsius;
+    }
+    state.count++;
+}
+
+void accumulateAverage(const history::Record& record, void* context) {
+    DownsampleState& state = *static_cast<DownsampleState*>(context);
+    if (!matches(record, state)) {
+        return;
+    }
+    size_t b = bucketOf(record.timestamp, state);
+    if (b != state.sumBucket) {
+        flushAverage(state);
+        state.sumBucket = b;
+    }
+    state.sumTime += record.timestamp - state.from;
+    state.sumValue += record.celsius;
+    state.sumCount++;
+}
+
+// Average of the next bucket that has readings, or nullptr
+const history::ChartPoint* nextAverage(const DownsampleState& state, size_t bucket) {
+    for (size_t b = bucket + 1; b < state.buckets; b++) {
+        if (state.out[b].celsius != EMPTY_BUCKET) {
+            return &state.out[b];
+        }
+    }
+    return nullptr;
+}
+
+void closeLttbBucket(DownsampleState& state) {
+    if (state.haveBest) {
+        state.out[state.bucket] = state.best;
+        state.anchor = state.best;
+        state.haveAnchor = true;
+    }
+    state.haveBest = false;
+    state.bestArea = -1;
+}
+
+void selectLttb(const history::Record& record, void* context) {
+    DownsampleState& state = *static_cast<DownsampleState*>(context);
+    if (!matches(record, state)) {
+        return;
+    }
+    size_t b = bucketOf(record.timestamp, state);
+    if (b != state.bucket) {
+        closeLttbBucket(state);
+        state.bucket = b;
+    }
+
+    history::ChartPoint point = { record.timestamp, record.celsius };
+    if (!state.haveAnchor) {
+        // First populated bucket keeps the first reading; the range may start
+        // before the data, so that need not be bucket 0
+        if (!state.haveBest) {
+            state.best = point;
+            state.haveBest = true;
+        }
+        return;
+    }
+
+    const history::ChartPoint* next = nextAverage(state, b);
+    if (next == nullptr) {
+        // Last populated bucket keeps the last reading
+        state.best = point;
+        state.haveBest = true;
+        return;
+    }
+
+    // Twice the triangle (anchor, point, next average), times relative to from
+    int64_t ax = state.anchor.timestamp - state.from;
+    int64_t px = point.timestamp - state.from;
+    int64_t cx = next->timestamp - state.from;
+    int64_t area = (ax - cx) * (point.celsius - state.anchor.celsius) -
+                   (ax - px) * (next->celsius - state.anchor.celsius);
+    if (area < 0) {
+        area = -area;
+    }
+    if (area > state.bestArea) {
+        state.bestArea = area;
+        state.best = point;
+        state.haveBest = true;
+    }
+}
+
+void closeMinMaxBucket(DownsampleState& state) {
+    if (!state.haveBest) {
+        return;
+    }
+    // Extremes in time order; a flat bucket contributes one point
+    const history::ChartPoint& lo = state.best;
+    const history::ChartPoint& hi = state.other;
+    if (lo.timestamp == hi.timestamp && lo.celsius == hi.celsius) {
+        state.out[state.count++] = lo;
+    } else if (lo.timestamp <= hi.timestamp) {
+        state.out[state.count++] = lo;
+        state.out[state.count++] = hi;
+    } else {
+        state.out[state.count++] = hi;
+        state.out[state.count++] = lo;
+    }
+    state.haveBest = false;
+}
+
+void selectMinMax(const history::Record& record, void* context) {
+    DownsampleState& state = *static_cast<DownsampleState*>(context);
+    if (!matches(record, state)) {
+        return;
+    }
+    size_t b = bucketOf(record.timestamp, state);
+    if (b != state.bucket) {
+        closeMinMaxBucket(state);
+        state.bucket = b;
+    }
+
+    history::ChartPoint point = { record.timestamp, record.celsius };
+    if (!state.haveBest) {
+        state.best = point;     // Minimum
+        state.other = point;    // Maximum
+        state.haveBest = true;
+        return;
+    }
+    if (point.celsius < state.best.celsius) {
+        state.best = point;
+    }
+    if (point.celsius > state.other.celsius) {
+        state.other = point;
+    }
+}
+
+} // namespace
+
+size_t HistoryReader::downsample(uint8_t address, uint32_t from, uint32_t to, history::Downsample method,
+                                 history::ChartPoint* out, size_t maxPoints) const {
+    if (out == nullptr || maxPoints == 0 || to <= from) {
+        return 0;
+    }
+    if (method == history::Downsample::MIN_MAX && maxPoints < 2) {
+        return 0;   // A bucket can emit two points
+    }
+
+    DownsampleState state;
+    memset(&state, 0, sizeof(state));
+    state.address = address;
+    state.from = from;
+    state.span = static_cast<uint64_t>(to) - from;
+    state.out = out;
+    state.maxPoints = maxPoints;
+
+    // Pass 1: count, and keep the readings in case they all fit
+    scan(from, to, countAndAverage, &state);
+    if (state.count <= maxPoints) {
+        return state.count;
+    }
+
+    if (method == history::Downsample::MIN_MAX) {
+        state.buckets = maxPoints / 2;
+        state.count = 0;
+        state.bucket = 0;
+        state.haveBest = false;
+        scan(from, to, selectMinMax, &state);
+        closeMinMaxBucket(state);
+        return state.count;
+    }
+
+    // LTTB pass 1b: bucket averages into out[] (empty buckets marked)
+    state.buckets = maxPoints;
+    for (size_t b = 0; b < state.buckets; b++) {
+        out[b].timestamp = 0;
+        out[b].celsius = EMPTY_BUCKET;
+    }
+    state.sumBucket = 0;
+    scan(from, to, accumulateAverage, &state);
+    flushAverage(state);
+
+    // Pass 2: pick one point per bucket; out[b + 1...] still holds averages
+    state.bucket = 0;
+    state.haveBest = false;
+    state.haveAnchor = false;
+    state.bestArea = -1;
+    scan(from, to, selectLttb, &state);
+    closeLttbBucket(state);
+
+    size_t written = 0;
+    for (size_t b = 0; b < state.buckets; b++) {
+        if (out[b].celsius != EMPTY_BUCKET) {
+            out[written++] = out[b];
+        }
+    }
+    return written;
+}
+
+#endif // __linux__
+
+} // namespace andrtf3
@@ -0,0 +1,235 @@
+/*
+ * ANDRTF3History.h - part of the ESP32-ANDRTF3 library
+ *
+ * Copyright (C) 2025-2026 packerlschupfer
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+
+#ifndef ANDRTF3_HISTORY_H
+#define ANDRTF3_HISTORY_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+namespace andrtf3 {
+
+/**
+ * Append-only history file format (one file per bus)
+ *
+ * Layout, all little-endian and fixed-size so analytics tools can mmap() the
+ * file and index it directly:
+ *
+ *   [ FileHeader: 4096 bytes ][ Block 0: 4096 bytes ][ Block 1 ] ...
+ *
+ * Every block starts with a BlockHeader (time range and record count)
+ * followed by RECORDS_PER_BLOCK fixed 8-byte records in append order.
+ * Timestamps never decrease, so the block headers form a sparse index that
+ * is binary-searched by time.
+ *
+ * The file header holds two commit slots written alternately. A commit
+ * records how many records are durable. Readers and recovery use the valid
+ * slot with the higher sequence, and ignore anything past it: a crash mid-append
+ * or mid-commit loses at most the uncommitted tail.
+ */
+namespace history {
+
+static constexpr uint32_t MAGIC = 0x48465452;           // "RTFH"
+static constexpr uint16_t VERSION = 1;
+static constexpr size_t BLOCK_BYTES = 4096;
+
+struct Record {
+    uint32_t timestamp;         // Caller's clock (e.g. Unix seconds), non-decreasing
+    uint8_t address;
+    uint8_t flags;              // FLAG_VALID
+    int16_t celsius;            // Temperature * 10
+};
+
+static constexpr uint8_t FLAG_VALID = 0x01;
+
+struct BlockHeader {
+    uint32_t firstTimestamp;
+    uint32_t lastTimestamp;
+    uint32_t count;             // Records written to this block
+    uint32_t reserved;
+};
+
+static constexpr size_t RECORDS_PER_BLOCK = (BLOCK_BYTES - sizeof(BlockHeader)) / sizeof(Record);
+
+struct CommitSlot {
+    uint64_t records;           // Durable record count
+    uint32_t sequence;          // Higher wins; 0 = never written
+    uint32_t checksum;          // Over records + sequence
+};
+
+struct FileHeader {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t recordBytes;       // sizeof(Record), for tools
+    uint32_t blockBytes;
+    uint32_t recordsPerBlock;
+    uint32_t busId;
+    uint32_t reserved;
+    CommitSlot commits[2];
+};
+
+static_assert(sizeof(Record) == 8, "record layout is part of the file format");
+static_assert(sizeof(BlockHeader) + RECORDS_PER_BLOCK * sizeof(Record) <= BLOCK_BYTES, "block overflow");
+static_assert(sizeof(FileHeader) <= BLOCK_BYTES, "header overflow");
+
+// One point of a downsampled series
+struct ChartPoint {
+    uint32_t timestamp;
+    int16_t celsius;
+};
+
+enum class Downsample : uint8_t {
+    LTTB,                       // Largest-Triangle-Three-Buckets: one point per bucket, keeps shape
+    MIN_MAX                     // Minimum and maximum of each bucket: keeps every excursion
+};
+
+// Byte offset of block n in the file
+inline constexpr size_t blockOffset(size_t block) { return BLOCK_BYTES * (block + 1); }
+
+uint32_t commitChecksum(const CommitSlot& slot);
+
+// Committed record count from the newest valid slot (0 if none)
+uint64_t committedRecords(const FileHeader& header);
+
+} // namespace history
+
+#if defined(__linux__)
+
+/**
+ * History writer (one per bus file, single thread)
+ *
+ * append() buffers into the current block. commit() writes the dirty block,
+ * syncs it, and then publishes the new record count in the next commit slot.
+ * open() recovers the committed count after a crash and continues from there.
+ */
+class HistoryWriter {
+public:
+    HistoryWriter();
+    ~HistoryWriter();
+
+    HistoryWriter(const HistoryWriter&) = delete;
+    HistoryWriter& operator=(const HistoryWriter&) = delete;
+
+    // Open or create; an existing file must have the same format version
+    [[nodiscard]] bool open(const char* path, uint32_t busId);
+    void close();
+
+    /**
+     * @brief Append one reading (not durable until commit())
+     * @return false if not open or timestamp went backwards
+     */
+    bool append(uint32_t timestamp, uint8_t address, int16_t celsius, bool valid);
+
+    /**
+     * @brief Make all appended records durable
+     * @param sync fdatasync() data and header (false: rely on page cache ordering)
+     */
+    bool commit(bool sync = true);
+
+    [[nodiscard]] uint64_t getRecordCount() const noexcept { return _records; }
+    [[nodiscard]] uint64_t getCommittedCount() const noexcept { return _committed; }
+
+private:
+    bool flushBlock();
+
+    int _fd;
+    history::FileHeader _header;
+    uint64_t _records;          // Appended (including uncommitted)
+    uint64_t _committed;
+    uint32_t _sequence;
+    uint32_t _lastTimestamp;
+    bool _blockDirty;
+    alignas(8) uint8_t _block[history::BLOCK_BYTES];   // Current (last) block
+};
+
+/**
+ * Read-only memory-mapped view of a history file
+ *
+ * Safe to use while a writer appends in another process: only committed
+ * records are visible, and refresh() picks up newer commits.
+ */
+class HistoryReader {
+public:
+    HistoryReader();
+    ~HistoryReader();
+
+    HistoryReader(const HistoryReader&) = delete;
+    HistoryReader& operator=(const HistoryReader&) = delete;
+
+    [[nodiscard]] bool open(const char* path);
+    void close();
+
+    // Remap if the writer committed more records since open()/last refresh()
+    bool refresh();
+
+    [[nodiscard]] uint64_t getRecordCount() const noexcept { return _records; }
+    [[nodiscard]] size_t getBlockCount() const noexcept;
+    [[nodiscard]] uint32_t getBusId() const;
+
+    /**
+     * @brief Records of one block (committed part only)
+     * @param count receives the number of records
+     * @return pointer into the mapping, or nullptr
+     */
+    [[nodiscard]] const history::Record* blockRecords(size_t block, size_t& count) const;
+
+    // First block that may contain records with timestamp >= t
+    [[nodiscard]] size_t findBlock(uint32_t timestamp) const;
+
+    /**
+     * @brief Visit every committed record with from <= timestamp < to
+     *
+     * Non-capturing callback to keep this usable from C-style tools.
+     * @return number of records visited
+     */
+    size_t scan(uint32_t from, uint32_t to,
+                void (*visit)(const history::Record& record, void* context), void* context) const;
+
+    /**
+     * @brief Chart-ready series of one sensor's valid readings in [from, to)
+     *
+     * Splits the range into equal time buckets and keeps at most maxPoints
+     * points (LTTB: one per bucket; MIN_MAX: the extremes of each bucket in
+     * time order). Ranges with no more than maxPoints readings are returned
+     * as-is. Runs over the mapped blocks in two streaming passes; the only
+     * working memory is out itself.
+     *
+     * @return number of points written to out (time-ordered); 0 for MIN_MAX
+     *         with maxPoints < 2
+     */
+    size_t downsample(uint8_t address, uint32_t from, uint32_t to, history::Downsample method,
+                      history::ChartPoint* out, size_t maxPoints) const;
+
+private:
+    const history::BlockHeader* block(size_t index) const;
+
+    int _fd;
+    const uint8_t* _map;
+    size_t _mapBytes;
+    uint64_t _records;
+};
+
+#endif // __linux__
+
+} // namespace andrtf3
+
+#endif // ANDRTF3_HISTORY_H
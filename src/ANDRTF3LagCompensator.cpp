@@ -0,0 +1,234 @@
+/*
+ * ANDRTF3LagCompensator.cpp - part of the ESP32-ANDRTF3 library
+ *
+ * Copyright (C) 2025-2026 packerlschupfer
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "ANDRTF3LagCompensator.h"
+#include "ANDRTF3Logging.h"
+
+namespace andrtf3 {
+
+static int16_t clamp16(int32_t v) {
+    return static_cast<int16_t>(v > INT16_MAX ? INT16_MAX : (v < INT16_MIN ? INT16_MIN : v));
+}
+
+static int32_t abs32(int32_t v) {
+    return v < 0 ? -v : v;
+}
+
+LagCompensator::LagCompensator()
+    : LagCompensator(getDefaultConfig()) {
+}
+
+LagCompensator::LagCompensator(const Config& config)
+    : _config(config) {
+    if (_config.windowSamples < 2) {
+        _config.windowSamples = 2;
+    }
+    if (_config.windowSamples > MAX_WINDOW) {
+        _config.windowSamples = MAX_WINDOW;
+    }
+    reset();
+}
+
+LagCompensator::Config LagCompensator::getDefaultConfig() {
+    return {
+        300,        // tauSeconds (typical wall-box PT1000, replaced by the first learned step)
+        12,         // windowSamples (60 s at a 5 s poll)
+        30,         // maxCorrection (3.0°C)
+        2,          // noiseDeadband (0.2°C)
+        5,          // stepThreshold (0.5°C from the quiet baseline)
+        120000,     // settleMs
+        10,         // minTauSeconds
+        3600,       // maxTauSeconds
+        true        // learnTau
+    };
+}
+
+void LagCompensator::reset() {
+    _windowCount = 0;
+    _windowHead = 0;
+    _stepCount = 0;
+    _stepStride = 1;
+    _stepSkip = 0;
+    _stepStart = 0;
+    _baseline = { 0, 0 };
+    _quietRef = 0;
+    _quietSinceMs = 0;
+    _inStep = false;
+    _slopeQ8 = 0;
+    _raw = 0;
+    _compensated = 0;
+    _tauSeconds = _config.tauSeconds;
+    _steps = 0;
+}
+
+int16_t LagCompensator::update(int16_t raw, uint32_t nowMs) {
+    // Slide the window (oldest sample at _windowHead)
+    const size_t size = _config.windowSamples;
+    if (_windowCount < size) {
+        _window[(_windowHead + _windowCount) % size] = { nowMs, raw };
+        _windowCount++;
+    } else {
+        _window[_windowHead] = { nowMs, raw };
+        _windowHead = (_windowHead + 1) % size;
+    }
+    _raw = raw;
+
+    const Sample& oldest = _window[_windowHead];
+    int32_t change = static_cast<int32_t>(raw) - oldest.value;
+    uint32_t spanMs = nowMs - oldest.ms;
+
+    _slopeQ8 = (spanMs > 0)
+        ? static_cast<int32_t>((static_cast<int64_t>(change) * 256 * 1000) / spanMs) : 0;
+
+    // Tair - Ts = tau * dTs/dt, limited to keep quantization noise out
+    int32_t correction = static_cast<int32_t>((static_cast<int64_t>(_tauSeconds) * _slopeQ8) / 256);
+    if (abs32(correction) <= _config.noiseDeadband) {
+        correction = 0;
+    } else if (correction > _config.maxCorrection) {
+        correction = _config.maxCorrection;
+    } else if (correction < -_config.maxCorrection) {
+        correction = -_config.maxCorrection;
+    }
+    _compensated = clamp16(static_cast<int32_t>(raw) + correction);
+
+    if (!_config.learnTau) {
+        return _compensated;
+    }
+
+    if (!_inStep) {
+        int32_t offset = static_cast<int32_t>(raw) - _baseline.value;
+        if (_stepCount == 0 || abs32(offset) <= _config.noiseDeadband) {
+            // Quiet: restart the capture from here. The baseline value only
+            // moves after a finished step, so a slow response cannot creep it.
+            _baseline.ms = nowMs;
+            if (_stepCount == 0) {
+                _baseline.value = raw;
+            }
+            _stepCount = 0;
+            _stepStride = 1;
+            _stepSkip = 0;
+            pushStepSample(_baseline);
+            return _compensated;
+        }
+        pushStepSample({ nowMs, raw });
+        if (abs32(offset) >= _config.stepThreshold) {
+            _inStep = true;
+            _stepStart = _baseline.value;
+            _quietRef = raw;
+            _quietSinceMs = nowMs;
+        }
+        return _compensated;
+    }
+
+    // Settled once the reading holds within the deadband for settleMs or
+    // two time constants, whichever is longer (slow tails creep)
+    pushStepSample({ nowMs, raw });
+    uint32_t holdMs = static_cast<uint32_t>(_tauSeconds) * 2000u;
+    if (holdMs < _config.settleMs) {
+        holdMs = _config.settleMs;
+    }
+    if (abs32(static_cast<int32_t>(raw) - _quietRef) > _config.noiseDeadband) {
+        _quietRef = raw;
+        _quietSinceMs = nowMs;
+    } else if (nowMs - _quietSinceMs >= holdMs) {
+        finishStep();
+    }
+    if (_inStep && nowMs - _step[0].ms > static_cast<uint32_t>(_config.maxTauSeconds) * 10000u) {
+        _inStep = false;  // Never settled (drift, not a step)
+        _stepCount = 0;
+    }
+    return _compensated;
+}
+
+void LagCompensator::pushStepSample(const Sample& s) {
+    if (++_stepSkip < _stepStride) {
+        return;
+    }
+    _stepSkip = 0;
+
+    if (_stepCount == STEP_BUFFER) {
+        // Halve the time resolution to cover longer responses
+        for (size_t i = 0; i < STEP_BUFFER / 2; i++) {
+            _step[i] = _step[i * 2];
+        }
+        _stepCount = STEP_BUFFER / 2;
+        if (_stepStride < 128) {
+            _stepStride *= 2;
+        }
+    }
+    _step[_stepCount++] = s;
+}
+
+void LagCompensator::finishStep() {
+    _inStep = false;
+    size_t count = _stepCount;
+    _stepCount = 0;
+    if (count < 3) {
+        return;
+    }
+
+    int32_t finalValue = _step[count - 1].value;
+    if (abs32(finalValue - _stepStart) < _config.stepThreshold) {
+        return;  // Came back: a disturbance, not a step
+    }
+
+    // During a step response dTs/dt = (Tair - Ts) / tau, so the slope is a
+    // line in the level with gradient -1/tau. Least-squares fit over slopes
+    // taken k samples apart (k spreads each slope over several LSBs), with
+    // y = slope in deci/s * 1000 and x = 2 * mid-level: tau = -500 / gradient.
+    size_t k = count / 8;
+    if (k < 1) {
+        k = 1;
+    }
+    int64_t n = 0, sx = 0, sy = 0, sxx = 0, sxy = 0;
+    for (size_t i = k; i < count; i++) {
+        uint32_t dt = _step[i].ms - _step[i - k].ms;
+        if (dt == 0) {
+            continue;
+        }
+        int64_t x = static_cast<int64_t>(_step[i].value) + _step[i - k].value;
+        int64_t y = (static_cast<int64_t>(_step[i].value - _step[i - k].value) * 1000000) / dt;
+        n++;
+        sx += x;
+        sy += y;
+        sxx += x * x;
+        sxy += x * y;
+    }
+    int64_t varX = n * sxx - sx * sx;
+    int64_t covXY = n * sxy - sx * sy;
+    if (n < 3 || varX <= 0 || covXY >= 0) {
+        return;  // No usable spread, or not decaying toward a level
+    }
+
+    uint32_t estimate = static_cast<uint32_t>((-500 * varX) / covXY);
+    if (estimate < _config.minTauSeconds) estimate = _config.minTauSeconds;
+    if (estimate > _config.maxTauSeconds) estimate = _config.maxTauSeconds;
+
+    // First observation replaces the configured guess, later ones blend in
+    _tauSeconds = (_steps == 0) ? static_cast<uint16_t>(estimate)
+                                : static_cast<uint16_t>((3u * _tauSeconds + estimate) / 4u);
+    _steps++;
+    ANDRTF3_LOG_D("Lag: step %d -> %d, tau estimate %lu s, tau %u s",
+                  _stepStart, static_cast<int>(finalValue), static_cast<unsigned long>(estimate),
+                  static_cast<unsigned>(_tauSeconds));
+}
+
+} // namespace andrtf3
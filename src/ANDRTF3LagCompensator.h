@@ -0,0 +1,129 @@
+/*
+ * ANDRTF3LagCompensator.h - part of the ESP32-ANDRTF3 library
+ *
+ * Copyright (C) 2025-2026 packerlschupfer
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+
+#ifndef ANDRTF3_LAG_COMPENSATOR_H
+#define ANDRTF3_LAG_COMPENSATOR_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+namespace andrtf3 {
+
+/**
+ * First-order inverse-lag compensator for enclosure thermal inertia
+ *
+ * A wall-mounted PT1000 follows the room air as a first-order lag:
+ * dTs/dt = (Tair - Ts) / tau. Inverting it gives Tair ≈ Ts + tau * dTs/dt.
+ * The slope is taken across a short window of readings, so the
+ * 0.1°C quantization does not turn into a correction on every LSB.
+ * Corrections within the noise deadband are dropped and the rest are clamped.
+ * All arithmetic is integer (deci-degrees, milliseconds, Q8 slopes).
+ *
+ * The time constant can be learned. When a reading moves stepThreshold
+ * away from the last quiet baseline, the response is recorded until it
+ * settles. Along that response the slope falls linearly with the level,
+ * with gradient -1/tau, so a least-squares fit of slope against level gives
+ * the estimate. The first estimate replaces the configured tau; later ones
+ * are blended in with weight 1/4.
+ *
+ * Example usage:
+ * @code
+ * LagCompensator lag;                 // tau 300 s until a step is observed
+ * sensor.setLagCompensator(&lag);
+ * int16_t air = sensor.getCompensatedTemperature();
+ * @endcode
+ */
+class LagCompensator {
+public:
+    static constexpr size_t MAX_WINDOW = 16;
+    static constexpr size_t STEP_BUFFER = 64;
+
+    struct Config {
+        uint16_t tauSeconds;        // Initial time constant (0 = no correction until learned)
+        uint8_t windowSamples;      // Readings in the slope window (2..MAX_WINDOW)
+        int16_t maxCorrection;      // Clamp, deci-degrees
+        int16_t noiseDeadband;      // |correction| and "settled" threshold, deci-degrees
+        int16_t stepThreshold;      // Departure from the quiet baseline that starts a step
+        uint32_t settleMs;          // Minimum quiet time that ends a step (at least 2 tau)
+        uint16_t minTauSeconds;     // Learned tau bounds
+        uint16_t maxTauSeconds;
+        bool learnTau;
+    };
+
+    LagCompensator();
+    explicit LagCompensator(const Config& config);
+
+    static Config getDefaultConfig();
+
+    void reset();
+
+    /**
+     * @brief Feed one valid reading
+     * @return compensated air temperature, deci-degrees
+     */
+    int16_t update(int16_t raw, uint32_t nowMs);
+
+    [[nodiscard]] int16_t getRaw() const noexcept { return _raw; }
+    [[nodiscard]] int16_t getCompensated() const noexcept { return _compensated; }
+    [[nodiscard]] int16_t getCorrection() const noexcept { return static_cast<int16_t>(_compensated - _raw); }
+    [[nodiscard]] uint16_t getTauSeconds() const noexcept { return _tauSeconds; }
+    [[nodiscard]] uint16_t getStepCount() const noexcept { return _steps; }
+    [[nodiscard]] bool isInStep() const noexcept { return _inStep; }
+
+    // Slope across the window, deci-degrees per second in Q8
+    [[nodiscard]] int32_t getSlopeQ8() const noexcept { return _slopeQ8; }
+
+private:
+    struct Sample {
+        uint32_t ms;
+        int16_t value;
+    };
+
+    void pushStepSample(const Sample& s);
+    void finishStep();
+
+    Config _config;
+    Sample _window[MAX_WINDOW];
+    size_t _windowCount;
+    size_t _windowHead;         // Index of the oldest sample
+
+    // Step capture for tau estimation (decimated when full)
+    Sample _step[STEP_BUFFER];
+    size_t _stepCount;
+    uint8_t _stepStride;
+    uint8_t _stepSkip;
+    int16_t _stepStart;
+    Sample _baseline;           // Last quiet reading; steps are measured from it
+    int16_t _quietRef;          // Settle detection reference
+    uint32_t _quietSinceMs;
+    bool _inStep;
+
+    int32_t _slopeQ8;
+    int16_t _raw;
+    int16_t _compensated;
+    uint16_t _tauSeconds;
+    uint16_t _steps;
+};
+
+} // namespace andrtf3
+
+#endif // ANDRTF3_LAG_COMPENSATOR_H
@@ -0,0 +1,155 @@
+/*
+ * ANDRTF3LocalBus.cpp - part of the ESP32-ANDRTF3 library
+ *
+ * Copyright (C) 2025-2026 packerlschupfer
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+
+#include "ANDRTF3LocalBus.h"
+
+#if defined(ESP_PLATFORM)
+
+#include "ANDRTF3Logging.h"
+
+namespace andrtf3 {
+
+namespace {
+
+constexpr uint8_t READ_INPUT_REGISTERS = 0x04;
+
+// esp32Modbus::Error values: Modbus exceptions 0x01-0x08, master errors from 0xE0
+ModbusError mapError(esp32Modbus::Error error) {
+    switch (static_cast<uint8_t>(error)) {
+        case 0x01: return ModbusError::ILLEGAL_FUNCTION;
+        case 0x02: return ModbusError::ILLEGAL_DATA_ADDRESS;
+        case 0x03: return ModbusError::ILLEGAL_DATA_VALUE;
+        case 0x04: return ModbusError::SLAVE_DEVICE_FAILURE;
+        case 0xE0: return ModbusError::TIMEOUT;
+        case 0xE3: return ModbusError::CRC_ERROR;
+        default:   return ModbusError::COMMUNICATION_ERROR;
+    }
+}
+
+} // namespace
+
+LocalBusTransport::LocalBusTransport(esp32ModbusRTU& master, uint16_t busId)
+    : _master(master),
+      _busId(busId),
+      _mutex(xSemaphoreCreateMutex()),
+      _eventGroup(xEventGroupCreate()),
+      _reg(0),
+      _count(0),
+      _out(nullptr),
+      _result(ModbusError::SUCCESS) {
+    if (_mutex == nullptr || _eventGroup == nullptr) {
+        ANDRTF3_LOG_E("LocalBusTransport: failed to create RTOS objects");
+    }
+}
+
+LocalBusTransport::~LocalBusTransport() {
+    if (_eventGroup != nullptr) {
+        vEventGroupDelete(_eventGroup);
+    }
+    if (_mutex != nullptr) {
+        vSemaphoreDelete(_mutex);
+    }
+}
+
+ModbusError LocalBusTransport::readInputRegisters(uint8_t unit, uint16_t reg, uint16_t count,
+                                                  uint16_t* out, uint32_t timeoutMs) {
+    if (unit == 0 || count == 0 || count > rtu::MAX_READ_REGISTERS || out == nullptr) {
+        return ModbusError::INVALID_PARAMETER;
+    }
+    if (_mutex == nullptr || _eventGroup == nullptr) {
+        return ModbusError::COMMUNICATION_ERROR;
+    }
+
+    xSemaphoreTake(_mutex, portMAX_DELAY);
+    _reg = reg;
+    _count = count;
+    _out = out;
+    _result = ModbusError::TIMEOUT;
+    xEventGroupClearBits(_eventGroup, DONE_BIT);
+    _unit.store(unit);
+
+    if (!_master.readInputRegisters(unit, reg, count)) {
+        _unit.store(0);
+        xSemaphoreGive(_mutex);
+        ANDRTF3_LOG_W("LocalBusTransport: master queue rejected unit %d", unit);
+        return ModbusError::COMMUNICATION_ERROR;
+    }
+
+    EventBits_t bits = xEventGroupWaitBits(_eventGroup, DONE_BIT, pdTRUE, pdTRUE,
+                                           pdMS_TO_TICKS(timeoutMs));
+    if ((bits & DONE_BIT) == 0) {
+        if (claim(unit)) {
+            // Nothing arrived: a late answer finds no request and is passed on
+            xSemaphoreGive(_mutex);
+            return ModbusError::TIMEOUT;
+        }
+        // The Modbus task claimed it just now; _out is being filled
+        xEventGroupWaitBits(_eventGroup, DONE_BIT, pdTRUE, pdTRUE, portMAX_DELAY);
+    }
+
+    ModbusError result = _result;
+    xSemaphoreGive(_mutex);
+    return result;
+}
+
+bool LocalBusTransport::handleData(uint8_t serverAddress, esp32Modbus::FunctionCode fc,
+                                   uint16_t address, const uint8_t* data, size_t length) {
+    // Loading _unit first makes the caller's _reg/_count/_out visible
+    if (_unit.load() != serverAddress || static_cast<uint8_t>(fc) != READ_INPUT_REGISTERS ||
+        address != _reg || !claim(serverAddress)) {
+        return false;
+    }
+    if (data == nullptr || length < static_cast<size_t>(_count) * 2) {
+        finish(ModbusError::INVALID_DATA_LENGTH);
+        return true;
+    }
+    for (uint16_t i = 0; i < _count; i++) {
+        _out[i] = static_cast<uint16_t>((data[2 * i] << 8) | data[2 * i + 1]);
+    }
+    finish(ModbusError::SUCCESS);
+    return true;
+}
+
+bool LocalBusTransport::handleError(uint16_t serverAddress, esp32Modbus::Error error) {
+    if (serverAddress > 0xFF || !claim(static_cast<uint8_t>(serverAddress))) {
+        return false;
+    }
+    finish(mapError(error));
+    return true;
+}
+
+bool LocalBusTransport::claim(uint8_t unit) {
+    if (unit == 0) {
+        return false;
+    }
+    uint8_t expected = unit;
+    return _unit.compare_exchange_strong(expected, 0);
+}
+
+void LocalBusTransport::finish(ModbusError result) {
+    _result = result;
+    xEventGroupSetBits(_eventGroup, DONE_BIT);
+}
+
+} // namespace andrtf3
+
+#endif // ESP_PLATFORM
@@ -0,0 +1,112 @@
+/*
+ * ANDRTF3LocalBus.h - part of the ESP32-ANDRTF3 library
+ *
+ * Copyright (C) 2025-2026 packerlschupfer
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+
+#ifndef ANDRTF3_LOCALBUS_H
+#define ANDRTF3_LOCALBUS_H
+
+#include "ANDRTF3Transport.h"
+
+#if defined(ESP_PLATFORM)
+
+#include <esp32ModbusRTU.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/event_groups.h>
+#include <freertos/semphr.h>
+#include <atomic>
+
+namespace andrtf3 {
+
+/**
+ * Transport over the local RS485 bus (ESP32)
+ *
+ * Gives ANDRTF3Bus (or ANDRTF3::setTransport()) the esp32ModbusRTU master
+ * the application already runs, without a ModbusDevice per sensor. Each
+ * call queues one request on the master and waits for its answer.
+ * esp32ModbusRTU reports answers through the application's onData/onError
+ * handlers, so those offer every frame to handleData()/handleError() first
+ * and pass on what this transport does not claim:
+ *
+ * @code
+ * LocalBusTransport localBus(modbusMaster);
+ * modbusMaster.onData([](uint8_t server, esp32Modbus::FunctionCode fc, uint16_t reg,
+ *                        const uint8_t* data, size_t length) {
+ *     if (!localBus.handleData(server, fc, reg, data, length)) {
+ *         mainHandleData(server, fc, reg, data, length);
+ *     }
+ * });
+ * modbusMaster.onError([](uint16_t server, esp32Modbus::Error error) {
+ *     if (!localBus.handleError(server, error)) handleError(0xFF, error);
+ * });
+ * ANDRTF3Bus bus(&localBus);
+ * @endcode
+ *
+ * Calls are serialized, one request outstanding at a time. timeoutMs counts
+ * from when the request is queued on the master. An answer that arrives
+ * after its call timed out is not claimed.
+ */
+class LocalBusTransport : public Transport {
+public:
+    // busId: RetainedState key; 0 (default) is the bus ANDRTF3 objects use
+    explicit LocalBusTransport(esp32ModbusRTU& master, uint16_t busId = 0);
+    ~LocalBusTransport() override;
+
+    LocalBusTransport(const LocalBusTransport&) = delete;
+    LocalBusTransport& operator=(const LocalBusTransport&) = delete;
+
+    const char* name() const override { return "local-rtu"; }
+    uint16_t busId() const override { return _busId; }
+
+    ModbusError readInputRegisters(uint8_t unit, uint16_t reg, uint16_t count,
+                                   uint16_t* out, uint32_t timeoutMs) override;
+
+    // From the master's onData handler; true if the frame answered this transport
+    bool handleData(uint8_t serverAddress, esp32Modbus::FunctionCode fc, uint16_t address,
+                    const uint8_t* data, size_t length);
+
+    // From the master's onError handler; true if the error ended this transport's request
+    bool handleError(uint16_t serverAddress, esp32Modbus::Error error);
+
+private:
+    static constexpr EventBits_t DONE_BIT = BIT0;
+
+    // Claim the outstanding request for unit (Modbus task or timed-out caller)
+    bool claim(uint8_t unit);
+    void finish(ModbusError result);
+
+    esp32ModbusRTU& _master;
+    uint16_t _busId;
+    SemaphoreHandle_t _mutex;       // One call at a time
+    EventGroupHandle_t _eventGroup;
+
+    // Outstanding request: set by the caller before _unit, read by the Modbus task
+    std::atomic<uint8_t> _unit{0};  // 0 = none
+    uint16_t _reg;
+    uint16_t _count;
+    uint16_t* _out;
+    ModbusError _result;
+};
+
+} // namespace andrtf3
+
+#endif // ESP_PLATFORM
+
+#endif // ANDRTF3_LOCALBUS_H
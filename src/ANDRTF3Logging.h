@@ -65,6 +65,16 @@
     #endif
 #endif
 
+// Logging on the response path: the format strings and esp_log live in flash,
+// so an ANDRTF3_IRAM_DECODE build compiles them out there
+#ifdef ANDRTF3_IRAM_DECODE
+    #define ANDRTF3_HOT_LOG_D(...) ((void)0)
+    #define ANDRTF3_HOT_LOG_V(...) ((void)0)
+#else
+    #define ANDRTF3_HOT_LOG_D(...) ANDRTF3_LOG_D(__VA_ARGS__)
+    #define ANDRTF3_HOT_LOG_V(...) ANDRTF3_LOG_V(__VA_ARGS__)
+#endif
+
 // Feature-specific debug helpers
 #ifdef ANDRTF3_DEBUG
     // Timing macros for performance debugging
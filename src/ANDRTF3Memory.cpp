@@ -0,0 +1,125 @@
+/*
+ * ANDRTF3Memory.cpp - part of the ESP32-ANDRTF3 library
+ *
+ * Copyright (C) 2025-2026 packerlschupfer
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+
+#include "ANDRTF3Memory.h"
+#include <stdlib.h>
+
+#if defined(ESP_PLATFORM)
+#include <esp_heap_caps.h>
+#if defined(ANDRTF3_IRAM_DECODE)
+#include <esp_idf_version.h>
+#if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 0, 0)
+#include <esp_private/cache_utils.h>   // spi_flash_cache_enabled() is private since IDF 5
+#else
+#include <esp_spi_flash.h>
+#endif
+#endif
+#else
+#include <atomic>
+#endif
+
+namespace andrtf3 {
+namespace memory {
+
+#if defined(ESP_PLATFORM)
+
+namespace {
+
+uint32_t capsFor(MemoryRegion region) {
+    switch (region) {
+        case MemoryRegion::INTERNAL: return MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT;
+        case MemoryRegion::PSRAM:    return MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT;
+        default:                     return MALLOC_CAP_DEFAULT;
+    }
+}
+
+} // namespace
+
+void* allocate(size_t bytes, MemoryRegion region, MemoryRegion* placed) {
+    void* block = heap_caps_malloc(bytes, capsFor(region));
+    if (block == nullptr && region != MemoryRegion::INTERNAL) {
+        // No PSRAM on this board (or it is full)
+        region = MemoryRegion::INTERNAL;
+        block = heap_caps_malloc(bytes, capsFor(region));
+    }
+    if (block != nullptr && placed != nullptr) {
+        *placed = region;
+    }
+    return block;
+}
+
+void release(void* block) {
+    heap_caps_free(block);
+}
+
+size_t freeBytes(MemoryRegion region) {
+    return heap_caps_get_free_size(capsFor(region));
+}
+
+#if defined(ANDRTF3_IRAM_DECODE)
+bool ANDRTF3_IRAM flashCacheEnabled() {
+    return spi_flash_cache_enabled();
+}
+#endif
+
+#else
+
+void* allocate(size_t bytes, MemoryRegion region, MemoryRegion* placed) {
+    void* block = malloc(bytes);
+    if (block != nullptr && placed != nullptr) {
+        // Hosts have one heap
+        *placed = (region == MemoryRegion::PSRAM) ? MemoryRegion::INTERNAL : region;
+    }
+    return block;
+}
+
+void release(void* block) {
+    free(block);
+}
+
+size_t freeBytes(MemoryRegion region) {
+    (void)region;
+    return 0;
+}
+
+static std::atomic<bool> s_flashWriteActive{false};
+
+bool flashCacheEnabled() {
+    return !s_flashWriteActive.load();
+}
+
+void simulateFlashWrite(bool active) {
+    s_flashWriteActive.store(active);
+}
+
+#endif
+
+const char* regionName(MemoryRegion region) {
+    switch (region) {
+        case MemoryRegion::INTERNAL: return "internal";
+        case MemoryRegion::PSRAM:    return "psram";
+        default:                     return "any";
+    }
+}
+
+} // namespace memory
+} // namespace andrtf3
@@ -0,0 +1,108 @@
+/*
+ * ANDRTF3Memory.h - part of the ESP32-ANDRTF3 library
+ *
+ * Copyright (C) 2025-2026 packerlschupfer
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+
+#ifndef ANDRTF3_MEMORY_H
+#define ANDRTF3_MEMORY_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * Build option ANDRTF3_IRAM_DECODE: compile the response path (correlation,
+ * decode, publish) into IRAM so responses are still handled while a flash
+ * write (NVS, journal, OTA) has the flash cache disabled. Its data must then
+ * be in internal RAM as well; the default MemoryPolicy follows.
+ */
+#if defined(ESP_PLATFORM) && defined(ANDRTF3_IRAM_DECODE)
+#include <esp_attr.h>
+#define ANDRTF3_IRAM IRAM_ATTR
+#else
+#define ANDRTF3_IRAM
+#endif
+
+// Flash-side work is only deferred where the response path can run with the
+// cache off (IRAM builds), or where a flash write can be simulated (hosts)
+#if defined(ANDRTF3_IRAM_DECODE) || !defined(ESP_PLATFORM)
+#define ANDRTF3_TRACK_FLASH_CACHE 1
+#endif
+
+namespace andrtf3 {
+
+// Where a block of driver memory should live
+enum class MemoryRegion : uint8_t {
+    INTERNAL,                   // On-chip SRAM: lowest, cache-independent latency
+    PSRAM,                      // External RAM; falls back to INTERNAL without PSRAM
+    ANY                         // Default heap (malloc)
+};
+
+// Per-region placement of ANDRTF3 state
+struct MemoryPolicy {
+    MemoryRegion hot;           // Driver object: reading, pending flags, timing
+    MemoryRegion cold;          // Config, statistics, identity
+};
+
+/**
+ * Region-aware allocation for ESP32 boards with PSRAM
+ *
+ * On ESP_PLATFORM the regions map to heap_caps_malloc() capabilities. On
+ * hosts every region is the default heap. Large user buffers (fleet
+ * snapshots, rollups, directory manifests) can be placed with
+ * allocate(bytes, MemoryRegion::PSRAM) to keep internal SRAM for the
+ * read path.
+ */
+namespace memory {
+
+/**
+ * @brief Allocate in the requested region, falling back to internal RAM
+ * @param placed Receives the region actually used (optional)
+ * @return nullptr if no region had room
+ */
+void* allocate(size_t bytes, MemoryRegion region, MemoryRegion* placed = nullptr);
+void release(void* block);
+
+// Free bytes in a region (0 if the region does not exist)
+size_t freeBytes(MemoryRegion region);
+
+[[nodiscard]] const char* regionName(MemoryRegion region);
+
+#if defined(ANDRTF3_TRACK_FLASH_CACHE)
+/**
+ * @brief Whether flash (code, constants) and PSRAM are reachable right now
+ *
+ * False while a flash write or erase has the cache disabled. IRAM code
+ * checks this before calling into anything that lives in flash. Host builds
+ * report the state set with simulateFlashWrite(). Only available with
+ * ANDRTF3_IRAM_DECODE on ESP32: the IDF query behind it is a private API.
+ */
+bool flashCacheEnabled();
+#endif
+
+#if !defined(ESP_PLATFORM)
+// Host builds: pretend a flash write is in progress (true) or over (false)
+void simulateFlashWrite(bool active);
+#endif
+
+} // namespace memory
+
+} // namespace andrtf3
+
+#endif // ANDRTF3_MEMORY_H
@@ -0,0 +1,198 @@
+/*
+ * ANDRTF3Poller.cpp - part of the ESP32-ANDRTF3 library
+ *
+ * Copyright (C) 2025-2026 packerlschupfer
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "ANDRTF3Poller.h"
+#include "ANDRTF3Logging.h"
+
+namespace andrtf3 {
+
+ANDRTF3Poller::ANDRTF3Poller(SchedulePolicy* policy)
+    : _sensors{},
+      _slots{},
+      _count(0),
+      _policy(policy != nullptr ? policy : &_defaultPolicy),
+      _gapTuner(nullptr),
+      _snapshot(nullptr),
+      _drift(nullptr),
+      _health(nullptr),
+      _interFrameGapMs(0),
+      _lastTransactionEndMs(0),
+      _maxLatenessMs(0) {
+}
+
+ANDRTF3Poller::~ANDRTF3Poller() {
+    for (size_t i = 0; i < _count; i++) {
+        if (_sensors[i] != nullptr) {
+            _sensors[i]->removeDetachHook(onSensorDestroyed, this);
+        }
+    }
+}
+
+bool ANDRTF3Poller::addSensor(ANDRTF3* sensor, uint32_t periodMs, uint8_t priority,
+                              uint8_t zone) {
+    if (sensor == nullptr || periodMs == 0) {
+        return false;
+    }
+    if (_count >= MAX_SENSORS) {
+        ANDRTF3_LOG_W("Poller full (%d sensors), address %d not added",
+                      static_cast<int>(MAX_SENSORS), sensor->getDeviceAddress());
+        return false;
+    }
+    if (!sensor->addDetachHook(onSensorDestroyed, this)) {
+        return false;
+    }
+
+    _sensors[_count] = sensor;
+    SensorSlot& slot = _slots[_count];
+    slot.reset(sensor->getDeviceAddress(), periodMs, priority, zone);
+    slot.nextDueMs = millis();  // Due immediately
+
+    // Start from the driver's warm state after a soft reset
+    slot.rttEwmaMs = sensor->getStats().avgLatencyMs;
+    if (sensor->isRestored()) {
+        ANDRTF3::TemperatureData data = sensor->getTemperatureData();
+        slot.hasReading = true;
+        slot.lastValue = data.celsius;
+        slot.previousValue = data.celsius;
+        slot.lastSuccessMs = data.timestamp;
+    }
+    _count++;
+    _policy->reset();
+    return true;
+}
+
+void ANDRTF3Poller::removeSensor(ANDRTF3* sensor) {
+    for (size_t i = 0; i < _count; i++) {
+        if (sensor != nullptr && _sensors[i] == sensor) {
+            sensor->removeDetachHook(onSensorDestroyed, this);
+            _sensors[i] = nullptr;
+        }
+    }
+}
+
+void ANDRTF3Poller::onSensorDestroyed(ANDRTF3& sensor, void* context) {
+    static_cast<ANDRTF3Poller*>(context)->removeSensor(&sensor);
+}
+
+void ANDRTF3Poller::setPolicy(SchedulePolicy* policy) {
+    _policy = (policy != nullptr) ? policy : &_defaultPolicy;
+    _policy->reset();
+    ANDRTF3_LOG_D("Poller policy: %s", _policy->name());
+}
+
+bool ANDRTF3Poller::poll() {
+    int index = -1;
+    bool success = false;
+    uint32_t start = 0;
+    // Each dropped read reschedules its sensor, so this ends within _count rounds
+    for (size_t attempt = 0; attempt <= _count; attempt++) {
+        index = _policy->selectNext(_slots, _count, millis());
+        if (index < 0) {
+            return false;
+        }
+        if (_sensors[index] == nullptr) {
+            // Removed: parked a period at a time, never on the bus
+            _slots[index].nextDueMs = millis() + _slots[index].currentPeriodMs;
+            index = -1;
+            continue;
+        }
+
+        // Leave the bus idle for the (tuned) gap before addressing this sensor
+        uint32_t gap = (_gapTuner != nullptr) ? _gapTuner->getGapMs(index) : _interFrameGapMs;
+        uint32_t idle = millis() - _lastTransactionEndMs;
+        if (idle < gap) {
+            delay(gap - idle);
+        }
+
+        ANDRTF3* sensor = _sensors[index];
+        SensorSlot& due = _slots[index];
+
+        // Scheduled reads carry their lateness limit as a queued-read deadline;
+        // one the driver queued itself (verifying a suspect value) keeps its own
+        if (_maxLatenessMs != 0 && !sensor->hasQueuedRead()) {
+            sensor->queueRead(due.nextDueMs + _maxLatenessMs);
+        }
+
+        start = millis();
+        ANDRTF3::QueuedRead queued = sensor->serviceQueuedRead();
+        if (queued == ANDRTF3::QueuedRead::NONE) {
+            success = sensor->readTemperature();
+            break;
+        }
+        if (queued != ANDRTF3::QueuedRead::DROPPED) {
+            success = (queued == ANDRTF3::QueuedRead::COMPLETED);
+            break;
+        }
+
+        // Counted in the sensor's Stats::expiredDrops
+        ANDRTF3_LOG_D("Poller: dropped late read of addr=%d (%lu ms late)",
+                      due.address, static_cast<unsigned long>(start - due.nextDueMs));
+        due.nextDueMs = millis() + due.currentPeriodMs;
+        index = -1;
+    }
+    if (index < 0) {
+        return false;
+    }
+
+    ANDRTF3* sensor = _sensors[index];
+    uint32_t now = millis();
+    _lastTransactionEndMs = now;
+
+    SensorSlot& slot = _slots[index];
+    slot.recordResult(success, sensor->getTemperature(), now - start, now);
+    _policy->onResult(slot, success, now);
+
+    // A read queued by this one (the driver verifying a suspect value) takes the
+    // next free slot; a failed or expired verification is no longer queued
+    if (sensor->hasQueuedRead()) {
+        slot.nextDueMs = now;
+    }
+
+    if (_gapTuner != nullptr) {
+        _gapTuner->onResult(index, success, now - start);
+        ANDRTF3::Config config = sensor->getConfig();
+        config.timeout = _gapTuner->getRecommendedTimeoutMs(index);
+        sensor->setConfig(config);
+    }
+
+    if (_snapshot != nullptr) {
+        ANDRTF3::TemperatureData data = sensor->getTemperatureData();
+        _snapshot->publish(index, slot.address, data.celsius, data.valid, data.timestamp);
+    }
+
+    if (_health != nullptr) {
+        _health->onResult(index, success, now - start);
+    }
+
+    if (_drift != nullptr) {
+        if (success) {
+            _drift->update(index, slot.zone, sensor->getTemperature());
+        } else {
+            _drift->invalidate(index);
+        }
+    }
+
+    ANDRTF3_LOG_V("Poller [%s]: addr=%d ok=%d rtt=%lu",
+                  _policy->name(), slot.address, success, now - start);
+    return true;
+}
+
+} // namespace andrtf3
@@ -0,0 +1,153 @@
+/*
+ * ANDRTF3Poller.h - part of the ESP32-ANDRTF3 library
+ *
+ * Copyright (C) 2025-2026 packerlschupfer
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#ifndef ANDRTF3_POLLER_H
+#define ANDRTF3_POLLER_H
+
+#include "ANDRTF3.h"
+#include "ANDRTF3Scheduler.h"
+#include "ANDRTF3GapTuner.h"
+#include "ANDRTF3Snapshot.h"
+#include "ANDRTF3Drift.h"
+#include "ANDRTF3Health.h"
+
+namespace andrtf3 {
+
+/**
+ * Multi-sensor poller
+ *
+ * Owns the scheduling state of a set of ANDRTF3 sensors sharing one bus and
+ * asks a SchedulePolicy which one to read next. Call poll() from the bus
+ * task; each call performs at most one (blocking) Modbus transaction.
+ *
+ * Example usage:
+ * @code
+ * EdfPolicy edf;
+ * ANDRTF3Poller poller(&edf);
+ * poller.addSensor(&livingRoom, 5000, 1);   // critical lane
+ * poller.addSensor(&hallway, 10000);
+ * for (;;) {
+ *     if (!poller.poll()) vTaskDelay(pdMS_TO_TICKS(10));
+ * }
+ * @endcode
+ */
+class ANDRTF3Poller {
+public:
+    static constexpr size_t MAX_SENSORS = 48;
+
+    // nullptr selects the built-in round-robin policy
+    explicit ANDRTF3Poller(SchedulePolicy* policy = nullptr);
+    ~ANDRTF3Poller();
+
+    ANDRTF3Poller(const ANDRTF3Poller&) = delete;
+    ANDRTF3Poller& operator=(const ANDRTF3Poller&) = delete;
+
+    [[nodiscard]] bool addSensor(ANDRTF3* sensor, uint32_t periodMs = 5000, uint8_t priority = 0,
+                                 uint8_t zone = 0);
+
+    /**
+     * @brief Stop polling a sensor (also done when the sensor is destroyed)
+     *
+     * The index stays taken so slots of attached trackers keep their
+     * numbering; getSensor() returns nullptr for it.
+     */
+    void removeSensor(ANDRTF3* sensor);
+    void setPolicy(SchedulePolicy* policy);
+    [[nodiscard]] SchedulePolicy* getPolicy() const noexcept { return _policy; }
+
+    // Fixed bus idle time before each transaction (default: 0, driver handles 3.5 chars)
+    void setInterFrameGap(uint16_t gapMs) { _interFrameGapMs = gapMs; }
+
+    /**
+     * @brief Let a GapTuner choose per-sensor gaps and timeouts
+     *
+     * Overrides setInterFrameGap(). Each sensor's Config::timeout follows
+     * GapTuner::getRecommendedTimeoutMs(). Pass nullptr to detach.
+     */
+    void setGapTuner(GapTuner* tuner) { _gapTuner = tuner; }
+
+    /**
+     * @brief Publish every reading into a fleet snapshot
+     *
+     * Record i of the snapshot is sensor i of this poller. Pass nullptr to
+     * detach.
+     */
+    void setSnapshot(FleetSnapshot* snapshot) { _snapshot = snapshot; }
+
+    /**
+     * @brief Check every valid reading against its zone peers
+     *
+     * Slot i of the detector is sensor i of this poller, grouped by the zone
+     * given to addSensor(). Failed reads take the sensor out of its zone's
+     * reference until it answers again. Pass nullptr to detach.
+     */
+    void setDriftDetector(DriftDetector* detector) { _drift = detector; }
+
+    /**
+     * @brief Watch every sensor's response time and failure rate for trends
+     *
+     * Slot i of the monitor is sensor i of this poller. Pass nullptr to
+     * detach.
+     */
+    void setHealthMonitor(HealthMonitor* monitor) { _health = monitor; }
+
+    /**
+     * @brief Drop reads that reach the bus too late to be useful
+     *
+     * Each scheduled read is queued on its sensor with the deadline
+     * "became due + maxLatenessMs" and transmitted through
+     * ANDRTF3::serviceQueuedRead(). A read whose answer would arrive after
+     * that (e.g. queued behind slow or timed-out transactions) is not
+     * transmitted; it is rescheduled one period later and counted in the
+     * sensor's Stats::expiredDrops. 0 disables (default).
+     */
+    void setMaxLateness(uint32_t maxLatenessMs) { _maxLatenessMs = maxLatenessMs; }
+
+    /**
+     * @brief Run one scheduling step
+     * @return true if a transaction was performed
+     */
+    bool poll();
+
+    [[nodiscard]] size_t getSensorCount() const noexcept { return _count; }
+    [[nodiscard]] ANDRTF3* getSensor(size_t index) const { return index < _count ? _sensors[index] : nullptr; }
+    [[nodiscard]] const SensorSlot& getSlot(size_t index) const { return _slots[index]; }
+
+private:
+    static void onSensorDestroyed(ANDRTF3& sensor, void* context);
+
+    ANDRTF3* _sensors[MAX_SENSORS];
+    SensorSlot _slots[MAX_SENSORS];
+    size_t _count;
+    RoundRobinPolicy _defaultPolicy;
+    SchedulePolicy* _policy;
+    GapTuner* _gapTuner;
+    FleetSnapshot* _snapshot;
+    DriftDetector* _drift;
+    HealthMonitor* _health;
+    uint16_t _interFrameGapMs;
+    uint32_t _lastTransactionEndMs;
+    uint32_t _maxLatenessMs;
+};
+
+} // namespace andrtf3
+
+#endif // ANDRTF3_POLLER_H
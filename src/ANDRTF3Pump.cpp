@@ -0,0 +1,141 @@
+/*
+ * ANDRTF3Pump.cpp - part of the ESP32-ANDRTF3 library
+ *
+ * Copyright (C) 2025-2026 packerlschupfer
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+
+#include "ANDRTF3Pump.h"
+#include "ANDRTF3Logging.h"
+
+namespace andrtf3 {
+
+ResponsePump::ResponsePump()
+    : _eventGroup(xEventGroupCreate()),
+      _owners{},
+      _pending{},
+      _count(0),
+      _stats{} {
+    if (_eventGroup == nullptr) {
+        ANDRTF3_LOG_E("Pump: failed to create event group");
+    }
+}
+
+ResponsePump::~ResponsePump() {
+    for (size_t address = 0; address <= MAX_ADDRESS; address++) {
+        if (_owners[address] != nullptr) {
+            _owners[address]->removeDetachHook(onSensorDestroyed, this);
+        }
+    }
+    if (_eventGroup != nullptr) {
+        vEventGroupDelete(_eventGroup);
+    }
+}
+
+bool ResponsePump::add(ANDRTF3& sensor) {
+    uint8_t address = sensor.getDeviceAddress();
+    if (address > MAX_ADDRESS) {
+        return false;
+    }
+    if (_owners[address] != nullptr && _owners[address] != &sensor) {
+        ANDRTF3_LOG_W("Pump: address %d already routed to another sensor", address);
+        return false;
+    }
+    if (_owners[address] == nullptr) {
+        if (!sensor.addDetachHook(onSensorDestroyed, this)) {
+            return false;
+        }
+        _owners[address] = &sensor;
+        _count++;
+    }
+    return true;
+}
+
+void ResponsePump::remove(ANDRTF3& sensor) {
+    uint8_t address = sensor.getDeviceAddress();
+    if (address <= MAX_ADDRESS && _owners[address] == &sensor) {
+        sensor.removeDetachHook(onSensorDestroyed, this);
+        _owners[address] = nullptr;
+        _count--;
+    }
+}
+
+void ResponsePump::onSensorDestroyed(ANDRTF3& sensor, void* context) {
+    static_cast<ResponsePump*>(context)->remove(sensor);
+}
+
+void ResponsePump::notify(uint8_t serverAddress) {
+    _notifications.fetch_add(1, std::memory_order_relaxed);
+    _pending[serverAddress / 32].fetch_or(1UL << (serverAddress % 32), std::memory_order_release);
+    if (_eventGroup != nullptr) {
+        xEventGroupSetBits(_eventGroup, WAKE_BIT);
+    }
+}
+
+size_t ResponsePump::drain() {
+    size_t handled = 0;
+    for (size_t word = 0; word < WORDS; word++) {
+        uint32_t bits = _pending[word].exchange(0, std::memory_order_acquire);
+        while (bits != 0) {
+            size_t address = word * 32 + static_cast<size_t>(__builtin_ctz(bits));
+            bits &= bits - 1;
+            ANDRTF3* owner = (address <= MAX_ADDRESS) ? _owners[address] : nullptr;
+            if (owner == nullptr) {
+                _stats.unrouted++;
+                continue;
+            }
+            owner->process();
+            _stats.dispatched++;
+            handled++;
+        }
+    }
+    return handled;
+}
+
+size_t ResponsePump::pump(TickType_t timeout) {
+    // Clear first: a notify() racing with drain() leaves the bit set for next time
+    if (_eventGroup != nullptr) {
+        xEventGroupClearBits(_eventGroup, WAKE_BIT);
+    }
+    size_t handled = drain();
+    if (handled > 0 || timeout == 0 || _eventGroup == nullptr) {
+        return handled;
+    }
+
+    EventBits_t bits = xEventGroupWaitBits(_eventGroup, WAKE_BIT,
+                                           pdTRUE,    // clear on exit
+                                           pdFALSE,   // any bit
+                                           timeout);
+    if ((bits & WAKE_BIT) == 0) {
+        return 0;
+    }
+    _stats.wakeups++;
+    handled = drain();
+    if (handled == 0) {
+        _stats.idleWakeups++;
+    }
+    return handled;
+}
+
+ResponsePump::Stats ResponsePump::getStats() const {
+    Stats stats = _stats;
+    stats.notifications = _notifications.load(std::memory_order_relaxed);
+    return stats;
+}
+
+} // namespace andrtf3
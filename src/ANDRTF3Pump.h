@@ -0,0 +1,115 @@
+/*
+ * ANDRTF3Pump.h - part of the ESP32-ANDRTF3 library
+ *
+ * Copyright (C) 2025-2026 packerlschupfer
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+
+#ifndef ANDRTF3_PUMP_H
+#define ANDRTF3_PUMP_H
+
+#include "ANDRTF3.h"
+#include <atomic>
+
+namespace andrtf3 {
+
+/**
+ * Central response pump for async sensors on one bus
+ *
+ * Replaces calling process() on every sensor in the application loop. The
+ * Modbus task's onData callback calls notify() after handing the frame to
+ * the framework. That marks the server address in a bitmap and wakes the
+ * pump, and pump() then runs process() only for the sensors that received
+ * something. CPU time follows response traffic instead of sensor count, and
+ * the pump task sleeps while the bus is quiet.
+ *
+ * Example usage:
+ * @code
+ * ResponsePump pump;
+ * for (auto* s : sensors) pump.add(*s);
+ *
+ * modbusMaster.onData([](uint8_t server, esp32Modbus::FunctionCode fc, uint16_t addr,
+ *                        const uint8_t* data, size_t length) {
+ *     mainHandleData(server, fc, addr, data, length);
+ *     pump.notify(server);
+ * });
+ *
+ * for (;;) {
+ *     pump.pump();                     // Blocks until a response arrives
+ * }
+ * @endcode
+ *
+ * add() and remove() must not run concurrently with pump(); notify() may be
+ * called from any task. A sensor that is destroyed is removed by itself,
+ * which counts as a remove().
+ */
+class ResponsePump {
+public:
+    static constexpr size_t MAX_ADDRESS = 247;
+
+    struct Stats {
+        uint32_t notifications;     // notify() calls
+        uint32_t dispatched;        // process() calls
+        uint32_t unrouted;          // Notifications for unregistered addresses
+        uint32_t wakeups;           // Times pump() woke from waiting
+        uint32_t idleWakeups;       // ... and found nothing to dispatch
+    };
+
+    ResponsePump();
+    ~ResponsePump();
+
+    ResponsePump(const ResponsePump&) = delete;
+    ResponsePump& operator=(const ResponsePump&) = delete;
+
+    /**
+     * @brief Route responses for the sensor's address to it
+     * @return false if another sensor already owns the address
+     */
+    [[nodiscard]] bool add(ANDRTF3& sensor);
+    void remove(ANDRTF3& sensor);
+
+    // A response for serverAddress was queued (Modbus task); O(1), never blocks
+    void notify(uint8_t serverAddress);
+
+    /**
+     * @brief Dispatch pending responses, waiting up to timeout for the first
+     * @return number of sensors processed
+     */
+    size_t pump(TickType_t timeout = portMAX_DELAY);
+
+    [[nodiscard]] size_t size() const noexcept { return _count; }
+    [[nodiscard]] Stats getStats() const;
+
+private:
+    static constexpr EventBits_t WAKE_BIT = (1UL << 0);
+    static constexpr size_t WORDS = (MAX_ADDRESS + 32) / 32;
+
+    size_t drain();
+    static void onSensorDestroyed(ANDRTF3& sensor, void* context);
+
+    EventGroupHandle_t _eventGroup;
+    ANDRTF3* _owners[MAX_ADDRESS + 1];
+    std::atomic<uint32_t> _pending[WORDS];
+    std::atomic<uint32_t> _notifications{0};
+    size_t _count;
+    Stats _stats;
+};
+
+} // namespace andrtf3
+
+#endif // ANDRTF3_PUMP_H
@@ -0,0 +1,186 @@
+/*
+ * ANDRTF3Retained.cpp - part of the ESP32-ANDRTF3 library
+ *
+ * Copyright (C) 2025-2026 packerlschupfer
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+
+#include "ANDRTF3Retained.h"
+#include "ANDRTF3Logging.h"
+#include <string.h>
+
+#if defined(ESP_PLATFORM)
+#include <esp_attr.h>
+#include <esp_system.h>
+#endif
+
+namespace andrtf3 {
+
+namespace {
+
+#if defined(ESP_PLATFORM)
+RTC_NOINIT_ATTR RetainedState::Block s_retainedBlock;
+#else
+// Host stand-in: survives driver objects, not the process
+RetainedState::Block s_retainedBlock;
+#endif
+
+uint32_t fnv1a(const void* data, size_t length, uint32_t hash) {
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    for (size_t i = 0; i < length; i++) {
+        hash ^= bytes[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+} // namespace
+
+RetainedState::RetainedState(Block* block)
+    : _block(block),
+      _maxAgeMs(DEFAULT_MAX_AGE_MS),
+      _saves(0) {
+    if (!headerValid()) {
+        format();
+    }
+}
+
+RetainedState& RetainedState::system() {
+    static RetainedState state = boot(&s_retainedBlock);
+    return state;
+}
+
+RetainedState RetainedState::boot(Block* block) {
+    RetainedState state(block);
+#if defined(ESP_PLATFORM)
+    // RTC memory holds noise after power-on; only software resets keep it
+    esp_reset_reason_t reason = esp_reset_reason();
+    if (reason == ESP_RST_POWERON || reason == ESP_RST_BROWNOUT) {
+        state.format();
+    } else if (reason == ESP_RST_DEEPSLEEP) {
+        state.markReadingsStale();
+    }
+#endif
+    block->boots++;
+    block->checksum = headerChecksum(*block);
+    ANDRTF3_LOG_D("Retained state: boot %lu", static_cast<unsigned long>(block->boots));
+    return state;
+}
+
+void RetainedState::format() {
+    memset(_block, 0, sizeof(Block));
+    _block->magic = MAGIC;
+    _block->version = VERSION;
+    _block->entrySize = sizeof(Entry);
+    _block->checksum = headerChecksum(*_block);
+}
+
+void RetainedState::markReadingsStale() {
+    for (size_t i = 0; i < MAX_ENTRIES; i++) {
+        Entry& entry = _block->entries[i];
+        if (entry.address != 0 && entry.checksum == entryChecksum(entry)) {
+            entry.flags &= static_cast<uint8_t>(~FLAG_VALID);
+            entry.checksum = entryChecksum(entry);
+        }
+    }
+}
+
+int RetainedState::claim(uint8_t address, uint16_t bus) {
+    if (address == 0) {
+        return -1;
+    }
+
+    int freeIndex = -1;
+    for (size_t i = 0; i < MAX_ENTRIES; i++) {
+        if (_block->entries[i].address == address && _block->entries[i].bus == bus) {
+            return static_cast<int>(i);
+        }
+        if (_block->entries[i].address == 0 && freeIndex < 0) {
+            freeIndex = static_cast<int>(i);
+        }
+    }
+    if (freeIndex < 0) {
+        ANDRTF3_LOG_W("Retained state full, address %d (bus %u) not kept", address, bus);
+        return -1;
+    }
+
+    // Reserve with an invalid checksum; nothing to restore until the first save
+    Entry& entry = _block->entries[freeIndex];
+    memset(&entry, 0, sizeof(Entry));
+    entry.address = address;
+    entry.bus = bus;
+    entry.checksum = ~entryChecksum(entry);
+    return freeIndex;
+}
+
+void RetainedState::release(uint8_t address, uint16_t bus) {
+    for (size_t i = 0; i < MAX_ENTRIES; i++) {
+        if (_block->entries[i].address == address && _block->entries[i].bus == bus) {
+            memset(&_block->entries[i], 0, sizeof(Entry));
+        }
+    }
+}
+
+void RetainedState::save(int index, const Sensor& state, uint32_t readingMs, uint32_t nowMs) {
+    if (index < 0 || static_cast<size_t>(index) >= MAX_ENTRIES) {
+        return;
+    }
+    Entry& entry = _block->entries[index];
+    entry.flags = state.valid ? FLAG_VALID : 0;
+    entry.failures = state.failures;
+    entry.celsius = state.celsius;
+    entry.rttMs = state.rttMs;
+    entry.readingMs = readingMs;
+    entry.savedMs = nowMs;
+    entry.checksum = entryChecksum(entry);
+    _saves++;
+}
+
+bool RetainedState::restore(int index, Sensor& state) const {
+    if (index < 0 || static_cast<size_t>(index) >= MAX_ENTRIES) {
+        return false;
+    }
+    const Entry& entry = _block->entries[index];
+    if (entry.address == 0 || entry.checksum != entryChecksum(entry)) {
+        return false;
+    }
+
+    state.celsius = entry.celsius;
+    state.ageMs = entry.savedMs - entry.readingMs;
+    state.rttMs = entry.rttMs;
+    state.failures = entry.failures;
+    state.valid = (entry.flags & FLAG_VALID) != 0 && state.ageMs <= _maxAgeMs;
+    return true;
+}
+
+uint32_t RetainedState::entryChecksum(const Entry& entry) {
+    return fnv1a(&entry, offsetof(Entry, checksum), 2166136261u ^ MAGIC);
+}
+
+uint32_t RetainedState::headerChecksum(const Block& block) {
+    return fnv1a(&block, offsetof(Block, checksum), 2166136261u ^ MAGIC);
+}
+
+bool RetainedState::headerValid() const {
+    return _block->magic == MAGIC &&
+           _block->version == VERSION &&
+           _block->entrySize == sizeof(Entry) &&
+           _block->checksum == headerChecksum(*_block);
+}
+
+} // namespace andrtf3
@@ -0,0 +1,142 @@
+/*
+ * ANDRTF3Retained.h - part of the ESP32-ANDRTF3 library
+ *
+ * Copyright (C) 2025-2026 packerlschupfer
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+
+#ifndef ANDRTF3_RETAINED_H
+#define ANDRTF3_RETAINED_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+namespace andrtf3 {
+
+/**
+ * Per-sensor warm state that survives soft resets
+ *
+ * On ESP32 the table lives in RTC_NOINIT memory, which keeps its contents
+ * across watchdog, panic and OTA (software) resets but not power-on. Each
+ * ANDRTF3 claims an entry for its address in the constructor, restores the
+ * last reading, response time estimate and fault state from it, and writes
+ * the entry back on every published reading. Control can then resume right
+ * after a reboot instead of waiting for the first sweep.
+ *
+ * Entries are keyed by address and bus (Transport::busId(), 0 for the
+ * local bus), so the same address on two buses keeps two entries.
+ *
+ * Every entry carries its own checksum, so a reset in the middle of an
+ * update loses only that entry. Readings older than getMaxAge() at save
+ * time are not restored. Time is not carried across the reset; a restored
+ * reading's age is its age when it was last saved. Deep sleep keeps RTC
+ * memory but its length is unknown, so a wake from deep sleep keeps fault
+ * state and response times and drops the readings (markReadingsStale()).
+ *
+ * On other platforms the table is ordinary static memory: it outlives
+ * driver objects within one process, which is what a reset looks like to
+ * the driver, so host tests can exercise restore paths.
+ */
+class RetainedState {
+public:
+    static constexpr size_t MAX_ENTRIES = 64;       // Above ANDRTF3Poller::MAX_SENSORS
+    static constexpr uint32_t MAGIC = 0x33465452;   // "RTF3"
+    static constexpr uint16_t VERSION = 2;
+    static constexpr uint16_t LOCAL_BUS = 0;
+    static constexpr uint32_t DEFAULT_MAX_AGE_MS = 10UL * 60UL * 1000UL;
+
+    static constexpr uint8_t FLAG_VALID = 0x01;     // Last published reading was valid
+
+    struct Entry {
+        uint8_t address;            // 0 = free
+        uint8_t flags;
+        uint8_t failures;           // Consecutive invalid readings (fault state)
+        uint8_t reserved;
+        uint16_t bus;               // Transport::busId(), LOCAL_BUS for RS485
+        int16_t celsius;            // Deci-degrees
+        uint16_t rttMs;             // Smoothed response time, 0 = unknown
+        uint16_t reserved2;
+        uint32_t readingMs;         // millis() of the reading (previous boot)
+        uint32_t savedMs;           // millis() when the entry was written
+        uint32_t checksum;
+    };
+
+    struct Block {
+        uint32_t magic;
+        uint16_t version;
+        uint16_t entrySize;
+        uint32_t boots;             // Soft resets survived since power-on
+        uint32_t checksum;          // Over the fields above
+        Entry entries[MAX_ENTRIES];
+    };
+
+    // State handed to / from the driver
+    struct Sensor {
+        int16_t celsius;
+        uint32_t ageMs;             // Reading age when saved
+        uint16_t rttMs;
+        uint8_t failures;
+        bool valid;
+    };
+
+    explicit RetainedState(Block* block);
+
+    // Process-wide table (RTC_NOINIT on ESP32); cleared on power-on reset
+    static RetainedState& system();
+
+    // Discard everything
+    void format();
+
+    // Keep fault state and response times, drop every reading
+    void markReadingsStale();
+
+    [[nodiscard]] uint32_t getBootCount() const noexcept { return _block->boots; }
+    void setMaxAge(uint32_t maxAgeMs) { _maxAgeMs = maxAgeMs; }
+    [[nodiscard]] uint32_t getMaxAge() const noexcept { return _maxAgeMs; }
+    // Entry writes since boot (kept in ordinary RAM, not in the table)
+    [[nodiscard]] uint32_t getSaveCount() const noexcept { return _saves; }
+
+    /**
+     * @brief Find or allocate the entry for a sensor address on a bus
+     * @return entry index, or -1 if the table is full / address invalid
+     */
+    int claim(uint8_t address, uint16_t bus = LOCAL_BUS);
+    void release(uint8_t address, uint16_t bus = LOCAL_BUS);
+
+    void save(int index, const Sensor& state, uint32_t readingMs, uint32_t nowMs);
+
+    // False if the entry is missing or torn; a stale reading comes back with valid = false
+    bool restore(int index, Sensor& state) const;
+
+    // Raw table, for tests that simulate corruption
+    [[nodiscard]] Block* getBlock() noexcept { return _block; }
+
+private:
+    static RetainedState boot(Block* block);
+    static uint32_t entryChecksum(const Entry& entry);
+    static uint32_t headerChecksum(const Block& block);
+    bool headerValid() const;
+
+    Block* _block;
+    uint32_t _maxAgeMs;
+    uint32_t _saves;
+};
+
+} // namespace andrtf3
+
+#endif // ANDRTF3_RETAINED_H
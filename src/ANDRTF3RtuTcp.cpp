@@ -0,0 +1,538 @@
+/*
+ * ANDRTF3RtuTcp.cpp - part of the ESP32-ANDRTF3 library
+ *
+ * Copyright (C) 2025-2026 packerlschupfer
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+
+#include "ANDRTF3RtuTcp.h"
+#include "ANDRTF3Logging.h"
+
+#if defined(__linux__)
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+namespace andrtf3 {
+
+namespace {
+
+uint64_t monotonicUs() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000ULL + static_cast<uint64_t>(ts.tv_nsec) / 1000ULL;
+}
+
+int remainingMs(uint64_t deadlineUs) {
+    uint64_t now = monotonicUs();
+    if (now >= deadlineUs) {
+        return 0;
+    }
+    return static_cast<int>((deadlineUs - now + 999) / 1000);
+}
+
+} // namespace
+
+// ========== RtuTcpTransport ==========
+
+RtuTcpTransport::RtuTcpTransport(const char* host, uint16_t port)
+    : RtuTcpTransport(host, port, getDefaultConfig()) {
+}
+
+RtuTcpTransport::RtuTcpTransport(const char* host, uint16_t port, const Config& config)
+    : _host{},
+      _port(port),
+      _config(config),
+      _fd(-1),
+      _stats{},
+      _rx{},
+      _rxLength(0) {
+    strncpy(_host, (host != nullptr) ? host : "", sizeof(_host) - 1);
+    if (_config.maxInFlight == 0) {
+        _config.maxInFlight = 1;
+    }
+}
+
+RtuTcpTransport::~RtuTcpTransport() {
+    close();
+}
+
+RtuTcpTransport::Config RtuTcpTransport::getDefaultConfig() {
+    return {
+        1000,     // connectTimeoutMs
+        1         // maxInFlight: pipelining needs a queueing server
+    };
+}
+
+ModbusError RtuTcpTransport::readInputRegisters(uint8_t unit, uint16_t reg, uint16_t count,
+                                                uint16_t* out, uint32_t timeoutMs) {
+    Request request = { unit, 0x04, reg, count, out, ModbusError::SUCCESS };
+    readBatch(&request, 1, timeoutMs);
+    return request.result;
+}
+
+size_t RtuTcpTransport::readBatch(Request* requests, size_t count, uint32_t timeoutMs) {
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    for (size_t i = 0; i < count; i++) {
+        if (requests[i].count == 0 || requests[i].count > rtu::MAX_READ_REGISTERS || requests[i].out == nullptr) {
+            requests[i].result = ModbusError::INVALID_PARAMETER;
+        } else {
+            requests[i].result = ModbusError::TIMEOUT;   // Until answered
+        }
+    }
+
+    size_t succeeded = 0;
+    size_t next = 0;
+    uint8_t frame[rtu::MAX_FRAME_BYTES];
+
+    while (next < count) {
+        if (requests[next].result == ModbusError::INVALID_PARAMETER) {
+            next++;
+            continue;
+        }
+        if (!ensureConnected()) {
+            for (size_t i = next; i < count; i++) {
+                if (requests[i].result != ModbusError::INVALID_PARAMETER) {
+                    requests[i].result = ModbusError::COMMUNICATION_ERROR;
+                }
+            }
+            break;
+        }
+
+        size_t sent = next;
+        size_t done = next;
+        bool resync = false;
+
+        while (done < count && !resync) {
+            // Keep the server's queue filled up to maxInFlight
+            while (sent < count && sent - done < _config.maxInFlight) {
+                Request& r = requests[sent];
+                if (r.result == ModbusError::INVALID_PARAMETER) {
+                    sent++;
+                    continue;
+                }
+                uint8_t request[rtu::READ_REQUEST_BYTES];
+                rtu::buildReadRequest(r.unit, r.functionCode, r.reg, r.count, request);
+                if (!sendAll(request, sizeof(request))) {
+                    resync = true;
+                    break;
+                }
+                _stats.requests++;
+                sent++;
+                if (sent - done > _stats.maxPipelined) {
+                    _stats.maxPipelined = static_cast<uint8_t>(sent - done);
+                }
+            }
+            if (resync) {
+                break;
+            }
+            if (requests[done].result == ModbusError::INVALID_PARAMETER) {
+                done++;
+                continue;
+            }
+
+            Request& head = requests[done];
+            int length = receiveFrame(frame, monotonicUs() + static_cast<uint64_t>(timeoutMs) * 1000ULL);
+            if (length <= 0) {
+                head.result = (length == 0) ? ModbusError::TIMEOUT : ModbusError::COMMUNICATION_ERROR;
+                if (length == 0) {
+                    _stats.timeouts++;
+                }
+                done++;
+                resync = true;
+                break;
+            }
+
+            _stats.responses++;
+            head.result = rtu::parseReadResponse(frame, static_cast<size_t>(length), head.unit,
+                                                 head.functionCode, head.count, head.out);
+
+            // The server gave up on a silent slave and moved on: the answer
+            // belongs to a later request in flight
+            if (head.result == ModbusError::INVALID_RESPONSE) {
+                size_t owner = done + 1;
+                while (owner < sent && (requests[owner].unit != frame[0] ||
+                                        requests[owner].functionCode != (frame[1] & 0x7F))) {
+                    owner++;
+                }
+                if (owner < sent) {
+                    for (size_t i = done; i < owner; i++) {
+                        if (requests[i].result != ModbusError::INVALID_PARAMETER) {
+                            requests[i].result = ModbusError::TIMEOUT;
+                            _stats.timeouts++;
+                        }
+                    }
+                    done = owner;
+                    Request& r = requests[owner];
+                    r.result = rtu::parseReadResponse(frame, static_cast<size_t>(length), r.unit,
+                                                      r.functionCode, r.count, r.out);
+                }
+            }
+
+            Request& answered = requests[done];
+            if (answered.result == ModbusError::SUCCESS) {
+                succeeded++;
+            } else if (answered.result == ModbusError::CRC_ERROR ||
+                       answered.result == ModbusError::INVALID_RESPONSE ||
+                       answered.result == ModbusError::INVALID_DATA_LENGTH) {
+                _stats.frameErrors++;
+                resync = true;   // Cannot trust the pairing of what follows
+            }
+            done++;
+        }
+
+        if (resync) {
+            // Requests sent after the failure are resent on a fresh connection
+            ANDRTF3_LOG_D("RTU/TCP %s:%u: resync after request %u", _host, _port, static_cast<unsigned>(done));
+            closeLocked();
+        }
+        next = done;
+    }
+
+    return succeeded;
+}
+
+void RtuTcpTransport::close() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    closeLocked();
+}
+
+bool RtuTcpTransport::isConnected() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _fd >= 0;
+}
+
+RtuTcpTransport::Stats RtuTcpTransport::getStats() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _stats;
+}
+
+bool RtuTcpTransport::ensureConnected() {
+    if (_fd >= 0) {
+        return true;
+    }
+
+    struct addrinfo hints;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    char service[8];
+    snprintf(service, sizeof(service), "%u", _port);
+
+    struct addrinfo* result = nullptr;
+    if (getaddrinfo(_host, service, &hints, &result) != 0 || result == nullptr) {
+        ANDRTF3_LOG_W("RTU/TCP: cannot resolve %s", _host);
+        return false;
+    }
+
+    for (struct addrinfo* ai = result; ai != nullptr && _fd < 0; ai = ai->ai_next) {
+        int fd = socket(ai->ai_family, ai->ai_socktype | SOCK_NONBLOCK | SOCK_CLOEXEC, ai->ai_protocol);
+        if (fd < 0) {
+            continue;
+        }
+        int rc = connect(fd, ai->ai_addr, ai->ai_addrlen);
+        if (rc < 0 && errno == EINPROGRESS) {
+            struct pollfd pfd = { fd, POLLOUT, 0 };
+            int error = 0;
+            socklen_t errorLength = sizeof(error);
+            if (poll(&pfd, 1, static_cast<int>(_config.connectTimeoutMs)) == 1 &&
+                getsockopt(fd, SOL_SOCKET, SO_ERROR, &error, &errorLength) == 0 && error == 0) {
+                rc = 0;
+            }
+        }
+        if (rc == 0) {
+            int one = 1;
+            setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));  // Frames are tiny
+            _fd = fd;
+        } else {
+            ::close(fd);
+        }
+    }
+    freeaddrinfo(result);
+
+    if (_fd < 0) {
+        ANDRTF3_LOG_W("RTU/TCP: connect to %s:%u failed", _host, _port);
+        return false;
+    }
+    _rxLength = 0;
+    _stats.connects++;
+    return true;
+}
+
+void RtuTcpTransport::closeLocked() {
+    if (_fd >= 0) {
+        ::close(_fd);
+        _fd = -1;
+    }
+    _rxLength = 0;
+}
+
+bool RtuTcpTransport::sendAll(const uint8_t* data, size_t length) {
+    uint64_t deadline = monotonicUs() + static_cast<uint64_t>(_config.connectTimeoutMs) * 1000ULL;
+    while (length > 0) {
+        ssize_t n = send(_fd, data, length, MSG_NOSIGNAL);
+        if (n > 0) {
+            data += n;
+            length -= static_cast<size_t>(n);
+            continue;
+        }
+        if (n < 0 && (errno == EAGAIN || errno == EINTR)) {
+            struct pollfd pfd = { _fd, POLLOUT, 0 };
+            if (poll(&pfd, 1, remainingMs(deadline)) > 0) {
+                continue;
+            }
+        }
+        return false;
+    }
+    return true;
+}
+
+int RtuTcpTransport::receiveFrame(uint8_t* frame, uint64_t deadlineUs) {
+    for (;;) {
+        size_t need = rtu::responseLength(_rx, _rxLength);
+        if (need > rtu::MAX_FRAME_BYTES) {
+            return -1;
+        }
+        if (need > 0 && _rxLength >= need) {
+            memcpy(frame, _rx, need);
+            memmove(_rx, _rx + need, _rxLength - need);
+            _rxLength -= need;
+            return static_cast<int>(need);
+        }
+
+        struct pollfd pfd = { _fd, POLLIN, 0 };
+        int ready = poll(&pfd, 1, remainingMs(deadlineUs));
+        if (ready == 0) {
+            return 0;
+        }
+        if (ready < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return -1;
+        }
+        ssize_t n = recv(_fd, _rx + _rxLength, sizeof(_rx) - _rxLength, 0);
+        if (n > 0) {
+            _rxLength += static_cast<size_t>(n);
+        } else if (n == 0 || (errno != EAGAIN && errno != EINTR)) {
+            return -1;   // Closed by the server
+        }
+    }
+}
+
+// ========== RtuTcpEmulator ==========
+
+RtuTcpEmulator::RtuTcpEmulator()
+    : _listenFd(-1),
+      _port(0),
+      _running(false),
+      _serviceTimeUs(0),
+      _requests(0),
+      _connections(0),
+      _silent{} {
+}
+
+RtuTcpEmulator::~RtuTcpEmulator() {
+    stop();
+}
+
+bool RtuTcpEmulator::start(uint16_t port) {
+    if (_running.load()) {
+        return true;
+    }
+
+    _listenFd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (_listenFd < 0) {
+        return false;
+    }
+    int one = 1;
+    setsockopt(_listenFd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = htons(port);
+    socklen_t length = sizeof(addr);
+    if (bind(_listenFd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) != 0 ||
+        listen(_listenFd, 16) != 0 ||
+        getsockname(_listenFd, reinterpret_cast<struct sockaddr*>(&addr), &length) != 0) {
+        ANDRTF3_LOG_E("RTU/TCP emulator: cannot listen on port %u", port);
+        ::close(_listenFd);
+        _listenFd = -1;
+        return false;
+    }
+    _port = ntohs(addr.sin_port);
+
+    _running.store(true);
+    _thread = std::thread(&RtuTcpEmulator::run, this);
+    return true;
+}
+
+void RtuTcpEmulator::stop() {
+    if (!_running.exchange(false)) {
+        return;
+    }
+    _thread.join();
+    for (Client& client : _clients) {
+        ::close(client.fd);
+    }
+    _clients.clear();
+    ::close(_listenFd);
+    _listenFd = -1;
+}
+
+void RtuTcpEmulator::setRegister(uint8_t unit, uint16_t reg, uint16_t value) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _registers[(static_cast<uint32_t>(unit) << 16) | reg] = value;
+}
+
+void RtuTcpEmulator::setSilent(uint8_t unit, bool silent) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _silent[unit] = silent;
+}
+
+void RtuTcpEmulator::run() {
+    std::vector<struct pollfd> fds;
+    while (_running.load()) {
+        fds.clear();
+        fds.push_back({ _listenFd, POLLIN, 0 });
+        for (const Client& client : _clients) {
+            fds.push_back({ client.fd, POLLIN, 0 });
+        }
+
+        if (poll(fds.data(), fds.size(), 20) <= 0) {
+            continue;
+        }
+
+        if (fds[0].revents & POLLIN) {
+            int fd = accept4(_listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+            if (fd >= 0) {
+                int one = 1;
+                setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+                Client client;
+                client.fd = fd;
+                client.rxLength = 0;
+                _clients.push_back(client);
+                _connections++;
+            }
+        }
+
+        // fds[i + 1] belongs to _clients[i] as it was before any accept above
+        for (size_t i = fds.size() - 1; i >= 1; i--) {
+            if (fds[i].revents == 0) {
+                continue;
+            }
+            Client& client = _clients[i - 1];
+            ssize_t n = recv(client.fd, client.rx + client.rxLength, sizeof(client.rx) - client.rxLength, 0);
+            if (n <= 0 && !(n < 0 && (errno == EAGAIN || errno == EINTR))) {
+                ::close(client.fd);
+                _clients.erase(_clients.begin() + static_cast<long>(i - 1));
+                continue;
+            }
+            if (n > 0) {
+                client.rxLength += static_cast<size_t>(n);
+                serve(client);
+            }
+        }
+    }
+}
+
+void RtuTcpEmulator::serve(Client& client) {
+    // Only fixed-size read requests are understood; anything else is noise
+    while (client.rxLength >= rtu::READ_REQUEST_BYTES) {
+        uint8_t response[rtu::MAX_FRAME_BYTES];
+        size_t length = answer(client.rx, response);
+        memmove(client.rx, client.rx + rtu::READ_REQUEST_BYTES, client.rxLength - rtu::READ_REQUEST_BYTES);
+        client.rxLength -= rtu::READ_REQUEST_BYTES;
+
+        uint32_t serviceUs = _serviceTimeUs.load();
+        if (serviceUs > 0) {
+            usleep(serviceUs);   // The segment is busy for the whole transaction
+        }
+        if (length > 0) {
+            send(client.fd, response, length, MSG_NOSIGNAL);
+        }
+    }
+}
+
+size_t RtuTcpEmulator::answer(const uint8_t* request, uint8_t* response) {
+    _requests++;
+
+    uint16_t crc = static_cast<uint16_t>(request[6] | (request[7] << 8));
+    if (crc != rtu::crc16(request, 6)) {
+        return 0;   // Slaves ignore corrupted frames
+    }
+
+    uint8_t unit = request[0];
+    uint8_t functionCode = request[1];
+    uint16_t reg = static_cast<uint16_t>((request[2] << 8) | request[3]);
+    uint16_t count = static_cast<uint16_t>((request[4] << 8) | request[5]);
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (_silent[unit]) {
+        return 0;
+    }
+
+    uint8_t exception = 0;
+    if (functionCode != 0x03 && functionCode != 0x04) {
+        exception = 0x01;
+    } else if (count == 0 || count > rtu::MAX_READ_REGISTERS) {
+        exception = 0x03;
+    }
+
+    size_t length = 0;
+    response[length++] = unit;
+    if (exception == 0) {
+        response[length++] = functionCode;
+        response[length++] = static_cast<uint8_t>(count * 2);
+        for (uint16_t i = 0; i < count && exception == 0; i++) {
+            auto it = _registers.find((static_cast<uint32_t>(unit) << 16) | static_cast<uint16_t>(reg + i));
+            if (it == _registers.end()) {
+                exception = 0x02;
+                break;
+            }
+            response[length++] = static_cast<uint8_t>(it->second >> 8);
+            response[length++] = static_cast<uint8_t>(it->second & 0xFF);
+        }
+    }
+    if (exception != 0) {
+        length = 1;
+        response[length++] = static_cast<uint8_t>(functionCode | 0x80);
+        response[length++] = exception;
+    }
+
+    uint16_t responseCrc = rtu::crc16(response, length);
+    response[length++] = static_cast<uint8_t>(responseCrc & 0xFF);
+    response[length++] = static_cast<uint8_t>(responseCrc >> 8);
+    return length;
+}
+
+} // namespace andrtf3
+
+#endif // __linux__
@@ -0,0 +1,183 @@
+/*
+ * ANDRTF3RtuTcp.h - part of the ESP32-ANDRTF3 library
+ *
+ * Copyright (C) 2025-2026 packerlschupfer
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+
+#ifndef ANDRTF3_RTU_TCP_H
+#define ANDRTF3_RTU_TCP_H
+
+#include "ANDRTF3Transport.h"
+
+#if defined(__linux__)
+
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace andrtf3 {
+
+/**
+ * Modbus RTU-over-TCP client for Ethernet serial servers (Linux)
+ *
+ * Plain RTU frames (with CRC) are written to a TCP connection that the serial
+ * server copies to its RS485 segment. One instance per server: the
+ * connection is opened on first use and kept, and a mutex serializes
+ * callers so transactions never interleave on the segment.
+ *
+ * RTU has no transaction id, so responses are matched in order. readBatch()
+ * can keep up to maxInFlight requests queued at the server, which hides the
+ * network round trip behind the serial transfer. Pipelining needs a server
+ * that queues requests and sends them one at a time (gateway mode). A
+ * transparent server copies queued frames back to back onto the RS485 line
+ * without the 3.5-character gaps, and the slaves see garbage. So the default
+ * is 1; raise it only for a queueing server. An answer from a later
+ * request in flight means the server gave up on the silent slaves before
+ * it. A timeout with nothing behind it, a garbled frame or a socket error
+ * closes the connection instead, so a late response can never be paired
+ * with a later request; unanswered requests of the batch are resent on the
+ * new connection.
+ */
+class RtuTcpTransport : public Transport {
+public:
+    struct Config {
+        uint32_t connectTimeoutMs;  // TCP connect timeout (default: 1000)
+        uint8_t maxInFlight;        // Requests queued at the server (default: 1 = no pipelining)
+    };
+
+    struct Request {
+        uint8_t unit;
+        uint8_t functionCode;       // 0x03 or 0x04
+        uint16_t reg;
+        uint16_t count;
+        uint16_t* out;
+        ModbusError result;         // Filled in by readBatch()
+    };
+
+    struct Stats {
+        uint32_t connects;
+        uint32_t requests;          // Frames sent (including resends)
+        uint32_t responses;         // Frames received
+        uint32_t timeouts;
+        uint32_t frameErrors;       // CRC / framing / unexpected unit
+        uint8_t maxPipelined;       // Highest number of requests in flight seen
+    };
+
+    RtuTcpTransport(const char* host, uint16_t port);
+    RtuTcpTransport(const char* host, uint16_t port, const Config& config);
+    ~RtuTcpTransport() override;
+
+    RtuTcpTransport(const RtuTcpTransport&) = delete;
+    RtuTcpTransport& operator=(const RtuTcpTransport&) = delete;
+
+    static Config getDefaultConfig();
+
+    const char* name() const override { return "rtu-tcp"; }
+    uint16_t busId() const override { return hashBusId(_host, _port); }
+
+    ModbusError readInputRegisters(uint8_t unit, uint16_t reg, uint16_t count,
+                                   uint16_t* out, uint32_t timeoutMs) override;
+
+    /**
+     * @brief Run several reads back to back on the shared connection
+     * @param timeoutMs Per response, counted from when it is next in line
+     * @return number of requests that succeeded
+     */
+    size_t readBatch(Request* requests, size_t count, uint32_t timeoutMs);
+
+    void close();
+    [[nodiscard]] bool isConnected() const;
+    [[nodiscard]] Stats getStats() const;
+
+private:
+    bool ensureConnected();
+    void closeLocked();
+    bool sendAll(const uint8_t* data, size_t length);
+    // Next complete frame into frame[MAX_FRAME_BYTES]: length, 0 on timeout, -1 on error
+    int receiveFrame(uint8_t* frame, uint64_t deadlineUs);
+
+    char _host[64];
+    uint16_t _port;
+    Config _config;
+    int _fd;
+    mutable std::mutex _mutex;
+    Stats _stats;
+    uint8_t _rx[rtu::MAX_FRAME_BYTES * 2];
+    size_t _rxLength;
+};
+
+/**
+ * Loopback stand-in for an Ethernet serial server with ANDRTF3 slaves
+ *
+ * Listens on 127.0.0.1 and answers function 0x03/0x04 reads from a register
+ * table, one transaction at a time like a real RS485 segment, with an
+ * optional per-transaction service time. Units marked silent never answer;
+ * unknown registers get exception 0x02. Used by the tests and benchmarks.
+ */
+class RtuTcpEmulator {
+public:
+    RtuTcpEmulator();
+    ~RtuTcpEmulator();
+
+    RtuTcpEmulator(const RtuTcpEmulator&) = delete;
+    RtuTcpEmulator& operator=(const RtuTcpEmulator&) = delete;
+
+    // port 0 = pick a free port (see getPort())
+    bool start(uint16_t port = 0);
+    void stop();
+    [[nodiscard]] uint16_t getPort() const noexcept { return _port; }
+
+    void setRegister(uint8_t unit, uint16_t reg, uint16_t value);
+    void setSilent(uint8_t unit, bool silent);
+    void setServiceTimeUs(uint32_t us) { _serviceTimeUs.store(us); }
+
+    [[nodiscard]] uint32_t getRequestCount() const noexcept { return _requests.load(); }
+    [[nodiscard]] uint32_t getConnectionCount() const noexcept { return _connections.load(); }
+
+private:
+    struct Client {
+        int fd;
+        uint8_t rx[rtu::MAX_FRAME_BYTES];
+        size_t rxLength;
+    };
+
+    void run();
+    void serve(Client& client);
+    size_t answer(const uint8_t* request, uint8_t* response);
+
+    int _listenFd;
+    uint16_t _port;
+    std::thread _thread;
+    std::atomic<bool> _running;
+    std::atomic<uint32_t> _serviceTimeUs;
+    std::atomic<uint32_t> _requests;
+    std::atomic<uint32_t> _connections;
+    std::mutex _mutex;
+    std::map<uint32_t, uint16_t> _registers;    // (unit << 16) | reg
+    bool _silent[256];
+    std::vector<Client> _clients;
+};
+
+} // namespace andrtf3
+
+#endif // __linux__
+
+#endif // ANDRTF3_RTU_TCP_H
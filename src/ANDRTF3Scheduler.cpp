@@ -0,0 +1,295 @@
+/*
+ * ANDRTF3Scheduler.cpp - part of the ESP32-ANDRTF3 library
+ *
+ * Copyright (C) 2025-2026 packerlschupfer
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "ANDRTF3Scheduler.h"
+
+namespace andrtf3 {
+
+// Failed sensors are retried after a quarter period until they look dead,
+// then fall back to the normal period so they don't hog the bus
+static constexpr uint8_t FAST_RETRY_LIMIT = 3;
+
+void SensorSlot::reset(uint8_t addr, uint32_t period, uint8_t prio, uint8_t zoneId) {
+    address = addr;
+    priority = prio;
+    zone = zoneId;
+    consecutiveFailures = 0;
+    hasReading = false;
+    periodMs = period;
+    currentPeriodMs = period;
+    nextDueMs = 0;
+    lastAttemptMs = 0;
+    lastSuccessMs = 0;
+    rttEwmaMs = 0;
+    errorEwmaPermille = 0;
+    lastValue = 0;
+    previousValue = 0;
+}
+
+void SensorSlot::recordResult(bool success, int16_t value, uint32_t rttMs, uint32_t nowMs) {
+    lastAttemptMs = nowMs;
+
+    // Failure rate EWMA with alpha = 1/8
+    errorEwmaPermille = static_cast<uint16_t>((7u * errorEwmaPermille + (success ? 0u : 1000u)) / 8u);
+
+    if (success) {
+        // EWMA with alpha = 1/4, seeded by the first sample
+        if (rttEwmaMs == 0) {
+            rttEwmaMs = static_cast<uint16_t>(rttMs);
+        } else {
+            rttEwmaMs = static_cast<uint16_t>((3u * rttEwmaMs + rttMs) / 4u);
+        }
+        previousValue = hasReading ? lastValue : value;
+        lastValue = value;
+        lastSuccessMs = nowMs;
+        hasReading = true;
+        consecutiveFailures = 0;
+        nextDueMs = nowMs + currentPeriodMs;
+    } else {
+        if (consecutiveFailures < 0xFF) {
+            consecutiveFailures++;
+        }
+        nextDueMs = nowMs + ((consecutiveFailures < FAST_RETRY_LIMIT)
+                             ? currentPeriodMs / 4 : currentPeriodMs);
+    }
+}
+
+// ========== RoundRobinPolicy ==========
+
+int RoundRobinPolicy::selectNext(SensorSlot* slots, size_t count, uint32_t nowMs) {
+    for (size_t n = 0; n < count; n++) {
+        size_t i = (_cursor + n) % count;
+        if (timeReached(nowMs, slots[i].nextDueMs)) {
+            _cursor = (i + 1) % count;
+            return static_cast<int>(i);
+        }
+    }
+    return -1;
+}
+
+// ========== EdfPolicy ==========
+
+int EdfPolicy::selectNext(SensorSlot* slots, size_t count, uint32_t nowMs) {
+    int best = -1;
+    uint32_t bestDeadline = 0;
+
+    for (size_t i = 0; i < count; i++) {
+        if (!timeReached(nowMs + _lookaheadMs, slots[i].nextDueMs)) {
+            continue;
+        }
+        // A sensor without a reading is already past its deadline
+        uint32_t deadline = slots[i].hasReading ? slots[i].deadlineMs() : nowMs - slots[i].periodMs;
+        if (best < 0 || static_cast<int32_t>(deadline - bestDeadline) < 0) {
+            best = static_cast<int>(i);
+            bestDeadline = deadline;
+        }
+    }
+    return best;
+}
+
+// ========== AdaptiveRatePolicy ==========
+
+int AdaptiveRatePolicy::selectNext(SensorSlot* slots, size_t count, uint32_t nowMs) {
+    // Most overdue first
+    int best = -1;
+    int32_t bestLate = 0;
+
+    for (size_t i = 0; i < count; i++) {
+        int32_t late = static_cast<int32_t>(nowMs - slots[i].nextDueMs);
+        if (late >= 0 && (best < 0 || late > bestLate)) {
+            best = static_cast<int>(i);
+            bestLate = late;
+        }
+    }
+    return best;
+}
+
+void AdaptiveRatePolicy::onResult(SensorSlot& slot, bool success, uint32_t nowMs) {
+    if (!success) {
+        slot.currentPeriodMs = slot.periodMs;
+        return;
+    }
+
+    int16_t delta = slot.lastValue - slot.previousValue;
+    if (delta < 0) {
+        delta = -delta;
+    }
+
+    if (delta <= _stableBand) {
+        uint32_t maxPeriod = slot.periodMs * _maxStretch;
+        slot.currentPeriodMs += slot.periodMs / 2;
+        if (slot.currentPeriodMs > maxPeriod) {
+            slot.currentPeriodMs = maxPeriod;
+        }
+    } else {
+        slot.currentPeriodMs = slot.periodMs;
+    }
+    slot.nextDueMs = nowMs + slot.currentPeriodMs;
+}
+
+// ========== PriorityLanePolicy ==========
+
+int PriorityLanePolicy::selectNext(SensorSlot* slots, size_t count, uint32_t nowMs) {
+    // Critical lane: highest priority, then most overdue
+    int best = -1;
+    for (size_t i = 0; i < count; i++) {
+        if (slots[i].priority == 0 || !timeReached(nowMs, slots[i].nextDueMs)) {
+            continue;
+        }
+        if (best < 0 || slots[i].priority > slots[best].priority ||
+            (slots[i].priority == slots[best].priority &&
+             static_cast<int32_t>(slots[i].nextDueMs - slots[best].nextDueMs) < 0)) {
+            best = static_cast<int>(i);
+        }
+    }
+    if (best >= 0) {
+        return best;
+    }
+
+    // Normal lane: round-robin
+    for (size_t n = 0; n < count; n++) {
+        size_t i = (_cursor + n) % count;
+        if (slots[i].priority == 0 && timeReached(nowMs, slots[i].nextDueMs)) {
+            _cursor = (i + 1) % count;
+            return static_cast<int>(i);
+        }
+    }
+    return -1;
+}
+
+// ========== ProfiledSweepPolicy ==========
+
+int ProfiledSweepPolicy::selectNext(SensorSlot* slots, size_t count, uint32_t nowMs) {
+    if (count > MAX_SLOTS) {
+        count = MAX_SLOTS;
+    }
+
+    // Critical sensors never wait for the sweep
+    int critical = -1;
+    for (size_t i = 0; i < count; i++) {
+        if (slots[i].priority > 0 && timeReached(nowMs, slots[i].nextDueMs) &&
+            (critical < 0 || slots[i].priority > slots[critical].priority)) {
+            critical = static_cast<int>(i);
+        }
+    }
+    if (critical >= 0) {
+        return critical;
+    }
+
+    for (int pass = 0; pass < 2; pass++) {
+        for (size_t k = _cursor; k < _orderLength; k++) {
+            uint8_t i = _order[k];
+            if (i < count && timeReached(nowMs, slots[i].nextDueMs)) {
+                _cursor = k + 1;
+                return i;
+            }
+        }
+        if (pass > 0) {
+            break;
+        }
+
+        // Sweep finished. Re-plan from the latest profiles only once a new
+        // sweep actually starts, not on every idle call.
+        bool anyDue = false;
+        for (size_t i = 0; i < count && !anyDue; i++) {
+            anyDue = slots[i].priority == 0 && timeReached(nowMs, slots[i].nextDueMs);
+        }
+        if (!anyDue) {
+            break;
+        }
+        if (profilesDrifted(slots, count)) {
+            rebuildOrder(slots, count);
+        }
+        _cursor = 0;
+    }
+    return -1;
+}
+
+bool ProfiledSweepPolicy::profilesDrifted(const SensorSlot* slots, size_t count) const {
+    if (count != _plannedCount) {
+        return true;
+    }
+    for (size_t i = 0; i < count; i++) {
+        uint32_t planned = _plannedCostMs[i];
+        uint32_t cost = slots[i].expectedCostMs();
+        uint32_t diff = (cost > planned) ? cost - planned : planned - cost;
+        if (diff * 4 > planned) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void ProfiledSweepPolicy::rebuildOrder(const SensorSlot* slots, size_t count) {
+    // Sort by expected cost (insertion sort, runs once per sweep)
+    uint8_t sorted[MAX_SLOTS];
+    size_t n = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (slots[i].priority > 0) {
+            continue;  // Served by the critical path
+        }
+        uint32_t cost = slots[i].expectedCostMs();
+        size_t pos = n;
+        while (pos > 0 && slots[sorted[pos - 1]].expectedCostMs() > cost) {
+            sorted[pos] = sorted[pos - 1];
+            pos--;
+        }
+        sorted[pos] = static_cast<uint8_t>(i);
+        n++;
+    }
+
+    // Greedy zone interleave: cheapest remaining sensor not in the zone just
+    // read, as long as it costs at most 25% more (slow responders stay batched)
+    bool taken[MAX_SLOTS] = {};
+    int lastZone = -1;
+    _orderLength = 0;
+    for (size_t k = 0; k < n; k++) {
+        size_t pick = n;
+        uint32_t limit = 0;
+        for (size_t j = 0; j < n; j++) {
+            if (taken[j]) {
+                continue;
+            }
+            uint32_t cost = slots[sorted[j]].expectedCostMs();
+            if (pick == n) {
+                pick = j;  // Fallback: cheapest remaining
+                limit = cost + cost / 4;
+            } else if (cost > limit) {
+                break;
+            }
+            if (slots[sorted[j]].zone != lastZone) {
+                pick = j;
+                break;
+            }
+        }
+        taken[pick] = true;
+        lastZone = slots[sorted[pick]].zone;
+        _order[_orderLength++] = sorted[pick];
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        uint32_t cost = slots[i].expectedCostMs();
+        _plannedCostMs[i] = static_cast<uint16_t>(cost > 0xFFFF ? 0xFFFF : cost);
+    }
+    _plannedCount = count;
+}
+
+} // namespace andrtf3
@@ -0,0 +1,219 @@
+/*
+ * ANDRTF3Scheduler.h - part of the ESP32-ANDRTF3 library
+ *
+ * Copyright (C) 2025-2026 packerlschupfer
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#ifndef ANDRTF3_SCHEDULER_H
+#define ANDRTF3_SCHEDULER_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+
+namespace andrtf3 {
+
+/**
+ * Wrap-safe "has time t been reached" check for 32-bit millisecond clocks.
+ */
+inline bool timeReached(uint32_t nowMs, uint32_t t) {
+    return static_cast<int32_t>(nowMs - t) >= 0;
+}
+
+// Deadline word of an empty read queue; a real deadline of 0 is kept as 1
+constexpr uint32_t NO_DEADLINE = 0;
+
+/**
+ * Raise a queued read's deadline to deadlineMs unless it is already later.
+ *
+ * A compare-and-swap loop, so concurrent requesters always leave the latest
+ * of their deadlines behind, whatever order their stores land in.
+ */
+inline void raiseDeadline(std::atomic<uint32_t>& deadline, uint32_t deadlineMs) {
+    if (deadlineMs == NO_DEADLINE) {
+        deadlineMs = 1;
+    }
+    uint32_t current = deadline.load();
+    while ((current == NO_DEADLINE || timeReached(deadlineMs, current)) &&
+           !deadline.compare_exchange_weak(current, deadlineMs)) {
+    }
+}
+
+/**
+ * Per-sensor scheduling state
+ *
+ * Shared by ANDRTF3Poller (real bus, millis() clock) and BusSimulator
+ * (virtual clock), so a policy sees exactly the same inputs in both.
+ */
+struct SensorSlot {
+    uint8_t address;              // Modbus address
+    uint8_t priority;             // 0 = normal lane, >0 = critical lane
+    uint8_t zone;                 // Room/zone the sensor belongs to
+    uint8_t consecutiveFailures;
+    bool hasReading;              // At least one successful read
+    uint32_t periodMs;            // Requested refresh period
+    uint32_t currentPeriodMs;     // Effective period (adaptive policies stretch it)
+    uint32_t nextDueMs;           // When the sensor should be polled next
+    uint32_t lastAttemptMs;
+    uint32_t lastSuccessMs;
+    uint16_t rttEwmaMs;           // Smoothed response time, 0 = unknown
+    uint16_t errorEwmaPermille;   // Smoothed failure rate (per 1000 reads)
+    int16_t lastValue;            // Last good reading (deci-degrees)
+    int16_t previousValue;        // Reading before lastValue
+
+    void reset(uint8_t addr, uint32_t period, uint8_t prio, uint8_t zoneId = 0);
+
+    /**
+     * Common bookkeeping after a transaction. Policies may adjust
+     * nextDueMs afterwards in SchedulePolicy::onResult().
+     */
+    void recordResult(bool success, int16_t value, uint32_t rttMs, uint32_t nowMs);
+
+    // Latest time the current reading is considered fresh
+    uint32_t deadlineMs() const { return lastSuccessMs + periodMs; }
+
+    // Expected bus time of one read including retries caused by errors
+    uint32_t expectedCostMs() const {
+        uint32_t rtt = (rttEwmaMs > 0) ? rttEwmaMs : 80;
+        return rtt + (rtt * errorEwmaPermille) / 1000u;
+    }
+};
+
+/**
+ * Scheduler policy interface
+ *
+ * A policy decides which sensor goes on the bus next. It never performs I/O;
+ * the poller (or the simulator) runs the transaction and reports back.
+ */
+class SchedulePolicy {
+public:
+    virtual ~SchedulePolicy() = default;
+
+    virtual const char* name() const = 0;
+
+    // Called when the slot set changes or a simulation starts
+    virtual void reset() {}
+
+    /**
+     * @return index of the slot to poll now, or -1 if nothing is due
+     */
+    virtual int selectNext(SensorSlot* slots, size_t count, uint32_t nowMs) = 0;
+
+    // Called after SensorSlot::recordResult()
+    virtual void onResult(SensorSlot& slot, bool success, uint32_t nowMs) {
+        (void)slot; (void)success; (void)nowMs;
+    }
+};
+
+/**
+ * Fixed cyclic order; a sensor is polled once its period has elapsed.
+ */
+class RoundRobinPolicy : public SchedulePolicy {
+public:
+    const char* name() const override { return "round-robin"; }
+    void reset() override { _cursor = 0; }
+    int selectNext(SensorSlot* slots, size_t count, uint32_t nowMs) override;
+
+private:
+    size_t _cursor = 0;
+};
+
+/**
+ * Earliest-deadline-first. Sensors become eligible slightly before they are
+ * due (lookahead) so the bus is kept busy with the most urgent reading.
+ */
+class EdfPolicy : public SchedulePolicy {
+public:
+    explicit EdfPolicy(uint32_t lookaheadMs = 100) : _lookaheadMs(lookaheadMs) {}
+    const char* name() const override { return "edf"; }
+    int selectNext(SensorSlot* slots, size_t count, uint32_t nowMs) override;
+
+private:
+    uint32_t _lookaheadMs;
+};
+
+/**
+ * Stretches the period of sensors whose value is stable (room temperature
+ * changes slowly) and snaps back to the base period on any change.
+ */
+class AdaptiveRatePolicy : public SchedulePolicy {
+public:
+    AdaptiveRatePolicy(uint8_t maxStretch = 4, int16_t stableBand = 1)
+        : _maxStretch(maxStretch), _stableBand(stableBand) {}
+    const char* name() const override { return "adaptive-rate"; }
+    int selectNext(SensorSlot* slots, size_t count, uint32_t nowMs) override;
+    void onResult(SensorSlot& slot, bool success, uint32_t nowMs) override;
+
+private:
+    uint8_t _maxStretch;
+    int16_t _stableBand;          // deci-degrees considered "no change"
+};
+
+/**
+ * Two lanes: due sensors with priority > 0 always go first, the normal
+ * lane is served round-robin in the remaining bus time.
+ */
+class PriorityLanePolicy : public SchedulePolicy {
+public:
+    const char* name() const override { return "priority-lane"; }
+    void reset() override { _cursor = 0; }
+    int selectNext(SensorSlot* slots, size_t count, uint32_t nowMs) override;
+
+private:
+    size_t _cursor = 0;
+};
+
+/**
+ * Sweep ordering from learned response profiles
+ *
+ * Due critical sensors are served immediately. Everything else is read in
+ * a per-sweep order rebuilt from SensorSlot::expectedCostMs(): fast, reliable
+ * sensors first and slow or error-prone responders batched at the end
+ * (shortest-job-first minimizes mean staleness), with consecutive reads
+ * hopping between zones so no zone waits for a whole block of another.
+ *
+ * The order is kept from sweep to sweep unless a profile drifts by more than
+ * 25%; moving a sensor from the front to the back of the sweep would age its
+ * reading by almost a full sweep.
+ */
+class ProfiledSweepPolicy : public SchedulePolicy {
+public:
+    static constexpr size_t MAX_SLOTS = 64;
+
+    const char* name() const override { return "profiled-sweep"; }
+    void reset() override { _cursor = 0; _orderLength = 0; _plannedCount = 0; }
+    int selectNext(SensorSlot* slots, size_t count, uint32_t nowMs) override;
+
+    // Current sweep order (slot indices), for diagnostics
+    [[nodiscard]] const uint8_t* getOrder() const noexcept { return _order; }
+    [[nodiscard]] size_t getOrderLength() const noexcept { return _orderLength; }
+
+private:
+    bool profilesDrifted(const SensorSlot* slots, size_t count) const;
+    void rebuildOrder(const SensorSlot* slots, size_t count);
+
+    uint8_t _order[MAX_SLOTS] = {};
+    uint16_t _plannedCostMs[MAX_SLOTS] = {};  // Cost each slot was planned with
+    size_t _orderLength = 0;
+    size_t _plannedCount = 0;
+    size_t _cursor = 0;
+};
+
+} // namespace andrtf3
+
+#endif // ANDRTF3_SCHEDULER_H
@@ -0,0 +1,325 @@
+/*
+ * ANDRTF3Simulator.cpp - part of the ESP32-ANDRTF3 library
+ *
+ * Copyright (C) 2025-2026 packerlschupfer
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "ANDRTF3Simulator.h"
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <new>
+
+namespace andrtf3 {
+
+namespace {
+
+// Large state lives on the heap; a simulation is too big for a task stack
+struct SimState {
+    SensorSlot slots[BusSimulator::MAX_SENSORS];
+    uint32_t attempts[BusSimulator::MAX_SENSORS];
+    bool missed[BusSimulator::MAX_SENSORS];
+    uint32_t staleHistogram[BusSimulator::STALE_BUCKETS];
+    uint32_t staleSamples;
+    uint64_t staleSumMs;
+    uint64_t zoneWaitSumMs[BusSimulator::MAX_ZONES];
+    uint32_t zoneReads[BusSimulator::MAX_ZONES];
+};
+
+// Stateless 32-bit mixer (lowbias32) - outcome of read n of sensor i
+uint32_t mix(uint32_t seed, uint32_t sensor, uint32_t attempt) {
+    uint32_t x = seed ^ (sensor * 0x9E3779B9u) ^ (attempt * 0x85EBCA6Bu);
+    x ^= x >> 16;
+    x *= 0x7FEB352Du;
+    x ^= x >> 15;
+    x *= 0x846CA68Bu;
+    x ^= x >> 16;
+    return x;
+}
+
+bool faultActive(const SimScenario& sc, size_t sensor, uint32_t nowMs) {
+    for (size_t f = 0; f < sc.faultCount; f++) {
+        const SimFault& fault = sc.faults[f];
+        if (fault.sensorIndex == sensor && nowMs >= fault.startMs && nowMs < fault.endMs) {
+            return true;
+        }
+    }
+    return false;
+}
+
+uint32_t ageAt(const SensorSlot& slot, uint32_t nowMs) {
+    return nowMs - (slot.hasReading ? slot.lastSuccessMs : 0);
+}
+
+void sampleStaleness(const SimScenario& sc, SimState& st, uint32_t nowMs) {
+    for (size_t i = 0; i < sc.sensorCount; i++) {
+        uint32_t age = ageAt(st.slots[i], nowMs);
+        size_t bucket = age / BusSimulator::STALE_BUCKET_MS;
+        if (bucket >= BusSimulator::STALE_BUCKETS) {
+            bucket = BusSimulator::STALE_BUCKETS - 1;
+        }
+        st.staleHistogram[bucket]++;
+        st.staleSamples++;
+        st.staleSumMs += age;
+    }
+}
+
+void checkDeadlines(const SimScenario& sc, SimState& st, uint32_t nowMs, uint32_t& misses) {
+    for (size_t i = 0; i < sc.sensorCount; i++) {
+        if (!st.missed[i] && ageAt(st.slots[i], nowMs) > st.slots[i].periodMs + sc.timeoutMs) {
+            st.missed[i] = true;
+            misses++;
+        }
+    }
+}
+
+uint32_t percentile(const SimState& st, uint32_t permille) {
+    if (st.staleSamples == 0) {
+        return 0;
+    }
+    uint64_t target = (static_cast<uint64_t>(st.staleSamples) * permille + 999) / 1000;
+    uint64_t seen = 0;
+    for (size_t b = 0; b < BusSimulator::STALE_BUCKETS; b++) {
+        seen += st.staleHistogram[b];
+        if (seen >= target) {
+            return static_cast<uint32_t>((b + 1) * BusSimulator::STALE_BUCKET_MS);
+        }
+    }
+    return BusSimulator::STALE_BUCKETS * BusSimulator::STALE_BUCKET_MS;
+}
+
+// Standard deviation of the per-zone mean wait
+uint32_t zoneSpread(const SimState& st) {
+    double sum = 0.0;
+    double sumSq = 0.0;
+    size_t zones = 0;
+    for (size_t z = 0; z < BusSimulator::MAX_ZONES; z++) {
+        if (st.zoneReads[z] == 0) {
+            continue;
+        }
+        double mean = static_cast<double>(st.zoneWaitSumMs[z]) / st.zoneReads[z];
+        sum += mean;
+        sumSq += mean * mean;
+        zones++;
+    }
+    if (zones < 2) {
+        return 0;
+    }
+    double avg = sum / zones;
+    double variance = sumSq / zones - avg * avg;
+    return (variance > 0.0) ? static_cast<uint32_t>(sqrt(variance)) : 0;
+}
+
+} // namespace
+
+SimScenario BusSimulator::makeScenario(const SimSensorModel* sensors, size_t count,
+                                       uint32_t durationMs) {
+    SimScenario sc;
+    sc.sensors = sensors;
+    sc.sensorCount = count;
+    sc.faults = nullptr;
+    sc.faultCount = 0;
+    sc.durationMs = durationMs;
+    sc.timeoutMs = 200;
+    sc.interFrameGapMs = 4;      // 3.5 characters at 9600 baud, rounded up
+    sc.sampleIntervalMs = 100;
+    sc.idleStepMs = 10;
+    sc.tickMs = 0;
+    sc.seed = 1;
+    return sc;
+}
+
+bool BusSimulator::run(const SimScenario& sc, SchedulePolicy& policy, SimResult& result,
+                       GapTuner* tuner) {
+    memset(&result, 0, sizeof(result));
+    result.policy = policy.name();
+
+    if (sc.sensors == nullptr || sc.sensorCount == 0 || sc.sensorCount > MAX_SENSORS ||
+        sc.durationMs == 0 || sc.sampleIntervalMs == 0 || sc.idleStepMs == 0) {
+        return false;
+    }
+    for (size_t i = 0; i < sc.sensorCount; i++) {
+        if (sc.sensors[i].zone >= MAX_ZONES) {
+            return false;
+        }
+    }
+
+    SimState* st = new (std::nothrow) SimState();
+    if (st == nullptr) {
+        return false;
+    }
+
+    for (size_t i = 0; i < sc.sensorCount; i++) {
+        const SimSensorModel& model = sc.sensors[i];
+        st->slots[i].reset(model.address, model.periodMs, model.priority, model.zone);
+    }
+    policy.reset();
+    if (tuner != nullptr) {
+        tuner->reset();
+    }
+
+    const uint64_t allVisited = (sc.sensorCount == 64) ? ~0ULL : ((1ULL << sc.sensorCount) - 1);
+    uint64_t visited = 0;
+    uint32_t sweepStart = 0;
+    uint64_t sweepTotal = 0;
+    uint64_t busyMs = 0;
+    uint64_t gapSumMs = 0;
+    uint64_t waitSumMs = 0;
+    uint32_t successes = 0;
+    uint32_t nextSample = 0;
+    uint32_t now = 0;
+
+    auto sampleUntil = [&](uint32_t end) {
+        while (timeReached(end, nextSample) && nextSample < sc.durationMs) {
+            sampleStaleness(sc, *st, nextSample);
+            checkDeadlines(sc, *st, nextSample, result.deadlineMisses);
+            nextSample += sc.sampleIntervalMs;
+        }
+    };
+
+    while (now < sc.durationMs) {
+        int index = policy.selectNext(st->slots, sc.sensorCount, now);
+        uint32_t end;
+
+        if (index < 0) {
+            end = now + sc.idleStepMs;
+        } else {
+            const SimSensorModel& model = sc.sensors[index];
+            uint32_t r = mix(sc.seed, static_cast<uint32_t>(index), st->attempts[index]++);
+
+            // The idle gap precedes the request frame
+            uint32_t gap = (tuner != nullptr) ? tuner->getGapMs(index) : sc.interFrameGapMs;
+            gapSumMs += gap;
+            now += gap;
+
+            bool success;
+            uint32_t duration;
+            if (faultActive(sc, index, now)) {
+                success = false;
+                duration = sc.timeoutMs;
+            } else {
+                uint32_t errorPermille = model.errorPermille;
+                if (gap < model.minGapMs && errorPermille < 500) {
+                    errorPermille = 500;
+                }
+                success = (r % 1000) >= errorPermille;
+                duration = model.latencyMs + ((model.jitterMs > 0) ? (r >> 10) % (model.jitterMs + 1u) : 0);
+            }
+            end = now + duration;
+            busyMs += duration;
+
+            // Samples taken while the frame is on the wire see the old state
+            sampleUntil(end);
+
+            // Slowly changing room temperature, different per sensor
+            int16_t value = static_cast<int16_t>(200 + ((now / (30000u + 1000u * index)) % 5));
+            SensorSlot& slot = st->slots[index];
+            // Policies with lookahead may read slightly before the due time
+            int32_t early = static_cast<int32_t>((now + duration) - slot.nextDueMs);
+            uint32_t wait = (early > 0) ? static_cast<uint32_t>(early) : 0;
+            slot.recordResult(success, value, duration, now + duration);
+            policy.onResult(slot, success, now + duration);
+            if (tuner != nullptr) {
+                tuner->onResult(index, success, duration);
+            }
+            if (sc.tickMs > 0) {
+                // Coordinator-driven polling: due on the first tick at or
+                // before the requested time, but never in the past
+                uint32_t due = (slot.nextDueMs / sc.tickMs) * sc.tickMs;
+                if (due <= now + duration) {
+                    due += sc.tickMs;
+                }
+                slot.nextDueMs = due;
+            }
+            if (success) {
+                st->missed[index] = false;
+                waitSumMs += wait;
+                successes++;
+                st->zoneWaitSumMs[model.zone] += wait;
+                st->zoneReads[model.zone]++;
+            } else {
+                result.failures++;
+            }
+            result.transactions++;
+
+            visited |= (1ULL << index);
+            if (visited == allVisited) {
+                result.sweeps++;
+                sweepTotal += (now + duration) - sweepStart;
+                sweepStart = now + duration;
+                visited = 0;
+            }
+        }
+
+        sampleUntil(end);
+        now = end;
+    }
+
+    result.meanSweepMs = (result.sweeps > 0) ? static_cast<uint32_t>(sweepTotal / result.sweeps) : 0;
+    result.staleP50Ms = percentile(*st, 500);
+    result.staleP95Ms = percentile(*st, 950);
+    result.staleP99Ms = percentile(*st, 990);
+    result.meanStaleMs = (st->staleSamples > 0) ? static_cast<uint32_t>(st->staleSumMs / st->staleSamples) : 0;
+    result.meanWaitMs = (successes > 0) ? static_cast<uint32_t>(waitSumMs / successes) : 0;
+    result.zoneSpreadMs = zoneSpread(*st);
+    result.busUtilPermille = static_cast<uint16_t>((busyMs * 1000) / now);
+    result.meanGapMs = (result.transactions > 0) ? static_cast<uint16_t>(gapSumMs / result.transactions) : 0;
+
+    delete st;
+    return true;
+}
+
+size_t BusSimulator::formatTable(const SimResult* results, size_t count, char* buffer, size_t size) {
+    if (buffer == nullptr || size == 0) {
+        return 0;
+    }
+
+    size_t used = 0;
+    auto append = [&](int n) {
+        if (n > 0) {
+            used += static_cast<size_t>(n);
+            if (used >= size) {
+                used = size - 1;
+            }
+        }
+    };
+
+    append(snprintf(buffer, size, "%-14s %9s %6s %6s %7s %7s %7s %7s %7s %7s %6s %6s\n",
+                    "policy", "sweep_ms", "reads", "misses", "age_ms", "p50_ms", "p95_ms", "p99_ms",
+                    "wait_ms", "zone_sd", "bus%", "gap_ms"));
+    for (size_t i = 0; i < count; i++) {
+        const SimResult& r = results[i];
+        append(snprintf(buffer + used, size - used,
+                        "%-14s %9lu %6lu %6lu %7lu %7lu %7lu %7lu %7lu %7lu %4u.%u %6u\n",
+                        r.policy ? r.policy : "?",
+                        static_cast<unsigned long>(r.meanSweepMs),
+                        static_cast<unsigned long>(r.transactions),
+                        static_cast<unsigned long>(r.deadlineMisses),
+                        static_cast<unsigned long>(r.meanStaleMs),
+                        static_cast<unsigned long>(r.staleP50Ms),
+                        static_cast<unsigned long>(r.staleP95Ms),
+                        static_cast<unsigned long>(r.staleP99Ms),
+                        static_cast<unsigned long>(r.meanWaitMs),
+                        static_cast<unsigned long>(r.zoneSpreadMs),
+                        r.busUtilPermille / 10u, r.busUtilPermille % 10u,
+                        static_cast<unsigned>(r.meanGapMs)));
+    }
+    return used;
+}
+
+} // namespace andrtf3
@@ -0,0 +1,133 @@
+/*
+ * ANDRTF3Simulator.h - part of the ESP32-ANDRTF3 library
+ *
+ * Copyright (C) 2025-2026 packerlschupfer
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#ifndef ANDRTF3_SIMULATOR_H
+#define ANDRTF3_SIMULATOR_H
+
+#include "ANDRTF3Scheduler.h"
+#include "ANDRTF3GapTuner.h"
+
+namespace andrtf3 {
+
+/**
+ * Simulated sensor on the bus
+ */
+struct SimSensorModel {
+    uint8_t address;
+    uint8_t priority;              // Passed to SensorSlot::priority
+    uint8_t zone;                  // Grouping for per-zone statistics (< MAX_ZONES)
+    uint32_t periodMs;             // Requested refresh period
+    uint16_t latencyMs;            // Typical response time (60-90ms on real hardware)
+    uint16_t jitterMs;             // Uniform 0..jitterMs added to latencyMs
+    uint16_t errorPermille;        // Garbled/CRC-failed frames per 1000 reads
+    uint16_t minGapMs;             // Shorter preceding bus idle time garbles half the frames
+};
+
+/**
+ * Sensor silent (every read times out) during [startMs, endMs)
+ */
+struct SimFault {
+    uint8_t sensorIndex;
+    uint32_t startMs;
+    uint32_t endMs;
+};
+
+struct SimScenario {
+    const SimSensorModel* sensors;
+    size_t sensorCount;
+    const SimFault* faults;
+    size_t faultCount;
+    uint32_t durationMs;
+    uint16_t timeoutMs;            // Cost of a read to a silent sensor
+    uint16_t interFrameGapMs;      // Bus idle time before each transaction
+    uint32_t sampleIntervalMs;     // Staleness sampling interval
+    uint32_t idleStepMs;           // Clock advance when nothing is due
+    uint32_t tickMs;               // >0: sensors only become due on coordinator ticks
+    uint32_t seed;                 // Same seed = same trace for every policy
+};
+
+/**
+ * One row of the comparison table
+ */
+struct SimResult {
+    const char* policy;
+    uint32_t transactions;
+    uint32_t failures;
+    uint32_t sweeps;               // Completed "every sensor attempted" rounds
+    uint32_t meanSweepMs;
+    uint32_t deadlineMisses;       // Readings that aged past periodMs + timeoutMs
+    uint32_t staleP50Ms;
+    uint32_t staleP95Ms;
+    uint32_t staleP99Ms;
+    uint32_t meanStaleMs;          // Mean reading age
+    uint32_t meanWaitMs;           // Mean delay from "due" to delivered reading
+    uint32_t zoneSpreadMs;         // Std deviation of the per-zone mean wait
+    uint16_t busUtilPermille;      // Time the bus carried a transaction
+    uint16_t meanGapMs;            // Average idle gap before a transaction
+};
+
+/**
+ * Discrete-event bus simulator
+ *
+ * Runs a SchedulePolicy against modelled sensors on a virtual clock, so
+ * policies can be compared on identical traces without hardware. The outcome
+ * of the n-th read of a sensor depends only on (seed, sensor, n), never on the
+ * order a policy chooses, which keeps comparisons fair.
+ *
+ * Example usage:
+ * @code
+ * RoundRobinPolicy rr;
+ * EdfPolicy edf;
+ * SchedulePolicy* policies[] = { &rr, &edf };
+ * SimResult results[2];
+ * for (size_t i = 0; i < 2; i++) BusSimulator::run(scenario, *policies[i], results[i]);
+ * char table[512];
+ * BusSimulator::formatTable(results, 2, table, sizeof(table));
+ * @endcode
+ */
+class BusSimulator {
+public:
+    static constexpr size_t MAX_SENSORS = 64;
+    static constexpr uint32_t STALE_BUCKET_MS = 100;
+    static constexpr size_t STALE_BUCKETS = 600;   // 60s range, last bucket open-ended
+    static constexpr size_t MAX_ZONES = 32;
+
+    // Scenario with sensible defaults for the timing fields
+    static SimScenario makeScenario(const SimSensorModel* sensors, size_t count,
+                                    uint32_t durationMs = 600000);
+
+    /**
+     * @param tuner  optional; replaces the fixed interFrameGapMs with tuned gaps
+     * @return false if the scenario is invalid or memory is exhausted
+     */
+    [[nodiscard]] static bool run(const SimScenario& scenario, SchedulePolicy& policy,
+                                  SimResult& result, GapTuner* tuner = nullptr);
+
+    /**
+     * @brief Render results as a fixed-width text table
+     * @return number of characters written (excluding terminator)
+     */
+    static size_t formatTable(const SimResult* results, size_t count, char* buffer, size_t size);
+};
+
+} // namespace andrtf3
+
+#endif // ANDRTF3_SIMULATOR_H
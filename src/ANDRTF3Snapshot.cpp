@@ -0,0 +1,272 @@
+/*
+ * ANDRTF3Snapshot.cpp - part of the ESP32-ANDRTF3 library
+ *
+ * Copyright (C) 2025-2026 packerlschupfer
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "ANDRTF3Snapshot.h"
+#include "ANDRTF3Logging.h"
+#include <string.h>
+
+#if defined(__linux__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace andrtf3 {
+
+// The header is shared between processes, so the counter must not hide a lock
+static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t), "seqlock counter must be a plain word");
+static_assert(sizeof(FleetSnapshot::Record) == 8, "record layout is part of the shared format");
+
+// Bound the reader's retries so a stalled writer cannot hang it
+static constexpr uint32_t MAX_READ_ATTEMPTS = 1000;
+
+FleetSnapshot::FleetSnapshot()
+    : _header(nullptr),
+      _records(nullptr),
+      _mappedBytes(0),
+      _readOnly(false),
+      _batchDepth(0),
+      _retries(0) {
+}
+
+FleetSnapshot::~FleetSnapshot() {
+    detach();
+}
+
+bool FleetSnapshot::attach(void* memory, size_t bytes, uint16_t capacity) {
+    if (memory == nullptr || capacity == 0 || bytes < requiredBytes(capacity) ||
+        (reinterpret_cast<uintptr_t>(memory) % alignof(Header)) != 0) {
+        ANDRTF3_LOG_E("Snapshot: invalid buffer (%u bytes for %u records)",
+                      static_cast<unsigned>(bytes), static_cast<unsigned>(capacity));
+        return false;
+    }
+    detach();
+
+    memset(memory, 0, requiredBytes(capacity));
+    _header = static_cast<Header*>(memory);
+    _records = reinterpret_cast<Record*>(_header + 1);
+    _header->capacity = capacity;
+    _header->version = VERSION;
+    _header->sequence.store(0, std::memory_order_relaxed);
+    // Magic last: readers that map early see an unformatted segment
+    std::atomic_thread_fence(std::memory_order_release);
+    _header->magic = MAGIC;
+    return true;
+}
+
+#if defined(__linux__)
+bool FleetSnapshot::createShared(const char* name, uint16_t capacity) {
+    if (name == nullptr || capacity == 0) {
+        return false;
+    }
+    detach();
+
+    int fd = shm_open(name, O_CREAT | O_RDWR, 0644);
+    if (fd < 0) {
+        ANDRTF3_LOG_E("Snapshot: shm_open(%s) failed", name);
+        return false;
+    }
+    size_t bytes = requiredBytes(capacity);
+    if (ftruncate(fd, static_cast<off_t>(bytes)) != 0) {
+        ANDRTF3_LOG_E("Snapshot: ftruncate(%s) failed", name);
+        close(fd);
+        return false;
+    }
+    void* memory = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (memory == MAP_FAILED) {
+        ANDRTF3_LOG_E("Snapshot: mmap(%s) failed", name);
+        return false;
+    }
+
+    if (!attach(memory, bytes, capacity)) {
+        munmap(memory, bytes);
+        return false;
+    }
+    _mappedBytes = bytes;
+    return true;
+}
+
+bool FleetSnapshot::openShared(const char* name) {
+    if (name == nullptr) {
+        return false;
+    }
+    detach();
+
+    int fd = shm_open(name, O_RDONLY, 0);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(Header)) {
+        close(fd);
+        return false;
+    }
+    size_t bytes = static_cast<size_t>(st.st_size);
+    void* memory = mmap(nullptr, bytes, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (memory == MAP_FAILED) {
+        return false;
+    }
+
+    Header* header = static_cast<Header*>(memory);
+    if (header->magic != MAGIC || header->version != VERSION ||
+        bytes < requiredBytes(header->capacity)) {
+        ANDRTF3_LOG_W("Snapshot: %s is not a v%u snapshot", name, static_cast<unsigned>(VERSION));
+        munmap(memory, bytes);
+        return false;
+    }
+
+    _header = header;
+    _records = reinterpret_cast<Record*>(_header + 1);
+    _mappedBytes = bytes;
+    _readOnly = true;
+    return true;
+}
+
+void FleetSnapshot::unlinkShared(const char* name) {
+    if (name != nullptr) {
+        shm_unlink(name);
+    }
+}
+#endif
+
+void FleetSnapshot::detach() {
+#if defined(__linux__)
+    if (_mappedBytes != 0) {
+        munmap(_header, _mappedBytes);
+    }
+#endif
+    _header = nullptr;
+    _records = nullptr;
+    _mappedBytes = 0;
+    _readOnly = false;
+    _batchDepth = 0;
+}
+
+void FleetSnapshot::writeBegin() {
+    uint32_t seq = _header->sequence.load(std::memory_order_relaxed);
+    _header->sequence.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+}
+
+void FleetSnapshot::writeEnd() {
+    uint32_t seq = _header->sequence.load(std::memory_order_relaxed);
+    _header->sequence.store(seq + 1, std::memory_order_release);
+}
+
+void FleetSnapshot::beginBatch() {
+    if (_header != nullptr && !_readOnly && _batchDepth++ == 0) {
+        writeBegin();
+    }
+}
+
+void FleetSnapshot::endBatch() {
+    if (_header != nullptr && _batchDepth > 0 && --_batchDepth == 0) {
+        writeEnd();
+    }
+}
+
+void FleetSnapshot::publish(size_t index, uint8_t address, int16_t celsius, bool valid,
+                            uint32_t timestampMs) {
+    if (_header == nullptr || _readOnly || index >= _header->capacity) {
+        return;
+    }
+
+    if (_batchDepth == 0) {
+        writeBegin();
+    }
+    Record& r = _records[index];
+    r.address = address;
+    r.flags = valid ? FLAG_VALID : 0;
+    r.celsius = celsius;
+    r.timestampMs = timestampMs;
+    if (index >= _header->count) {
+        _header->count = static_cast<uint32_t>(index + 1);
+    }
+    _header->updatedMs = timestampMs;
+    if (_batchDepth == 0) {
+        writeEnd();
+    }
+}
+
+size_t FleetSnapshot::read(Record* out, size_t maxRecords, uint32_t* updatedMs) const {
+    if (_header == nullptr || out == nullptr) {
+        return 0;
+    }
+
+    for (uint32_t attempt = 0; attempt < MAX_READ_ATTEMPTS; attempt++) {
+        uint32_t before = _header->sequence.load(std::memory_order_acquire);
+        if (before & 1u) {
+            _retries.fetch_add(1, std::memory_order_relaxed);
+            continue;  // Writer active
+        }
+
+        size_t n = _header->count;
+        if (n > _header->capacity) {
+            n = _header->capacity;  // Torn count; the sequence check below rejects it
+        }
+        if (n > maxRecords) {
+            n = maxRecords;
+        }
+        memcpy(out, _records, n * sizeof(Record));
+        uint32_t stamp = _header->updatedMs;
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (_header->sequence.load(std::memory_order_relaxed) == before) {
+            if (updatedMs != nullptr) {
+                *updatedMs = stamp;
+            }
+            return n;
+        }
+        _retries.fetch_add(1, std::memory_order_relaxed);
+    }
+    return 0;
+}
+
+bool FleetSnapshot::readOne(size_t index, Record& out) const {
+    if (_header == nullptr || index >= _header->capacity) {
+        return false;
+    }
+
+    for (uint32_t attempt = 0; attempt < MAX_READ_ATTEMPTS; attempt++) {
+        uint32_t before = _header->sequence.load(std::memory_order_acquire);
+        if (before & 1u) {
+            continue;
+        }
+        Record copy;
+        memcpy(&copy, &_records[index], sizeof(Record));
+        bool inUse = index < _header->count;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (_header->sequence.load(std::memory_order_relaxed) == before) {
+            out = copy;
+            return inUse;
+        }
+    }
+    return false;
+}
+
+uint32_t FleetSnapshot::getSequence() const {
+    return (_header != nullptr) ? _header->sequence.load(std::memory_order_acquire) : 0;
+}
+
+} // namespace andrtf3
@@ -0,0 +1,158 @@
+/*
+ * ANDRTF3Snapshot.h - part of the ESP32-ANDRTF3 library
+ *
+ * Copyright (C) 2025-2026 packerlschupfer
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#ifndef ANDRTF3_SNAPSHOT_H
+#define ANDRTF3_SNAPSHOT_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+
+namespace andrtf3 {
+
+/**
+ * Fleet snapshot with a seqlock layout
+ *
+ * One writer (the bus task) publishes the latest reading of every sensor into
+ * a flat block of memory; any number of readers copy the whole table without
+ * locks. The writer makes the sequence counter odd while it writes and even
+ * when done, so a reader retries if the counter was odd or changed during its
+ * copy.
+ *
+ * The block is position-independent (header + record array, no pointers), so
+ * on Linux gateways it can live in POSIX shared memory: the writer calls
+ * createShared(), other processes call openShared() and then read() with no
+ * syscall per query. On the ESP32 attach() places it in a caller buffer for
+ * other tasks.
+ *
+ * Example usage:
+ * @code
+ * static uint8_t buf[FleetSnapshot::requiredBytes(32)];
+ * FleetSnapshot snapshot;
+ * snapshot.attach(buf, sizeof(buf), 32);
+ * poller.setSnapshot(&snapshot);
+ *
+ * // Any other task:
+ * FleetSnapshot::Record records[32];
+ * size_t n = snapshot.read(records, 32);
+ * @endcode
+ */
+class FleetSnapshot {
+public:
+    static constexpr uint32_t MAGIC = 0x33465452;   // "RTF3"
+    static constexpr uint16_t VERSION = 1;
+
+    // Record flags
+    static constexpr uint8_t FLAG_VALID = 0x01;
+
+    struct Record {
+        uint8_t address;
+        uint8_t flags;
+        int16_t celsius;            // Temperature * 10
+        uint32_t timestampMs;       // Writer's millis() at the reading
+    };
+
+    struct Header {
+        uint32_t magic;
+        uint16_t version;
+        uint16_t capacity;
+        std::atomic<uint32_t> sequence;   // Odd while a write is in progress
+        uint32_t count;                   // Records in use
+        uint32_t updatedMs;               // Time of the last publish
+    };
+
+    static constexpr size_t requiredBytes(uint16_t capacity) {
+        return sizeof(Header) + static_cast<size_t>(capacity) * sizeof(Record);
+    }
+
+    FleetSnapshot();
+    ~FleetSnapshot();
+
+    FleetSnapshot(const FleetSnapshot&) = delete;
+    FleetSnapshot& operator=(const FleetSnapshot&) = delete;
+
+    /**
+     * @brief Initialize a snapshot in caller-owned memory (writer side)
+     * @return false if the buffer is too small or misaligned
+     */
+    [[nodiscard]] bool attach(void* memory, size_t bytes, uint16_t capacity);
+
+#if defined(__linux__)
+    /**
+     * @brief Create (or replace) a POSIX shared-memory segment, writer side
+     * @param name shm_open() name, e.g. "/andrtf3-bus0"
+     */
+    [[nodiscard]] bool createShared(const char* name, uint16_t capacity);
+
+    // Map an existing segment read-only (reader processes)
+    [[nodiscard]] bool openShared(const char* name);
+
+    // Remove the segment name; existing mappings stay valid
+    static void unlinkShared(const char* name);
+#endif
+
+    void detach();
+    [[nodiscard]] bool isAttached() const noexcept { return _header != nullptr; }
+
+    // ---- Writer (single thread) ----
+
+    /**
+     * @brief Group several publish() calls under one sequence bump
+     *
+     * Readers then see either none or all of the batch.
+     */
+    void beginBatch();
+    void endBatch();
+
+    // Store one record; grows count to cover index
+    void publish(size_t index, uint8_t address, int16_t celsius, bool valid, uint32_t timestampMs);
+
+    // ---- Readers (any thread / process) ----
+
+    /**
+     * @brief Copy a consistent view of the table
+     * @return number of records copied (<= maxRecords), 0 if not attached
+     */
+    size_t read(Record* out, size_t maxRecords, uint32_t* updatedMs = nullptr) const;
+
+    // Copy one record; cheaper than read() when only one sensor is needed
+    [[nodiscard]] bool readOne(size_t index, Record& out) const;
+
+    // Changes whenever the table changes; readers can skip unchanged tables
+    [[nodiscard]] uint32_t getSequence() const;
+    [[nodiscard]] uint16_t getCapacity() const { return _header != nullptr ? _header->capacity : 0; }
+    [[nodiscard]] uint32_t getRetryCount() const noexcept { return _retries.load(std::memory_order_relaxed); }
+
+private:
+    void writeBegin();
+    void writeEnd();
+
+    Header* _header;
+    Record* _records;
+    size_t _mappedBytes;            // Non-zero when we own an mmap()
+    bool _readOnly;                 // Opened with openShared()
+    uint8_t _batchDepth;
+    mutable std::atomic<uint32_t> _retries;
+};
+
+} // namespace andrtf3
+
+#endif // ANDRTF3_SNAPSHOT_H
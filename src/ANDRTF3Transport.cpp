@@ -0,0 +1,105 @@
+/*
+ * ANDRTF3Transport.cpp - part of the ESP32-ANDRTF3 library
+ *
+ * Copyright (C) 2025-2026 packerlschupfer
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+
+#include "ANDRTF3Transport.h"
+
+namespace andrtf3 {
+
+uint16_t Transport::hashBusId(const char* text, uint32_t salt) {
+    uint32_t hash = 2166136261u ^ salt;     // FNV-1a
+    for (const char* c = (text != nullptr) ? text : ""; *c != '\0'; c++) {
+        hash ^= static_cast<uint8_t>(*c);
+        hash *= 16777619u;
+    }
+    uint16_t id = static_cast<uint16_t>(hash ^ (hash >> 16));
+    return (id != 0) ? id : 1;              // 0 is the local bus
+}
+
+namespace rtu {
+
+uint16_t crc16(const uint8_t* data, size_t length) {
+    uint16_t crc = 0xFFFF;
+    for (size_t i = 0; i < length; i++) {
+        crc ^= data[i];
+        for (uint8_t bit = 0; bit < 8; bit++) {
+            crc = (crc & 1) ? static_cast<uint16_t>((crc >> 1) ^ 0xA001) : static_cast<uint16_t>(crc >> 1);
+        }
+    }
+    return crc;
+}
+
+void buildReadRequest(uint8_t unit, uint8_t functionCode, uint16_t reg, uint16_t count, uint8_t* out) {
+    out[0] = unit;
+    out[1] = functionCode;
+    out[2] = static_cast<uint8_t>(reg >> 8);
+    out[3] = static_cast<uint8_t>(reg & 0xFF);
+    out[4] = static_cast<uint8_t>(count >> 8);
+    out[5] = static_cast<uint8_t>(count & 0xFF);
+    uint16_t crc = crc16(out, 6);
+    out[6] = static_cast<uint8_t>(crc & 0xFF);
+    out[7] = static_cast<uint8_t>(crc >> 8);
+}
+
+size_t responseLength(const uint8_t* head, size_t received) {
+    if (received >= 2 && (head[1] & 0x80) != 0) {
+        return EXCEPTION_BYTES;
+    }
+    if (received < 3) {
+        return 0;
+    }
+    return 3u + head[2] + 2u;
+}
+
+ModbusError parseReadResponse(const uint8_t* frame, size_t length, uint8_t unit,
+                              uint8_t functionCode, uint16_t count, uint16_t* out) {
+    if (length < EXCEPTION_BYTES) {
+        return ModbusError::INVALID_RESPONSE;
+    }
+    uint16_t crc = static_cast<uint16_t>(frame[length - 2] | (frame[length - 1] << 8));
+    if (crc != crc16(frame, length - 2)) {
+        return ModbusError::CRC_ERROR;
+    }
+    if (frame[0] != unit || (frame[1] & 0x7F) != functionCode) {
+        return ModbusError::INVALID_RESPONSE;
+    }
+
+    if ((frame[1] & 0x80) != 0) {
+        switch (frame[2]) {
+            case 0x01: return ModbusError::ILLEGAL_FUNCTION;
+            case 0x02: return ModbusError::ILLEGAL_DATA_ADDRESS;
+            case 0x03: return ModbusError::ILLEGAL_DATA_VALUE;
+            case 0x04: return ModbusError::SLAVE_DEVICE_FAILURE;
+            default:   return ModbusError::INVALID_RESPONSE;
+        }
+    }
+
+    if (frame[2] != count * 2 || length != 5u + frame[2]) {
+        return ModbusError::INVALID_DATA_LENGTH;
+    }
+    for (uint16_t i = 0; i < count; i++) {
+        out[i] = static_cast<uint16_t>((frame[3 + 2 * i] << 8) | frame[4 + 2 * i]);
+    }
+    return ModbusError::SUCCESS;
+}
+
+} // namespace rtu
+} // namespace andrtf3
@@ -0,0 +1,106 @@
+/*
+ * ANDRTF3Transport.h - part of the ESP32-ANDRTF3 library
+ *
+ * Copyright (C) 2025-2026 packerlschupfer
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+
+#ifndef ANDRTF3_TRANSPORT_H
+#define ANDRTF3_TRANSPORT_H
+
+#include <QueuedModbusDevice.h>
+#include <stdint.h>
+#include <stddef.h>
+
+namespace andrtf3 {
+
+using modbus::ModbusError;
+
+/**
+ * Alternative transport for ANDRTF3 reads
+ *
+ * By default the driver talks to the local RS485 bus through
+ * QueuedModbusDevice. A Transport set with ANDRTF3::setTransport() replaces
+ * that path (e.g. RtuTcpTransport to reach sensors behind an Ethernet serial
+ * server). Calls are blocking; implementations serialize concurrent callers
+ * themselves.
+ */
+class Transport {
+public:
+    virtual ~Transport() = default;
+
+    virtual const char* name() const = 0;
+
+    /**
+     * @brief Identity of the bus behind this transport
+     *
+     * Keys state that outlives driver objects (RetainedState), so the same
+     * address on two buses keeps two entries. Must be stable across
+     * reboots. 0 is the local RS485 bus. The default hashes name();
+     * transports that reach different buses under one name override it.
+     */
+    virtual uint16_t busId() const { return hashBusId(name(), 0); }
+
+    // Non-zero 16-bit hash of a bus description (e.g. host and port)
+    static uint16_t hashBusId(const char* text, uint32_t salt);
+
+    /**
+     * @brief Read input registers (function 0x04) from one unit
+     * @param out Receives count values on success
+     * @return ModbusError::SUCCESS, TIMEOUT, CRC_ERROR, a Modbus exception, ...
+     */
+    virtual ModbusError readInputRegisters(uint8_t unit, uint16_t reg, uint16_t count,
+                                           uint16_t* out, uint32_t timeoutMs) = 0;
+};
+
+/**
+ * Modbus RTU frame helpers (CRC-16, function 0x03/0x04 request/response)
+ */
+namespace rtu {
+
+static constexpr size_t READ_REQUEST_BYTES = 8;
+static constexpr size_t MAX_READ_REGISTERS = 125;
+static constexpr size_t MAX_FRAME_BYTES = 256;
+static constexpr size_t EXCEPTION_BYTES = 5;
+
+// CRC-16/MODBUS (poly 0xA001 reflected, init 0xFFFF); sent low byte first
+uint16_t crc16(const uint8_t* data, size_t length);
+
+// Build "unit fc reg count crc" into out[READ_REQUEST_BYTES]
+void buildReadRequest(uint8_t unit, uint8_t functionCode, uint16_t reg, uint16_t count, uint8_t* out);
+
+/**
+ * @brief Total length of the response frame whose first bytes are in head
+ * @return 0 if more bytes are needed to tell (fewer than 3 received)
+ */
+size_t responseLength(const uint8_t* head, size_t received);
+
+/**
+ * @brief Validate a read response and extract register values
+ *
+ * Checks CRC, unit, function, byte count; exception responses map to the
+ * matching ModbusError.
+ */
+ModbusError parseReadResponse(const uint8_t* frame, size_t length, uint8_t unit,
+                              uint8_t functionCode, uint16_t count, uint16_t* out);
+
+} // namespace rtu
+
+} // namespace andrtf3
+
+#endif // ANDRTF3_TRANSPORT_H
@@ -9,11 +9,31 @@
 #include <unity.h>
 #include <string.h>
 #include "ANDRTF3.h"
+#include "ANDRTF3Scheduler.h"
+#include "ANDRTF3Poller.h"
+#include "ANDRTF3Simulator.h"
+#include "ANDRTF3GapTuner.h"
+#include "ANDRTF3Group.h"
+#include "ANDRTF3Pump.h"
+#include "ANDRTF3Bus.h"
+#include "ANDRTF3Snapshot.h"
+#include "ANDRTF3History.h"
+#include "ANDRTF3Aggregate.h"
+#include "ANDRTF3LagCompensator.h"
+#include "ANDRTF3Characterizer.h"
+#include "ANDRTF3Directory.h"
+#include "ANDRTF3RtuTcp.h"
+#include "ANDRTF3Gateway.h"
+#include "ANDRTF3Executor.h"
+#include "ANDRTF3Drift.h"
+#include "ANDRTF3Health.h"
 
 using namespace andrtf3;
 
 void setUp(void) {
     // Unity setup - called before each test
+    // Every test starts as after a power-on reset (no warm state)
+    RetainedState::system().format();
 }
 
 void tearDown(void) {
@@ -267,6 +287,1483 @@ void test_boundary_boiling_point(void) {
     TEST_ASSERT_FLOAT_WITHIN(0.001f, 100.0f, celsius);
 }
 
+// ============================================================================
+// Scheduler Policy Tests
+// ============================================================================
+
+static void makeSlots(SensorSlot* slots, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        slots[i].reset(static_cast<uint8_t>(i + 1), 5000, 0);
+    }
+}
+
+void test_round_robin_cycles_due_sensors(void) {
+    SensorSlot slots[3];
+    makeSlots(slots, 3);
+    RoundRobinPolicy rr;
+
+    TEST_ASSERT_EQUAL_INT(0, rr.selectNext(slots, 3, 0));
+    TEST_ASSERT_EQUAL_INT(1, rr.selectNext(slots, 3, 0));
+    TEST_ASSERT_EQUAL_INT(2, rr.selectNext(slots, 3, 0));
+
+    // Nothing due after every sensor was read
+    for (size_t i = 0; i < 3; i++) {
+        slots[i].recordResult(true, 215, 60, 100);
+    }
+    TEST_ASSERT_EQUAL_INT(-1, rr.selectNext(slots, 3, 200));
+    TEST_ASSERT_EQUAL_INT(0, rr.selectNext(slots, 3, 5100));
+}
+
+void test_edf_picks_earliest_deadline(void) {
+    SensorSlot slots[3];
+    makeSlots(slots, 3);
+    slots[0].recordResult(true, 215, 60, 3000);
+    slots[1].recordResult(true, 215, 60, 1000);   // Oldest reading
+    slots[2].recordResult(true, 215, 60, 2000);
+    EdfPolicy edf(100);
+
+    TEST_ASSERT_EQUAL_INT(1, edf.selectNext(slots, 3, 6000));
+}
+
+void test_priority_lane_serves_critical_first(void) {
+    SensorSlot slots[3];
+    makeSlots(slots, 3);
+    slots[2].priority = 1;
+    PriorityLanePolicy lanes;
+
+    TEST_ASSERT_EQUAL_INT(2, lanes.selectNext(slots, 3, 0));
+    slots[2].recordResult(true, 215, 60, 0);
+    TEST_ASSERT_EQUAL_INT(0, lanes.selectNext(slots, 3, 0));
+}
+
+void test_adaptive_rate_stretches_stable_sensor(void) {
+    SensorSlot slot;
+    slot.reset(1, 1000, 0);
+    AdaptiveRatePolicy adaptive(4, 1);
+
+    slot.recordResult(true, 215, 60, 0);
+    adaptive.onResult(slot, true, 0);
+    slot.recordResult(true, 215, 60, 1500);
+    adaptive.onResult(slot, true, 1500);
+    TEST_ASSERT_GREATER_THAN(1000, slot.currentPeriodMs);
+
+    slot.recordResult(true, 230, 60, 4000);       // 1.5 K step
+    adaptive.onResult(slot, true, 4000);
+    TEST_ASSERT_EQUAL_UINT32(1000, slot.currentPeriodMs);
+}
+
+void test_profiled_sweep_orders_fast_first_and_interleaves_zones(void) {
+    SensorSlot slots[4];
+    makeSlots(slots, 4);
+    // Zone 0: slow (95ms) and fast (60ms); zone 1: two fast sensors
+    slots[0].zone = 0; slots[0].recordResult(true, 215, 95, 0);
+    slots[1].zone = 0; slots[1].recordResult(true, 215, 60, 0);
+    slots[2].zone = 1; slots[2].recordResult(true, 215, 60, 0);
+    slots[3].zone = 1; slots[3].recordResult(true, 215, 65, 0);
+    ProfiledSweepPolicy profiled;
+
+    int order[4];
+    for (size_t i = 0; i < 4; i++) {
+        order[i] = profiled.selectNext(slots, 4, 5000);
+        slots[order[i]].recordResult(true, 215, slots[order[i]].rttEwmaMs, 5000);
+    }
+
+    TEST_ASSERT_EQUAL_INT(1, order[0]);   // Fastest first
+    TEST_ASSERT_EQUAL_INT(2, order[1]);   // Then the other zone
+    TEST_ASSERT_EQUAL_INT(0, order[3]);   // Slow responder last
+}
+
+void test_gap_tuner_frame_gap(void) {
+    // 3.5 chars * 11 bits at 9600 baud = 4.01ms -> 5ms
+    TEST_ASSERT_EQUAL_UINT16(5, GapTuner::frameGapMs(9600));
+    TEST_ASSERT_EQUAL_UINT16(2, GapTuner::frameGapMs(115200));
+}
+
+void test_gap_tuner_shrinks_then_falls_back(void) {
+    GapTuner tuner;
+    GapTuner::Config config = GapTuner::getDefaultConfig();
+    TEST_ASSERT_EQUAL_UINT16(config.startGapMs, tuner.getGapMs(0));
+
+    // Clean windows shrink the gap
+    for (int i = 0; i < config.windowReads * 4; i++) {
+        tuner.onResult(0, true, 70);
+    }
+    uint16_t shrunk = tuner.getGapMs(0);
+    TEST_ASSERT_LESS_THAN(config.startGapMs, shrunk);
+
+    // A noisy window falls back above the last clean gap and locks
+    for (int i = 0; i < config.windowReads; i++) {
+        tuner.onResult(0, (i % 2) == 0, 70);
+    }
+    TEST_ASSERT_GREATER_THAN(shrunk, tuner.getGapMs(0));
+    TEST_ASSERT_TRUE(tuner.getState(0) == GapTuner::State::LOCKED);
+    TEST_ASSERT_EQUAL_UINT32(1, tuner.getFallbackCount());
+
+    // Timeout follows the observed turnaround plus margin
+    TEST_ASSERT_UINT32_WITHIN(10, 100, tuner.getRecommendedTimeoutMs(0));
+}
+
+void test_gap_tuner_timeout_backs_off_after_timeouts(void) {
+    GapTuner tuner;
+    GapTuner::Config config = GapTuner::getDefaultConfig();
+    for (int i = 0; i < config.windowReads; i++) {
+        tuner.onResult(0, true, 60);
+    }
+    uint16_t learned = tuner.getRecommendedTimeoutMs(0);
+    TEST_ASSERT_UINT32_WITHIN(5, 90, learned);
+
+    // Turnaround jumps above the learned timeout: every read times out, and
+    // each timeout widens the next one until the ceiling
+    uint16_t timeout = learned;
+    for (int i = 0; i < 4; i++) {
+        tuner.onResult(0, false, timeout);
+        TEST_ASSERT_GREATER_THAN(timeout, tuner.getRecommendedTimeoutMs(0));
+        timeout = tuner.getRecommendedTimeoutMs(0);
+        if (timeout == config.maxTimeoutMs) break;
+    }
+    TEST_ASSERT_EQUAL_UINT16(config.maxTimeoutMs, timeout);
+
+    // A fast failure (CRC error, exception) is no reason to wait longer
+    GapTuner other;
+    other.onResult(1, true, 60);
+    other.onResult(1, false, 10);
+    TEST_ASSERT_EQUAL_UINT16(learned, other.getRecommendedTimeoutMs(1));
+}
+
+void test_simulator_is_deterministic(void) {
+    SimSensorModel models[4];
+    for (uint8_t i = 0; i < 4; i++) {
+        models[i] = { static_cast<uint8_t>(i + 1), 0, 0, 1000, 60, 20, 50, 0 };
+    }
+    SimScenario scenario = BusSimulator::makeScenario(models, 4, 60000);
+    RoundRobinPolicy rr;
+    SimResult a, b;
+
+    TEST_ASSERT_TRUE(BusSimulator::run(scenario, rr, a));
+    TEST_ASSERT_TRUE(BusSimulator::run(scenario, rr, b));
+    TEST_ASSERT_EQUAL_UINT32(a.transactions, b.transactions);
+    TEST_ASSERT_EQUAL_UINT32(a.failures, b.failures);
+    TEST_ASSERT_GREATER_THAN(0, a.sweeps);
+    TEST_ASSERT_LESS_OR_EQUAL(1000, a.busUtilPermille);
+
+    // Nothing to simulate: rejected, not divided by
+    scenario.durationMs = 0;
+    TEST_ASSERT_FALSE(BusSimulator::run(scenario, rr, a));
+}
+
+// ============================================================================
+// Scripted Transport
+// ============================================================================
+
+// Answers each read with the next scripted register value
+class ScriptedTransport : public Transport {
+public:
+    ScriptedTransport(const uint16_t* values, size_t count) : _values(values), _count(count), _next(0), _calls(0) {}
+    const char* name() const override { return "scripted"; }
+    ModbusError readInputRegisters(uint8_t, uint16_t, uint16_t, uint16_t* out, uint32_t) override {
+        _calls++;
+        if (_next >= _count) {
+            return ModbusError::TIMEOUT;
+        }
+        *out = _values[_next++];
+        return ModbusError::SUCCESS;
+    }
+    size_t reads() const { return _next; }      // Answered from the script
+    size_t calls() const { return _calls; }     // Including timeouts
+
+private:
+    const uint16_t* _values;
+    size_t _count;
+    size_t _next;
+    size_t _calls;
+};
+
+// ============================================================================
+// Sensor Group Tests
+// ============================================================================
+
+void test_group_assigns_bits_and_times_out(void) {
+    ANDRTF3 a(10);
+    ANDRTF3 b(11);
+    ANDRTF3Group group;
+
+    TEST_ASSERT_EQUAL_INT(0, group.add(a));
+    TEST_ASSERT_EQUAL_INT(1, group.add(b));
+    TEST_ASSERT_EQUAL_INT(0, group.add(a));          // Already a member
+    TEST_ASSERT_EQUAL_UINT32(0x3, group.getMemberMask());
+    TEST_ASSERT_TRUE(group.getMember(1) == &b);
+
+    // No readings published: nothing pending, wait times out empty
+    TEST_ASSERT_EQUAL_UINT32(0, group.getPending());
+    TEST_ASSERT_EQUAL_UINT32(0, group.waitAny(0));
+
+    group.remove(a);
+    TEST_ASSERT_EQUAL_UINT32(0x2, group.getMemberMask());
+    TEST_ASSERT_EQUAL_INT(0, group.add(a));          // Bit reused
+}
+
+void test_group_reports_published_reading_and_drops_destroyed_member(void) {
+    const uint16_t script[] = { 215 };
+    ScriptedTransport transport(script, 1);
+    ANDRTF3Group group;
+    ANDRTF3 a(10);
+    ANDRTF3* b = new ANDRTF3(11);
+    b->setTransport(&transport);
+    TEST_ASSERT_EQUAL_INT(0, group.add(a));
+    TEST_ASSERT_EQUAL_INT(1, group.add(*b));
+
+    // A published reading sets exactly the member's bit, reported once
+    TEST_ASSERT_TRUE(b->readTemperature());
+    TEST_ASSERT_EQUAL_UINT32(0x2, group.getPending());
+    TEST_ASSERT_EQUAL_UINT32(0x2, group.waitAny(0));
+    TEST_ASSERT_EQUAL_UINT32(0, group.getPending());
+
+    // Destroying a member takes it out of the group
+    delete b;
+    TEST_ASSERT_EQUAL_UINT32(0x1, group.getMemberMask());
+    TEST_ASSERT_EQUAL_UINT32(1, group.size());
+    TEST_ASSERT_NULL(group.getMember(1));
+}
+
+void test_group_refuses_sensor_of_another_group(void) {
+    const uint16_t script[] = { 215, 216 };
+    ScriptedTransport transport(script, 2);
+    ANDRTF3 s(10);
+    s.setTransport(&transport);
+    ANDRTF3Group b;
+    {
+        ANDRTF3Group a;
+        TEST_ASSERT_EQUAL_INT(0, a.add(s));
+        TEST_ASSERT_EQUAL_INT(-1, b.add(s));         // One notification target per sensor
+        TEST_ASSERT_EQUAL_UINT32(0, b.size());
+        TEST_ASSERT_TRUE(s.readTemperature());
+        TEST_ASSERT_EQUAL_UINT32(0x1, a.getPending());
+
+        // Moving the sensor: leave A first, then B accepts it and A refuses it
+        a.remove(s);
+        TEST_ASSERT_EQUAL_INT(0, b.add(s));
+        TEST_ASSERT_EQUAL_INT(-1, a.add(s));
+    }
+    TEST_ASSERT_TRUE(s.readTemperature());
+    TEST_ASSERT_EQUAL_UINT32(0x1, b.waitAny(0));
+
+    // A group only clears a notification that still points at it
+    EventGroupHandle_t other = xEventGroupCreate();
+    s.setUpdateNotification(other, 0x4);
+    b.remove(s);
+    TEST_ASSERT_TRUE(s.getUpdateNotification() == other);
+    {
+        ANDRTF3Group c;
+        s.setUpdateNotification(nullptr, 0);
+        TEST_ASSERT_EQUAL_INT(0, c.add(s));
+        s.setUpdateNotification(other, 0x4);
+    }
+    TEST_ASSERT_TRUE(s.getUpdateNotification() == other);
+    s.setUpdateNotification(nullptr, 0);
+    vEventGroupDelete(other);
+}
+
+// ============================================================================
+// Response Pump Tests
+// ============================================================================
+
+void test_pump_dispatches_only_notified_sensors(void) {
+    ANDRTF3 a(10);
+    ANDRTF3 b(200);
+    ANDRTF3 clash(10);
+    ResponsePump pump;
+
+    TEST_ASSERT_TRUE(pump.add(a));
+    TEST_ASSERT_TRUE(pump.add(b));
+    TEST_ASSERT_FALSE(pump.add(clash));              // Address already routed
+    TEST_ASSERT_EQUAL_UINT32(2, pump.size());
+
+    // Quiet bus: nothing to do
+    TEST_ASSERT_EQUAL_UINT32(0, pump.pump(0));
+
+    // Repeated notifications coalesce; unknown addresses are counted
+    pump.notify(200);
+    pump.notify(200);
+    pump.notify(47);
+    TEST_ASSERT_EQUAL_UINT32(1, pump.pump(0));
+    pump.notify(10);
+    pump.notify(200);
+    TEST_ASSERT_EQUAL_UINT32(2, pump.pump(0));
+    TEST_ASSERT_EQUAL_UINT32(0, pump.pump(0));
+
+    ResponsePump::Stats stats = pump.getStats();
+    TEST_ASSERT_EQUAL_UINT32(5, stats.notifications);
+    TEST_ASSERT_EQUAL_UINT32(3, stats.dispatched);
+    TEST_ASSERT_EQUAL_UINT32(1, stats.unrouted);
+
+    pump.remove(a);
+    pump.notify(10);
+    TEST_ASSERT_EQUAL_UINT32(0, pump.pump(0));
+    TEST_ASSERT_EQUAL_UINT32(2, pump.getStats().unrouted);
+}
+
+void test_destroyed_sensor_leaves_pump_and_poller(void) {
+    ResponsePump pump;
+    ANDRTF3Poller poller;
+    ANDRTF3* sensor = new ANDRTF3(12);
+    TEST_ASSERT_TRUE(pump.add(*sensor));
+    TEST_ASSERT_TRUE(poller.addSensor(sensor, 1000));
+
+    delete sensor;
+    TEST_ASSERT_EQUAL_UINT32(0, pump.size());
+    pump.notify(12);
+    TEST_ASSERT_EQUAL_UINT32(0, pump.pump(0));
+
+    // Index kept, never polled again
+    TEST_ASSERT_EQUAL_UINT32(1, poller.getSensorCount());
+    TEST_ASSERT_NULL(poller.getSensor(0));
+    TEST_ASSERT_FALSE(poller.poll());
+}
+
+// Exposes the async response hook the Modbus task calls
+// ============================================================================
+// Request Correlation Tests
+// ============================================================================
+
+class ResponseInjector : public ANDRTF3 {
+public:
+    explicit ResponseInjector(uint8_t address) : ANDRTF3(address) {}
+    using ANDRTF3::onAsyncResponse;
+};
+
+void test_unsolicited_response_is_discarded_and_counted(void) {
+    const uint16_t script[] = { 230 };
+    ScriptedTransport transport(script, sizeof(script) / sizeof(script[0]));
+    ResponseInjector sensor(13);
+    const uint8_t frame[2] = { 0x00, 0xD7 };         // 21.5°C
+
+    sensor.onAsyncResponse(0x04, 50, frame, sizeof(frame));
+    ANDRTF3::Stats stats = sensor.getStats();
+    TEST_ASSERT_EQUAL_UINT32(1, stats.unsolicited);
+    TEST_ASSERT_EQUAL_UINT32(0, stats.responses);
+    TEST_ASSERT_FALSE(sensor.getTemperatureData().valid);
+
+    // A correlated request completes and records latency
+    sensor.setTransport(&transport);
+    TEST_ASSERT_TRUE(sensor.requestTemperature());
+    stats = sensor.getStats();
+    TEST_ASSERT_EQUAL_UINT32(1, stats.requests);
+    TEST_ASSERT_EQUAL_UINT32(1, stats.responses);
+    TEST_ASSERT_EQUAL_UINT16(0, sensor.getPendingSequence());
+    TEST_ASSERT_EQUAL_INT16(230, sensor.getTemperature());
+    TEST_ASSERT_EQUAL_UINT32(1, transport.calls());
+}
+
+// ============================================================================
+// Queued Read Tests
+// ============================================================================
+
+void test_queued_read_expires_or_is_cancelled(void) {
+    const uint16_t script[] = { 215, 216 };
+    ScriptedTransport transport(script, sizeof(script) / sizeof(script[0]));
+    ANDRTF3 sensor(14);
+    sensor.setTransport(&transport);
+    TEST_ASSERT_TRUE(sensor.serviceQueuedRead() == ANDRTF3::QueuedRead::NONE);
+
+    // Deadline already behind us: dropped without touching the bus
+    sensor.queueRead(millis() - 1);
+    TEST_ASSERT_TRUE(sensor.serviceQueuedRead() == ANDRTF3::QueuedRead::DROPPED);
+    TEST_ASSERT_EQUAL_UINT32(1, sensor.getStats().expiredDrops);
+    TEST_ASSERT_EQUAL_UINT32(0, sensor.getStats().requests);
+
+    // Coalesced into one request; cancelling removes it
+    sensor.queueRead(millis() + 1000);
+    sensor.queueRead(millis() + 5000);
+    TEST_ASSERT_TRUE(sensor.cancelRead());
+    TEST_ASSERT_FALSE(sensor.cancelRead());
+    TEST_ASSERT_FALSE(sensor.hasQueuedRead());
+    TEST_ASSERT_EQUAL_UINT32(1, sensor.getStats().cancelled);
+
+    // A cancelled deadline does not carry over; an earlier one never lowers a later one
+    sensor.queueRead(millis() - 1);
+    TEST_ASSERT_TRUE(sensor.serviceQueuedRead() == ANDRTF3::QueuedRead::DROPPED);
+    sensor.queueRead(millis() + 5000);
+    sensor.queueRead(millis() - 1);
+    TEST_ASSERT_TRUE(sensor.serviceQueuedRead() == ANDRTF3::QueuedRead::COMPLETED);
+    TEST_ASSERT_EQUAL_UINT32(1, sensor.getStats().requests);
+    TEST_ASSERT_EQUAL_UINT32(1, transport.calls());
+    TEST_ASSERT_EQUAL_INT16(215, sensor.getTemperature());
+
+    // The poller's lateness limit is the same deadline
+    ANDRTF3Poller poller;
+    poller.setMaxLateness(50);
+    TEST_ASSERT_TRUE(poller.addSensor(&sensor, 1000));
+    TEST_ASSERT_TRUE(poller.poll());
+    TEST_ASSERT_EQUAL_INT16(216, sensor.getTemperature());
+    delay(1200);    // Due 1000 ms after the read: now 200 ms late
+    TEST_ASSERT_FALSE(poller.poll());
+    TEST_ASSERT_EQUAL_UINT32(2, transport.calls());
+    TEST_ASSERT_EQUAL_UINT32(3, sensor.getStats().expiredDrops);
+    TEST_ASSERT_FALSE(sensor.hasQueuedRead());
+    TEST_ASSERT_FALSE(timeReached(millis(), poller.getSlot(0).nextDueMs));
+}
+
+// ============================================================================
+// Value Verification Tests
+// ============================================================================
+
+void test_suspect_value_is_verified_in_next_slot(void) {
+    const uint16_t script[] = { 0x0000, 215, 2000, 2000, 215, 0xFFFF, 0xFFFF };
+    ScriptedTransport transport(script, sizeof(script) / sizeof(script[0]));
+    ANDRTF3 sensor(15);
+    sensor.setTransport(&transport);
+
+    // Glitch: a verification read is queued right away, and it recovers
+    TEST_ASSERT_FALSE(sensor.readTemperature());
+    TEST_ASSERT_TRUE(sensor.hasQueuedRead());
+    TEST_ASSERT_TRUE(sensor.serviceQueuedRead() == ANDRTF3::QueuedRead::COMPLETED);
+    TEST_ASSERT_EQUAL_INT16(215, sensor.getTemperature());
+    TEST_ASSERT_FALSE(sensor.hasQueuedRead());
+
+    // Out of range gets the same treatment; any read settles it
+    TEST_ASSERT_FALSE(sensor.readTemperature());
+    TEST_ASSERT_TRUE(sensor.hasQueuedRead());
+    TEST_ASSERT_FALSE(sensor.readTemperature());
+    TEST_ASSERT_FALSE(sensor.hasQueuedRead());
+    TEST_ASSERT_TRUE(sensor.readTemperature());
+
+    // The poller gives the verification the next slot, not a period later
+    ANDRTF3Poller poller;
+    TEST_ASSERT_TRUE(poller.addSensor(&sensor, 5000));
+    TEST_ASSERT_TRUE(poller.poll());
+    TEST_ASSERT_TRUE(poller.poll());
+    TEST_ASSERT_FALSE(poller.poll());
+    TEST_ASSERT_EQUAL_UINT32(7, transport.reads());
+
+    ANDRTF3::Stats stats = sensor.getStats();
+    TEST_ASSERT_EQUAL_UINT32(3, stats.verifications);
+    TEST_ASSERT_EQUAL_UINT32(1, stats.verifyRecovered);
+    TEST_ASSERT_EQUAL_UINT32(2, stats.verifyConfirmed);
+    TEST_ASSERT_EQUAL_INT16(215, sensor.getTemperature());
+}
+
+void test_failed_or_late_verification_returns_to_schedule(void) {
+    // Verification times out: the sensor is not polled back-to-back
+    const uint16_t script[] = { 0x0000 };
+    ScriptedTransport transport(script, sizeof(script) / sizeof(script[0]));
+    ANDRTF3 sensor(24);
+    sensor.setTransport(&transport);
+    ANDRTF3Poller poller;
+    TEST_ASSERT_TRUE(poller.addSensor(&sensor, 5000));
+
+    TEST_ASSERT_TRUE(poller.poll());
+    TEST_ASSERT_TRUE(sensor.hasQueuedRead());
+    TEST_ASSERT_TRUE(poller.poll());
+    TEST_ASSERT_FALSE(sensor.hasQueuedRead());
+    TEST_ASSERT_FALSE(poller.poll());
+    TEST_ASSERT_FALSE(poller.poll());
+    TEST_ASSERT_EQUAL_UINT32(2, transport.calls());
+    TEST_ASSERT_EQUAL_UINT32(1, sensor.getStats().verifyLost);
+
+    // Verification misses its deadline: dropped before the wire, not transmitted
+    const uint16_t lateScript[] = { 0x0000, 215 };
+    ScriptedTransport lateTransport(lateScript, sizeof(lateScript) / sizeof(lateScript[0]));
+    ANDRTF3 late(25);
+    late.setTransport(&lateTransport);
+    ANDRTF3Poller latePoller;
+    TEST_ASSERT_TRUE(latePoller.addSensor(&late, 5000));
+
+    TEST_ASSERT_TRUE(latePoller.poll());
+    TEST_ASSERT_TRUE(late.hasQueuedRead());
+    delay(150);   // Past the 100 ms verification deadline
+    TEST_ASSERT_FALSE(latePoller.poll());
+    TEST_ASSERT_FALSE(late.hasQueuedRead());
+    TEST_ASSERT_EQUAL_UINT32(1, lateTransport.calls());
+
+    ANDRTF3::Stats stats = late.getStats();
+    TEST_ASSERT_EQUAL_UINT32(1, stats.expiredDrops);
+    TEST_ASSERT_EQUAL_UINT32(1, stats.verifyLost);
+
+    // The next read is an ordinary one
+    TEST_ASSERT_TRUE(late.readTemperature());
+    TEST_ASSERT_EQUAL_UINT32(0, late.getStats().verifyConfirmed);
+}
+
+// ============================================================================
+// Shared Bus Tests
+// ============================================================================
+
+static size_t busCallbacks = 0;
+
+static void countBusReading(size_t slot, uint8_t address, int16_t celsius, bool valid, void* context) {
+    (void)slot; (void)address; (void)celsius; (void)valid; (void)context;
+    busCallbacks++;
+}
+
+void test_shared_bus_serves_slots_from_one_queue(void) {
+    const uint16_t script[] = { 215, 0xFFFF, 230, 198 };
+    ScriptedTransport transport(script, sizeof(script) / sizeof(script[0]));
+    ANDRTF3Bus bus(&transport);
+    busCallbacks = 0;
+    bus.setCallback(countBusReading, nullptr);
+
+    TEST_ASSERT_EQUAL_INT(0, bus.add(3));
+    TEST_ASSERT_EQUAL_INT(1, bus.add(4));
+    TEST_ASSERT_EQUAL_INT(2, bus.add(5));
+    TEST_ASSERT_EQUAL_INT(-1, bus.add(0));
+    TEST_ASSERT_FALSE(bus.service());                  // Nothing queued
+
+    // Requests coalesce per slot; an expired one never reaches the wire
+    TEST_ASSERT_TRUE(bus.request(0, millis() + 1000));
+    TEST_ASSERT_TRUE(bus.request(0, millis() + 2000));
+    TEST_ASSERT_TRUE(bus.request(1, millis() + 1000));
+    TEST_ASSERT_TRUE(bus.request(2, millis() - 1));
+    TEST_ASSERT_FALSE(bus.request(7, millis() + 1000));
+    TEST_ASSERT_TRUE(bus.service());
+    TEST_ASSERT_TRUE(bus.service());
+    TEST_ASSERT_FALSE(bus.service());
+    TEST_ASSERT_EQUAL_UINT32(2, transport.reads());
+
+    ANDRTF3Bus::Reading reading;
+    TEST_ASSERT_TRUE(bus.getReading(0, reading));
+    TEST_ASSERT_TRUE(reading.valid);
+    TEST_ASSERT_EQUAL_INT16(215, reading.celsius);
+    TEST_ASSERT_FALSE(bus.getReading(1, reading));     // 0xFFFF: never valid
+    TEST_ASSERT_EQUAL_UINT8(1, reading.failures);
+
+    bus.request(1, millis() + 1000);
+    bus.request(0, millis() + 1000);
+    TEST_ASSERT_TRUE(bus.service());
+    TEST_ASSERT_TRUE(bus.service());
+    TEST_ASSERT_TRUE(bus.getReading(1, reading));
+    TEST_ASSERT_EQUAL_INT16(198, reading.celsius);
+    TEST_ASSERT_EQUAL_UINT8(0, reading.failures);
+
+    // A failure (transport timeout) keeps the last valid value
+    bus.request(0, millis() + 1000);
+    TEST_ASSERT_TRUE(bus.service());
+    TEST_ASSERT_TRUE(bus.getReading(0, reading));
+    TEST_ASSERT_FALSE(reading.valid);
+    TEST_ASSERT_EQUAL_INT16(230, reading.celsius);
+    TEST_ASSERT_EQUAL_UINT8(1, reading.failures);
+
+    ANDRTF3Bus::Stats stats = bus.getStats();
+    TEST_ASSERT_EQUAL_UINT32(6, stats.requests);
+    TEST_ASSERT_EQUAL_UINT32(1, stats.coalesced);
+    TEST_ASSERT_EQUAL_UINT32(3, stats.completed);
+    TEST_ASSERT_EQUAL_UINT32(2, stats.failed);
+    TEST_ASSERT_EQUAL_UINT32(1, stats.expired);
+    TEST_ASSERT_EQUAL_UINT32(5, busCallbacks);
+
+    // A few dozen bytes per sensor, far below a driver instance each
+    ANDRTF3Bus::Footprint fp = ANDRTF3Bus::footprint(40);
+    TEST_ASSERT_TRUE(fp.slotBytes <= 32);
+    TEST_ASSERT_EQUAL_UINT32(sizeof(ANDRTF3) + ANDRTF3::coldStateBytes(), fp.instanceBytes);
+    TEST_ASSERT_TRUE(fp.totalBytes < 40 * fp.instanceBytes);
+    TEST_ASSERT_EQUAL_UINT32(40 * fp.instanceBytes - fp.totalBytes, fp.savedBytes);
+}
+
+#if defined(__linux__)
+#include <thread>
+
+void test_concurrent_requests_keep_latest_deadline(void) {
+    // Half the requesters race in with a deadline already passed; the read
+    // must still go out, for the bus slot and the driver's queued read alike
+    const size_t rounds = 200;
+    uint16_t script[rounds];
+    for (size_t i = 0; i < rounds; i++) {
+        script[i] = 215;
+    }
+    ScriptedTransport transport(script, rounds);
+    ANDRTF3Bus bus(&transport);
+    TEST_ASSERT_EQUAL_INT(0, bus.add(3));
+    ANDRTF3 sensor(16);
+    sensor.setTransport(&transport);
+
+    for (size_t i = 0; i < rounds; i++) {
+        uint32_t late = millis() + 60000;
+        uint32_t past = millis() - 1000;
+        std::atomic<bool> go{false};
+        std::thread requesters[4];
+        for (size_t t = 0; t < 4; t++) {
+            uint32_t deadline = (t % 2 == 0) ? past : late;
+            bool onBus = (i % 2 == 0);
+            requesters[t] = std::thread([&, deadline, onBus] {
+                while (!go.load()) {
+                }
+                if (onBus) {
+                    bus.request(0, deadline);
+                } else {
+                    sensor.queueRead(deadline);
+                }
+            });
+        }
+        go.store(true);                 // Release all four at once
+        for (auto& requester : requesters) {
+            requester.join();
+        }
+        if (i % 2 == 0) {
+            TEST_ASSERT_TRUE(bus.service());
+        } else {
+            TEST_ASSERT_TRUE(sensor.serviceQueuedRead() == ANDRTF3::QueuedRead::COMPLETED);
+        }
+    }
+    TEST_ASSERT_EQUAL_UINT32(0, bus.getStats().expired);
+    TEST_ASSERT_EQUAL_UINT32(0, sensor.getStats().expiredDrops);
+    TEST_ASSERT_EQUAL_UINT32(rounds, transport.reads());
+}
+#endif
+
+// ============================================================================
+// Retained State Tests
+// ============================================================================
+
+void test_retained_state_restores_after_soft_reset(void) {
+    const uint16_t script[] = { 215, 230, 0x0000 };
+    ScriptedTransport transport(script, sizeof(script) / sizeof(script[0]));
+    {
+        ANDRTF3 before(15);
+        before.setTransport(&transport);
+        TEST_ASSERT_FALSE(before.isRestored());
+        TEST_ASSERT_TRUE(before.requestTemperature());
+    }
+
+    // "Reset": a new driver for the same address and bus starts warm
+    ANDRTF3 after(15);
+    TEST_ASSERT_FALSE(after.isRestored());      // Nothing saved for the local bus
+    after.setTransport(&transport);
+    TEST_ASSERT_TRUE(after.isRestored());
+    TEST_ASSERT_TRUE(after.getTemperatureData().valid);
+    TEST_ASSERT_EQUAL_INT16(215, after.getTemperature());
+    TEST_ASSERT_TRUE(after.getStats().avgLatencyMs > 0);
+
+    int16_t temp = 0;
+    bool valid = false;
+    after.bindTemperaturePointers(&temp, &valid);
+    TEST_ASSERT_TRUE(valid);
+    TEST_ASSERT_EQUAL_INT16(215, temp);
+
+    // Same address on the local bus: a separate entry
+    RetainedState& retained = RetainedState::system();
+    int local = retained.claim(15);
+    int remote = retained.claim(15, transport.busId());
+    TEST_ASSERT_TRUE(local >= 0 && remote >= 0 && local != remote);
+    RetainedState::Sensor state;
+    TEST_ASSERT_FALSE(retained.restore(local, state));
+
+    // A torn entry is ignored
+    retained.getBlock()->entries[remote].celsius ^= 0x40;
+    ANDRTF3 torn(15);
+    torn.setTransport(&transport);
+    TEST_ASSERT_FALSE(torn.isRestored());
+    TEST_ASSERT_FALSE(torn.getTemperatureData().valid);
+
+    // Too old to trust: fault state only
+    TEST_ASSERT_TRUE(torn.requestTemperature());
+    retained.setMaxAge(0);
+    ANDRTF3 stale(15);
+    stale.setTransport(&transport);
+    retained.setMaxAge(RetainedState::DEFAULT_MAX_AGE_MS);
+    TEST_ASSERT_FALSE(stale.isRestored());
+
+    // Wake from deep sleep: readings dropped, response time and faults kept
+    TEST_ASSERT_FALSE(stale.requestTemperature());
+    retained.markReadingsStale();
+    TEST_ASSERT_TRUE(retained.restore(remote, state));
+    TEST_ASSERT_FALSE(state.valid);
+    TEST_ASSERT_EQUAL_UINT8(1, state.failures);
+    TEST_ASSERT_TRUE(state.rttMs > 0);
+
+    // Room for every sensor of a full poller
+    TEST_ASSERT_TRUE(RetainedState::MAX_ENTRIES >= ANDRTF3Poller::MAX_SENSORS);
+}
+
+void test_retained_state_saved_once_per_read(void) {
+    const uint16_t script[] = { 215, 0x0000 };
+    ScriptedTransport transport(script, sizeof(script) / sizeof(script[0]));
+    ANDRTF3 sensor(16);
+    sensor.setTransport(&transport);
+    RetainedState& retained = RetainedState::system();
+
+    uint32_t before = retained.getSaveCount();
+    TEST_ASSERT_TRUE(sensor.readTemperature());
+    TEST_ASSERT_EQUAL_UINT32(before + 1, retained.getSaveCount());
+
+    // The one save already carries this read's response time
+    RetainedState::Sensor state;
+    TEST_ASSERT_TRUE(retained.restore(retained.claim(16, transport.busId()), state));
+    TEST_ASSERT_EQUAL_UINT16(sensor.getStats().avgLatencyMs, state.rttMs);
+
+    before = retained.getSaveCount();
+    TEST_ASSERT_FALSE(sensor.readTemperature());
+    TEST_ASSERT_EQUAL_UINT32(before + 1, retained.getSaveCount());
+}
+
+// ============================================================================
+// Memory Placement Tests
+// ============================================================================
+
+void test_memory_policy_places_cold_state(void) {
+    MemoryPolicy saved = ANDRTF3::getMemoryPolicy();
+    TEST_ASSERT_TRUE(saved.hot == MemoryRegion::INTERNAL);
+#if defined(ANDRTF3_IRAM_DECODE)
+    TEST_ASSERT_TRUE(saved.cold == MemoryRegion::INTERNAL);
+#else
+    TEST_ASSERT_TRUE(saved.cold == MemoryRegion::PSRAM);
+#endif
+
+    // Cold state goes to PSRAM where the board has it, else internal RAM (hosts)
+    MemoryRegion expected = (saved.cold == MemoryRegion::PSRAM &&
+                             memory::freeBytes(MemoryRegion::PSRAM) > 0)
+        ? MemoryRegion::PSRAM : MemoryRegion::INTERNAL;
+    const uint16_t script[] = { 215 };
+    ScriptedTransport transport(script, sizeof(script) / sizeof(script[0]));
+    ANDRTF3* sensor = new ANDRTF3(21);
+    sensor->setTransport(&transport);
+    TEST_ASSERT_TRUE(sensor->getColdRegion() == expected);
+    TEST_ASSERT_EQUAL_UINT8(21, sensor->getConfig().address);
+
+    ANDRTF3::Config config = sensor->getConfig();
+    config.timeout = 80;
+    sensor->setConfig(config);
+    TEST_ASSERT_EQUAL_UINT32(80, sensor->getConfig().timeout);
+    TEST_ASSERT_TRUE(sensor->readTemperature());
+    TEST_ASSERT_EQUAL_UINT32(1, sensor->getStats().requests);
+    TEST_ASSERT_EQUAL_INT16(215, sensor->getTemperature());
+    delete sensor;
+
+    ANDRTF3::setMemoryPolicy({ MemoryRegion::ANY, MemoryRegion::ANY });
+    ANDRTF3 other(22);
+    TEST_ASSERT_TRUE(other.getColdRegion() == MemoryRegion::ANY);
+    ANDRTF3::setMemoryPolicy(saved);
+}
+
+// ============================================================================
+// Flash Write Tests
+// ============================================================================
+
+#if !defined(ESP_PLATFORM)
+void test_readings_publish_during_flash_writes(void) {
+    const uint16_t script[] = { 215, 0x0000, 216 };
+    ScriptedTransport transport(script, sizeof(script) / sizeof(script[0]));
+    ANDRTF3 sensor(23);
+    sensor.setTransport(&transport);
+    LagCompensator lag;
+    sensor.setLagCompensator(&lag);
+    int16_t bound = 0;
+    bool boundValid = false;
+    sensor.bindTemperaturePointers(&bound, &boundValid);
+
+    // Cache off for the whole sequence: readings, verification and
+    // statistics still go through, flash-side bookkeeping waits
+    memory::simulateFlashWrite(true);
+    TEST_ASSERT_TRUE(sensor.readTemperature());
+    TEST_ASSERT_EQUAL_INT16(215, bound);
+    TEST_ASSERT_TRUE(boundValid);
+
+    TEST_ASSERT_FALSE(sensor.readTemperature());
+    TEST_ASSERT_FALSE(boundValid);
+    TEST_ASSERT_TRUE(sensor.hasQueuedRead());
+    TEST_ASSERT_TRUE(sensor.serviceQueuedRead() == ANDRTF3::QueuedRead::COMPLETED);
+    TEST_ASSERT_EQUAL_INT16(216, sensor.getTemperature());
+    TEST_ASSERT_TRUE(boundValid);
+    TEST_ASSERT_EQUAL_UINT32(3, sensor.getStats().responses);
+    TEST_ASSERT_EQUAL_UINT32(1, sensor.getStats().verifyRecovered);
+    TEST_ASSERT_EQUAL_INT16(0, sensor.getCompensatedTemperature());
+
+    RetainedState& retained = RetainedState::system();
+    RetainedState::Sensor state;
+    TEST_ASSERT_FALSE(retained.restore(retained.claim(23, transport.busId()), state) && state.valid);
+
+    // Write done: the next process() catches up
+    memory::simulateFlashWrite(false);
+    sensor.process();
+    TEST_ASSERT_EQUAL_INT16(216, sensor.getCompensatedTemperature());
+    TEST_ASSERT_TRUE(retained.restore(retained.claim(23, transport.busId()), state));
+    TEST_ASSERT_TRUE(state.valid);
+    TEST_ASSERT_EQUAL_INT16(216, state.celsius);
+    TEST_ASSERT_EQUAL_STRING("", sensor.getTemperatureData().error.c_str());
+}
+#endif
+
+// ============================================================================
+// Device Instance Tests
+// ============================================================================
+
+void test_device_instance_reports_no_data_before_first_read(void) {
+    ANDRTF3 sensor(12);
+    IDeviceInstance& dev = sensor;
+
+    TEST_ASSERT_NOT_NULL(dev.getEventGroup());
+    TEST_ASSERT_FALSE(dev.getData(IDeviceInstance::DeviceDataType::TEMPERATURE).isOk());
+    TEST_ASSERT_FALSE(dev.performAction(0, 0).isOk());
+}
+
+void test_device_instance_invalid_reading_clears_data_ready(void) {
+    const uint16_t script[] = { 215 };
+    ScriptedTransport transport(script, 1);
+    ANDRTF3 sensor(12);
+    sensor.setTransport(&transport);
+    IDeviceInstance& dev = sensor;
+
+    TEST_ASSERT_TRUE(sensor.readTemperature());
+    TEST_ASSERT_TRUE((xEventGroupGetBits(dev.getEventGroup()) & ANDRTF3::DATA_READY_BIT) != 0);
+
+    // The next read fails before anyone waited: the stale reading must not count
+    TEST_ASSERT_FALSE(sensor.readTemperature());
+    EventBits_t bits = xEventGroupGetBits(dev.getEventGroup());
+    TEST_ASSERT_EQUAL_UINT32(ANDRTF3::DATA_ERROR_BIT, bits & (ANDRTF3::DATA_READY_BIT | ANDRTF3::DATA_ERROR_BIT));
+    TEST_ASSERT_FALSE(dev.waitForData().isOk());
+}
+
+// ============================================================================
+// Fleet Snapshot Tests
+// ============================================================================
+
+void test_snapshot_publish_and_read(void) {
+    alignas(8) static uint8_t buf[FleetSnapshot::requiredBytes(4)];
+    FleetSnapshot snapshot;
+    TEST_ASSERT_FALSE(snapshot.attach(buf, sizeof(buf) - 1, 4));
+    TEST_ASSERT_TRUE(snapshot.attach(buf, sizeof(buf), 4));
+
+    snapshot.publish(0, 3, 215, true, 1000);
+    snapshot.beginBatch();
+    snapshot.publish(2, 5, -40, false, 1100);
+    TEST_ASSERT_EQUAL_UINT32(1, snapshot.getSequence() & 1u);   // Write in progress
+    snapshot.endBatch();
+    TEST_ASSERT_EQUAL_UINT32(4, snapshot.getSequence());
+    snapshot.publish(9, 7, 0, true, 1200);                      // Beyond capacity: ignored
+
+    FleetSnapshot::Record records[4];
+    uint32_t updated = 0;
+    TEST_ASSERT_EQUAL_UINT32(3, snapshot.read(records, 4, &updated));
+    TEST_ASSERT_EQUAL_UINT32(1100, updated);
+    TEST_ASSERT_EQUAL_UINT8(3, records[0].address);
+    TEST_ASSERT_EQUAL_INT16(215, records[0].celsius);
+    TEST_ASSERT_EQUAL_UINT8(FleetSnapshot::FLAG_VALID, records[0].flags);
+    TEST_ASSERT_EQUAL_UINT8(0, records[1].address);              // Never published
+    TEST_ASSERT_EQUAL_INT16(-40, records[2].celsius);
+    TEST_ASSERT_EQUAL_UINT8(0, records[2].flags);
+
+    FleetSnapshot::Record one;
+    TEST_ASSERT_TRUE(snapshot.readOne(2, one));
+    TEST_ASSERT_EQUAL_UINT8(5, one.address);
+    TEST_ASSERT_FALSE(snapshot.readOne(3, one));
+}
+
+// ============================================================================
+// Aggregation Tests
+// ============================================================================
+
+void test_aggregate_kernel_matches_scalar(void) {
+    // 8-wide vectors plus a 3-sample tail, with gaps and band edges
+    static int16_t column[67];
+    for (size_t i = 0; i < 67; i++) {
+        column[i] = static_cast<int16_t>(180 + static_cast<int>((i * 37) % 80) - 40);
+    }
+    column[5] = Aggregator::INVALID_SAMPLE;
+    column[64] = Aggregator::INVALID_SAMPLE;
+    column[10] = 200;                               // Band edges are inclusive
+    column[11] = 240;
+    column[12] = -300;
+    column[13] = 800;
+
+    AggregateStats fast;
+    AggregateStats ref;
+    fast.clear();
+    ref.clear();
+    Aggregator::accumulate(column, 67, 200, 240, fast);
+    Aggregator::accumulateScalar(column, 67, 200, 240, ref);
+
+    TEST_ASSERT_EQUAL_UINT32(65, ref.count);
+    TEST_ASSERT_EQUAL_INT16(-300, ref.min);
+    TEST_ASSERT_EQUAL_INT16(800, ref.max);
+    TEST_ASSERT_TRUE(fast.sum == ref.sum);
+    TEST_ASSERT_EQUAL_UINT32(ref.count, fast.count);
+    TEST_ASSERT_EQUAL_INT16(ref.min, fast.min);
+    TEST_ASSERT_EQUAL_INT16(ref.max, fast.max);
+    TEST_ASSERT_EQUAL_UINT32(ref.inBand, fast.inBand);
+
+    // All missing: stats stay empty
+    int16_t gaps[9];
+    for (size_t i = 0; i < 9; i++) gaps[i] = Aggregator::INVALID_SAMPLE;
+    fast.clear();
+    Aggregator::accumulate(gaps, 9, 200, 240, fast);
+    TEST_ASSERT_EQUAL_UINT32(0, fast.count);
+    TEST_ASSERT_EQUAL_UINT16(0, fast.compliancePermille());
+}
+
+// ============================================================================
+// Lag Compensation Tests
+// ============================================================================
+
+void test_lag_compensator_learns_tau_and_leads_raw(void) {
+    // Sensor with a 120 s lag polled every 5 s; room air steps 20.0 -> 22.0°C
+    LagCompensator lag;
+    int32_t sensorMilli = 20000;                    // milli-degrees
+    int16_t firstLead = -1;
+    int16_t firstRaw = -1;
+
+    for (uint32_t cycle = 0; cycle < 2; cycle++) {
+        for (uint32_t t = 0; t < 3600; t += 5) {
+            int32_t airMilli = (t >= 300) ? 22000 : 20000;
+            if (cycle == 1) airMilli = (t >= 300) ? 20000 : 22000;
+            for (int k = 0; k < 5; k++) {
+                sensorMilli += (airMilli - sensorMilli) / 120;
+            }
+            int16_t raw = static_cast<int16_t>((sensorMilli + 50) / 100);
+            int16_t out = lag.update(raw, (cycle * 3600 + t) * 1000);
+            if (cycle == 0 && t >= 300) {
+                if (firstRaw < 0 && raw >= 215) firstRaw = static_cast<int16_t>(t);
+                if (firstLead < 0 && out >= 215) firstLead = static_cast<int16_t>(t);
+            }
+        }
+    }
+
+    TEST_ASSERT_EQUAL_UINT16(2, lag.getStepCount());
+    TEST_ASSERT_UINT32_WITHIN(25, 120, lag.getTauSeconds());
+    TEST_ASSERT_TRUE(firstLead >= 0 && firstLead < firstRaw);
+    TEST_ASSERT_INT_WITHIN(1, 200, lag.getRaw());
+    TEST_ASSERT_EQUAL_INT16(0, lag.getCorrection());    // Settled: no correction
+}
+
+void test_characterizer_fits_emulated_step(void) {
+    ThermalEmulator emulator(30000, 215, 30);
+    Characterizer characterizer;
+    characterizer.begin(0);
+
+    uint32_t t = 0;
+    Characterizer::Phase phase = Characterizer::Phase::BASELINE;
+    for (; t < 600000 && phase != Characterizer::Phase::DONE && phase != Characterizer::Phase::FAILED; t += 100) {
+        if (t == 40000) emulator.setAir(255);
+        phase = characterizer.addSample(emulator.read(t), t);
+    }
+
+    TEST_ASSERT_TRUE(phase == Characterizer::Phase::DONE);
+    Characterizer::Report report = characterizer.getReport();
+    TEST_ASSERT_UINT32_WITHIN(3000, 30000, report.tauMs);
+    TEST_ASSERT_EQUAL_INT16(215, report.baseline);
+    TEST_ASSERT_INT_WITHIN(1, 40, report.stepDeci);
+    TEST_ASSERT_EQUAL_UINT16(1000, report.sampleRateCentiHz);
+    TEST_ASSERT_UINT32_WITHIN(600, 6000, report.recommendedPollMs);
+}
+
+// ============================================================================
+// Drift Detection Tests
+// ============================================================================
+
+struct DriftEvents {
+    int raised;
+    int cleared;
+    size_t slot;
+    int16_t offset;
+};
+
+static void recordDrift(size_t slot, bool drifting, int16_t offsetDeci, void* context) {
+    DriftEvents& events = *static_cast<DriftEvents*>(context);
+    (drifting ? events.raised : events.cleared)++;
+    events.slot = slot;
+    events.offset = offsetDeci;
+}
+
+void test_drift_detector_flags_sensor_leaving_its_peers(void) {
+    DriftDetector detector;
+    DriftEvents events = {};
+    detector.setCallback(recordDrift, &events);
+
+    // Four sensors in zone 0 with fixed mounting offsets; slot 2 later drifts
+    // up by 1.5 K and recovers. Zone 1 has too few peers to judge.
+    const int16_t mounting[4] = { 0, -5, 3, 1 };
+    int16_t offsetDuringDrift = 0;
+    for (int r = 0; r < 500; r++) {
+        int16_t room = static_cast<int16_t>(210 + (r / 20) % 5);
+        int16_t drift = 0;
+        if (r >= 175 && r < 330) {
+            drift = static_cast<int16_t>((r - 175) / 5 < 15 ? (r - 175) / 5 : 15);
+        }
+        for (size_t s = 0; s < 4; s++) {
+            int16_t noise = static_cast<int16_t>((r * 7 + s * 3) % 3 - 1);
+            int16_t value = static_cast<int16_t>(room + mounting[s] + noise + ((s == 2) ? drift : 0));
+            detector.update(s, 0, value);
+        }
+        detector.update(10, 1, room);
+        detector.update(11, 1, static_cast<int16_t>(room + 40));
+        if (r == 329) {
+            offsetDuringDrift = detector.getOffset(2);
+            TEST_ASSERT_TRUE(detector.isDrifting(2));
+        }
+    }
+
+    TEST_ASSERT_EQUAL_INT(1, events.raised);
+    TEST_ASSERT_EQUAL_INT(1, events.cleared);
+    TEST_ASSERT_EQUAL_UINT32(2, events.slot);
+    TEST_ASSERT_INT_WITHIN(2, 15, offsetDuringDrift);
+    TEST_ASSERT_EQUAL_UINT32(1, detector.getAlarmCount());
+    TEST_ASSERT_FALSE(detector.isDrifting(2));
+
+    DriftDetector::Status status = detector.getStatus(1);
+    TEST_ASSERT_FALSE(status.learning);
+    TEST_ASSERT_INT_WITHIN(1, -6, status.baselineDeci);    // -5 vs. the mean of 0, 3, 1
+    TEST_ASSERT_EQUAL_UINT32(0, detector.getStatus(11).samples);
+
+    // A failed read leaves the reference; the remaining peers are too few
+    detector.invalidate(0);
+    detector.invalidate(1);
+    TEST_ASSERT_EQUAL_UINT32(500, detector.getStatus(2).samples);
+    detector.update(2, 0, 300);
+    TEST_ASSERT_EQUAL_UINT32(500, detector.getStatus(2).samples);
+}
+
+// ============================================================================
+// Health Trend Tests
+// ============================================================================
+
+struct HealthEvents {
+    int rttRaised;
+    int errorRaised;
+    int cleared;
+    uint32_t rttRaisedAt;
+};
+
+static uint32_t healthRead = 0;
+
+static void recordHealth(size_t slot, HealthWarning warning, bool raised, void* context) {
+    (void)slot;
+    HealthEvents& events = *static_cast<HealthEvents*>(context);
+    if (!raised) {
+        events.cleared++;
+    } else if (warning == HealthWarning::RTT_RISING) {
+        events.rttRaised++;
+        events.rttRaisedAt = healthRead;
+    } else {
+        events.errorRaised++;
+    }
+}
+
+void test_health_monitor_warns_on_rising_rtt_and_errors(void) {
+    HealthMonitor monitor;
+    HealthEvents events = {};
+    monitor.setCallback(recordHealth, &events);
+
+    // Healthy: 60 ms +- 4 ms with a rare failure
+    for (healthRead = 0; healthRead < 400; healthRead++) {
+        monitor.onResult(0, healthRead % 97 != 50, 56 + (healthRead * 5) % 9);
+    }
+    HealthMonitor::Status status = monitor.getStatus(0);
+    TEST_ASSERT_FALSE(status.learning);
+    TEST_ASSERT_UINT32_WITHIN(1, 60, status.baselineRttMs);
+    TEST_ASSERT_FALSE(monitor.hasWarning(0));
+
+    // Terminal corroding: turnaround creeps up 1 ms every 10 reads
+    for (; healthRead < 700; healthRead++) {
+        uint32_t creep = (healthRead - 400) / 10;
+        monitor.onResult(0, true, 56 + (healthRead * 5) % 9 + creep);
+    }
+    TEST_ASSERT_EQUAL_INT(1, events.rttRaised);
+    TEST_ASSERT_TRUE(events.rttRaisedAt < 400 + 300);          // Before +30 ms
+    TEST_ASSERT_TRUE(events.rttRaisedAt > 400 + 60);           // Not on the first ms
+    TEST_ASSERT_EQUAL_INT(0, events.errorRaised);
+
+    // Failures cluster, then the terminal is fixed
+    for (; healthRead < 760; healthRead++) {
+        monitor.onResult(0, healthRead % 5 != 0, 90);
+    }
+    TEST_ASSERT_EQUAL_INT(1, events.errorRaised);
+    for (; healthRead < 1000; healthRead++) {
+        monitor.onResult(0, true, 60);
+    }
+    TEST_ASSERT_EQUAL_INT(2, events.cleared);
+    TEST_ASSERT_FALSE(monitor.hasWarning(0));
+    TEST_ASSERT_EQUAL_UINT32(2, monitor.getWarningCount());
+
+    // A slot that never answers stays in learning without warnings
+    for (int i = 0; i < 100; i++) {
+        monitor.onResult(1, false, 200);
+    }
+    TEST_ASSERT_TRUE(monitor.getStatus(1).learning);
+    TEST_ASSERT_EQUAL_UINT16(1000, monitor.getStatus(1).errorEwmaPermille);
+    TEST_ASSERT_FALSE(monitor.hasWarning(1));
+}
+
+// ============================================================================
+// Directory Tests
+// ============================================================================
+
+void test_directory_resolves_names_and_tags(void) {
+    static const char manifest[] =
+        "# name            bus:address  tags\n"
+        "B2/3.14/north     0:3          floor:3 office critical\n"
+        "B2/3.15/south     0:4          floor:3 office\n"
+        "B2/4.01/lab       1:3          floor:4\n"
+        "\n"
+        "B1/lobby          9            # no tags\n";
+
+    SensorDirectory directory;
+    TEST_ASSERT_TRUE(directory.load(manifest));
+    TEST_ASSERT_EQUAL_UINT32(4, directory.size());
+
+    int north = directory.find("B2/3.14/north");
+    TEST_ASSERT_TRUE(north >= 0);
+    TEST_ASSERT_EQUAL_UINT8(3, directory.getEntry(north).address);
+    TEST_ASSERT_EQUAL_UINT16(0, directory.getEntry(north).bus);
+    TEST_ASSERT_EQUAL_UINT16(1, directory.getEntry(directory.find("B2/4.01/lab")).bus);
+    TEST_ASSERT_EQUAL_INT(-1, directory.find("B2/3.14/nort"));
+    TEST_ASSERT_EQUAL_INT(-1, directory.find("B3/lobby"));
+
+    ANDRTF3 sensor(3);
+    TEST_ASSERT_TRUE(directory.bind(north, &sensor));
+    TEST_ASSERT_TRUE(directory.getSensor("B2/3.14/north") == &sensor);
+
+    uint32_t bits[1];
+    const char* floor3Office[] = { "floor:3", "office" };
+    TEST_ASSERT_EQUAL_UINT32(2, directory.select(floor3Office, 2, bits));
+    TEST_ASSERT_TRUE(bits[0] & (1UL << north));
+    const char* building[] = { "B2" };                   // Prefix tag
+    TEST_ASSERT_EQUAL_UINT32(3, directory.select(building, 1, bits));
+    const char* everything[] = { "floor:3", "nope" };
+    TEST_ASSERT_EQUAL_UINT32(0, directory.select(everything, 2, bits));
+
+    // Duplicate names are rejected with the line number
+    TEST_ASSERT_FALSE(directory.load("a 1\nb 2\na 3\n"));
+    TEST_ASSERT_EQUAL_UINT32(3, directory.getErrorLine());
+}
+
+void test_perfect_hash_is_collision_free(void) {
+    static char names[1000][16];
+    const char* keys[1000];
+    for (size_t i = 0; i < 1000; i++) {
+        snprintf(names[i], sizeof(names[i]), "F%u/R%u/s%u", static_cast<unsigned>(i / 100),
+                 static_cast<unsigned>(i % 100), static_cast<unsigned>(i % 7));
+        keys[i] = names[i];
+    }
+    PerfectHash hash;
+    TEST_ASSERT_TRUE(hash.build(keys, 1000));
+
+    static bool used[1000];
+    memset(used, 0, sizeof(used));
+    for (size_t i = 0; i < 1000; i++) {
+        size_t slot = hash.slot(keys[i], strlen(keys[i]));
+        TEST_ASSERT_TRUE(slot < 1000);
+        TEST_ASSERT_FALSE(used[slot]);
+        used[slot] = true;
+    }
+}
+
+// ============================================================================
+// Transport Tests
+// ============================================================================
+
+void test_rtu_crc_and_response_parsing(void) {
+    uint8_t request[rtu::READ_REQUEST_BYTES];
+    rtu::buildReadRequest(1, 0x04, 50, 1, request);
+    const uint8_t expected[] = { 0x01, 0x04, 0x00, 0x32, 0x00, 0x01, 0x90, 0x05 };
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, request, sizeof(expected));
+
+    uint8_t response[] = { 0x03, 0x04, 0x02, 0x00, 0xD7, 0x00, 0x00 };
+    uint16_t crc = rtu::crc16(response, 5);
+    response[5] = static_cast<uint8_t>(crc & 0xFF);
+    response[6] = static_cast<uint8_t>(crc >> 8);
+    TEST_ASSERT_EQUAL_UINT32(7, rtu::responseLength(response, 3));
+
+    uint16_t value = 0;
+    TEST_ASSERT_TRUE(rtu::parseReadResponse(response, 7, 3, 0x04, 1, &value) == ModbusError::SUCCESS);
+    TEST_ASSERT_EQUAL_UINT16(215, value);
+    TEST_ASSERT_TRUE(rtu::parseReadResponse(response, 7, 4, 0x04, 1, &value) == ModbusError::INVALID_RESPONSE);
+    response[4] ^= 0x01;
+    TEST_ASSERT_TRUE(rtu::parseReadResponse(response, 7, 3, 0x04, 1, &value) == ModbusError::CRC_ERROR);
+
+    uint8_t exception[] = { 0x03, 0x84, 0x02, 0x00, 0x00 };
+    crc = rtu::crc16(exception, 3);
+    exception[3] = static_cast<uint8_t>(crc & 0xFF);
+    exception[4] = static_cast<uint8_t>(crc >> 8);
+    TEST_ASSERT_EQUAL_UINT32(rtu::EXCEPTION_BYTES, rtu::responseLength(exception, 2));
+    TEST_ASSERT_TRUE(rtu::parseReadResponse(exception, 5, 3, 0x04, 1, &value) == ModbusError::ILLEGAL_DATA_ADDRESS);
+}
+
+#if defined(__linux__)
+#include <unistd.h>
+#include <fcntl.h>
+
+void test_rtu_tcp_loopback_pipelines_and_resyncs(void) {
+    RtuTcpEmulator server;
+    TEST_ASSERT_TRUE(server.start());
+    for (uint8_t unit = 1; unit <= 8; unit++) {
+        server.setRegister(unit, 50, static_cast<uint16_t>(200 + unit));
+    }
+    server.setSilent(6, true);
+
+    // The emulator queues requests like a gateway-mode server
+    RtuTcpTransport::Config config = RtuTcpTransport::getDefaultConfig();
+    TEST_ASSERT_EQUAL_UINT8(1, config.maxInFlight);
+    config.maxInFlight = 4;
+    RtuTcpTransport transport("127.0.0.1", server.getPort(), config);
+    ANDRTF3 sensor(3);
+    sensor.setTransport(&transport);
+    TEST_ASSERT_TRUE(sensor.readTemperature());
+    TEST_ASSERT_EQUAL_INT16(203, sensor.getTemperature());
+
+    // One connection, requests queued back to back; unit 6 never answers
+    uint16_t values[8] = {};
+    RtuTcpTransport::Request batch[8];
+    for (uint8_t i = 0; i < 8; i++) {
+        batch[i] = { static_cast<uint8_t>(i + 1), 0x04, 50, 1, &values[i], ModbusError::SUCCESS };
+    }
+    TEST_ASSERT_EQUAL_UINT32(7, transport.readBatch(batch, 8, 50));
+    TEST_ASSERT_TRUE(batch[5].result == ModbusError::TIMEOUT);
+    TEST_ASSERT_EQUAL_UINT16(208, values[7]);
+
+    // Unit 7 answering first proves unit 6 timed out; the connection stays usable
+    RtuTcpTransport::Stats stats = transport.getStats();
+    TEST_ASSERT_EQUAL_UINT32(1, stats.connects);
+    TEST_ASSERT_EQUAL_UINT32(1, stats.timeouts);
+    TEST_ASSERT_EQUAL_UINT32(4, stats.maxPipelined);
+
+    // Unknown register: Modbus exception, connection kept
+    uint16_t value = 0;
+    TEST_ASSERT_TRUE(transport.readInputRegisters(1, 51, 1, &value, 50) == ModbusError::ILLEGAL_DATA_ADDRESS);
+    TEST_ASSERT_TRUE(transport.isConnected());
+
+    // A timeout with nothing behind it: reconnect before the next request
+    TEST_ASSERT_TRUE(transport.readInputRegisters(6, 50, 1, &value, 50) == ModbusError::TIMEOUT);
+    TEST_ASSERT_FALSE(transport.isConnected());
+    TEST_ASSERT_TRUE(transport.readInputRegisters(2, 50, 1, &value, 50) == ModbusError::SUCCESS);
+    TEST_ASSERT_EQUAL_UINT32(2, transport.getStats().connects);
+    server.stop();
+}
+
+struct GatewayTally {
+    std::atomic<uint32_t> valid{0};
+    std::atomic<uint32_t> invalid{0};
+    std::atomic<uint32_t> timeouts{0};
+    std::atomic<uint32_t> outOfOrder{0};
+    uint32_t lastMs[2] = {0, 0};       // Per bus; each bus stays on one worker
+};
+
+static void tallyReading(const GatewayReading& reading, void* context) {
+    GatewayTally& tally = *static_cast<GatewayTally*>(context);
+    if (reading.timestampMs < tally.lastMs[reading.bus]) {
+        tally.outOfOrder++;
+    }
+    tally.lastMs[reading.bus] = reading.timestampMs;
+    if (reading.error == ModbusError::TIMEOUT) {
+        tally.timeouts++;
+    } else if (reading.valid && reading.celsius == 215) {
+        tally.valid++;
+    } else {
+        tally.invalid++;
+    }
+}
+
+void test_gateway_multiplexes_buses_on_one_loop(void) {
+    RtuTcpEmulator segmentA, segmentB;
+    TEST_ASSERT_TRUE(segmentA.start());
+    TEST_ASSERT_TRUE(segmentB.start());
+    segmentA.setRegister(3, 50, 215);
+    segmentB.setRegister(4, 50, 0x0000);            // Sensor fault code
+    segmentB.setRegister(5, 50, 215);
+    segmentB.setSilent(5, true);
+
+    Gateway::Config config = Gateway::getDefaultConfig();
+    config.timeoutMs = 20;
+    Gateway gateway(config);
+    GatewayTally tally;
+    gateway.setSink(tallyReading, &tally);
+    int a = gateway.addTcpBus("127.0.0.1", segmentA.getPort());
+    int b = gateway.addTcpBus("127.0.0.1", segmentB.getPort());
+    TEST_ASSERT_TRUE(gateway.addSensor(a, 3, 10));
+    TEST_ASSERT_TRUE(gateway.addSensor(b, 4, 10));
+    TEST_ASSERT_TRUE(gateway.addSensor(b, 5, 10));
+
+    TEST_ASSERT_TRUE(gateway.start());
+    usleep(300000);
+    gateway.stop();
+
+    Gateway::Stats stats = gateway.getStats();
+    TEST_ASSERT_TRUE(tally.valid.load() >= 5);
+    TEST_ASSERT_TRUE(tally.invalid.load() >= 2);
+    TEST_ASSERT_TRUE(tally.timeouts.load() >= 2);
+    TEST_ASSERT_EQUAL_UINT32(0, tally.outOfOrder.load());
+    TEST_ASSERT_TRUE(stats.published == stats.responses + stats.timeouts);
+    TEST_ASSERT_TRUE(stats.invalidValues >= 2);
+    TEST_ASSERT_TRUE(stats.reconnects >= 1);        // Timeouts reopen TCP buses
+}
+
+void test_gateway_unstarted_destroy_keeps_fds(void) {
+    if (fcntl(0, F_GETFD) < 0) {
+        TEST_ASSERT_EQUAL_INT(0, open("/dev/null", O_RDONLY));   // Lowest free fd
+    }
+    {
+        Gateway gateway;
+        TEST_ASSERT_TRUE(gateway.addTcpBus("127.0.0.1", 1502) >= 0);
+    }
+    // No bus was ever opened, so destruction must not close descriptor 0
+    TEST_ASSERT_TRUE(fcntl(0, F_GETFD) >= 0);
+}
+
+struct StageOrder {
+    uint32_t lastSeq[256];              // Per sensor: only touched by one worker at a time
+    std::atomic<uint32_t> seen{0};
+    std::atomic<uint32_t> outOfOrder{0};
+};
+
+static void checkOrderStage(const GatewayReading& reading, void* context) {
+    StageOrder& order = *static_cast<StageOrder*>(context);
+    if (reading.timestampMs != order.lastSeq[reading.address] + 1) {
+        order.outOfOrder++;
+    }
+    order.lastSeq[reading.address] = reading.timestampMs;
+    order.seen++;
+}
+
+void test_stage_executor_keeps_per_sensor_order(void) {
+    StageExecutor::Config config = StageExecutor::getDefaultConfig();
+    config.workers = 4;
+    config.shards = 16;                 // Several sensors per mailbox
+    config.mailboxDepth = 4096;
+    config.batch = 8;
+    StageExecutor executor(config);
+    StageOrder order = {};
+    TEST_ASSERT_TRUE(executor.addStage(checkOrderStage, &order));
+    TEST_ASSERT_TRUE(executor.start());
+
+    GatewayReading reading = {};
+    for (uint32_t seq = 1; seq <= 200; seq++) {
+        for (uint8_t address = 1; address <= 64; address++) {
+            reading.address = address;
+            reading.timestampMs = seq;
+            TEST_ASSERT_TRUE(executor.submit(reading));
+        }
+    }
+    executor.drain();
+
+    TEST_ASSERT_EQUAL_UINT32(64 * 200, order.seen.load());
+    TEST_ASSERT_EQUAL_UINT32(0, order.outOfOrder.load());
+    executor.stop();
+    TEST_ASSERT_EQUAL_UINT32(64 * 200, executor.getStats().executed);
+    TEST_ASSERT_FALSE(executor.submit(reading));
+}
+#endif
+
+// ============================================================================
+// History File Tests
+// ============================================================================
+
+#if defined(__linux__)
+static void countRecord(const history::Record& record, void* context) {
+    (void)record;
+    (*static_cast<size_t*>(context))++;
+}
+
+void test_history_commit_recovery_and_scan(void) {
+    const char* path = "/tmp/andrtf3_history_test.bin";
+    unlink(path);
+
+    const size_t total = history::RECORDS_PER_BLOCK * 2 + 10;   // Three blocks
+    {
+        HistoryWriter writer;
+        TEST_ASSERT_TRUE(writer.open(path, 1));
+        for (uint32_t t = 0; t < total; t++) {
+            TEST_ASSERT_TRUE(writer.append(1000 + t, 3, static_cast<int16_t>(t), true));
+        }
+        TEST_ASSERT_FALSE(writer.append(999, 3, 0, true));         // Time went backwards
+        TEST_ASSERT_TRUE(writer.commit());
+        writer.append(5000, 3, 0, true);                           // Never committed
+        writer.append(5001, 3, 0, true);
+    }
+
+    HistoryWriter reopened;
+    TEST_ASSERT_TRUE(reopened.open(path, 1));
+    TEST_ASSERT_EQUAL_UINT64(total, reopened.getCommittedCount());
+    TEST_ASSERT_TRUE(reopened.append(3000, 4, 7, true));
+    TEST_ASSERT_TRUE(reopened.commit());
+
+    HistoryReader reader;
+    TEST_ASSERT_TRUE(reader.open(path));
+    TEST_ASSERT_EQUAL_UINT64(total + 1, reader.getRecordCount());
+    TEST_ASSERT_EQUAL_UINT32(3, reader.getBlockCount());
+    TEST_ASSERT_EQUAL_UINT32(1, reader.findBlock(1000 + history::RECORDS_PER_BLOCK + 5));
+
+    size_t visited = 0;
+    TEST_ASSERT_EQUAL_UINT32(100, reader.scan(1500, 1600, countRecord, &visited));
+    TEST_ASSERT_EQUAL_UINT32(100, visited);
+    TEST_ASSERT_EQUAL_UINT32(1, reader.scan(3000, 4000, nullptr, nullptr));
+
+    unlink(path);
+}
+
+void test_history_downsample_keeps_shape(void) {
+    const char* path = "/tmp/andrtf3_history_chart.bin";
+    unlink(path);
+
+    // Slow triangle wave for address 3 with one spike, interleaved with address 4
+    const uint32_t count = 2000;
+    {
+        HistoryWriter writer;
+        TEST_ASSERT_TRUE(writer.open(path, 1));
+        for (uint32_t i = 0; i < count; i++) {
+            int16_t wave = static_cast<int16_t>(200 + ((i % 400) < 200 ? (i % 400) : 400 - (i % 400)) / 4);
+            TEST_ASSERT_TRUE(writer.append(10000 + i * 5, 3, (i == 1234) ? 900 : wave, true));
+            TEST_ASSERT_TRUE(writer.append(10000 + i * 5 + 1, 4, -50, true));
+            TEST_ASSERT_TRUE(writer.append(10000 + i * 5 + 2, 5, (i > 0 && i < 10) ? 0 : 300, true));
+        }
+        TEST_ASSERT_TRUE(writer.append(10000 + count * 5, 3, 0, false));   // Invalid: ignored
+        TEST_ASSERT_TRUE(writer.commit(false));
+    }
+
+    HistoryReader reader;
+    TEST_ASSERT_TRUE(reader.open(path));
+    const uint32_t from = 10000;
+    const uint32_t to = 10000 + count * 5 + 1;
+    history::ChartPoint points[64];
+
+    size_t n = reader.downsample(3, from, to, history::Downsample::LTTB, points, 50);
+    TEST_ASSERT_TRUE(n > 40 && n <= 50);
+    TEST_ASSERT_EQUAL_UINT32(from, points[0].timestamp);
+    TEST_ASSERT_EQUAL_UINT32(10000 + (count - 1) * 5, points[n - 1].timestamp);
+    bool spike = false;
+    for (size_t i = 0; i < n; i++) {
+        spike = spike || (points[i].celsius == 900 && points[i].timestamp == 10000 + 1234 * 5);
+        if (i > 0) {
+            TEST_ASSERT_TRUE(points[i].timestamp > points[i - 1].timestamp);
+        }
+    }
+    TEST_ASSERT_TRUE(spike);
+
+    // A range opening before the data still starts at the first reading,
+    // even when a dip right after it would win against a zero anchor
+    n = reader.downsample(5, from - 5000, to, history::Downsample::LTTB, points, 50);
+    TEST_ASSERT_TRUE(n > 30 && n <= 50);
+    TEST_ASSERT_EQUAL_UINT32(from + 2, points[0].timestamp);
+    TEST_ASSERT_EQUAL_INT16(300, points[0].celsius);
+
+    n = reader.downsample(3, from, to, history::Downsample::MIN_MAX, points, 50);
+    TEST_ASSERT_TRUE(n > 40 && n <= 50);
+    int16_t lo = INT16_MAX;
+    int16_t hi = INT16_MIN;
+    for (size_t i = 0; i < n; i++) {
+        lo = (points[i].celsius < lo) ? points[i].celsius : lo;
+        hi = (points[i].celsius > hi) ? points[i].celsius : hi;
+        if (i > 0) {
+            TEST_ASSERT_TRUE(points[i].timestamp > points[i - 1].timestamp);
+        }
+    }
+    TEST_ASSERT_EQUAL_INT16(200, lo);
+    TEST_ASSERT_EQUAL_INT16(900, hi);
+
+    // MIN_MAX needs room for both extremes of a bucket
+    points[1].celsius = 12345;
+    TEST_ASSERT_EQUAL_UINT32(0, reader.downsample(3, from, to, history::Downsample::MIN_MAX, points, 1));
+    TEST_ASSERT_EQUAL_INT16(12345, points[1].celsius);
+    points[3].celsius = 12345;
+    n = reader.downsample(3, from, to, history::Downsample::MIN_MAX, points, 3);
+    TEST_ASSERT_TRUE(n >= 1 && n <= 3);
+    TEST_ASSERT_EQUAL_INT16(12345, points[3].celsius);
+
+    // Short ranges come back unreduced
+    n = reader.downsample(4, from, from + 100, history::Downsample::LTTB, points, 64);
+    TEST_ASSERT_EQUAL_UINT32(20, n);
+    TEST_ASSERT_EQUAL_INT16(-50, points[19].celsius);
+    TEST_ASSERT_EQUAL_UINT32(0, reader.downsample(9, from, to, history::Downsample::LTTB, points, 64));
+
+    unlink(path);
+}
+#endif
+
 // ============================================================================
 // Test Runner
 // ============================================================================
@@ -312,6 +1809,92 @@ void runAllTests() {
     RUN_TEST(test_boundary_freezing_point);
     RUN_TEST(test_boundary_boiling_point);
 
+    // Scheduler tests
+    RUN_TEST(test_round_robin_cycles_due_sensors);
+    RUN_TEST(test_edf_picks_earliest_deadline);
+    RUN_TEST(test_priority_lane_serves_critical_first);
+    RUN_TEST(test_adaptive_rate_stretches_stable_sensor);
+    RUN_TEST(test_profiled_sweep_orders_fast_first_and_interleaves_zones);
+    RUN_TEST(test_gap_tuner_frame_gap);
+    RUN_TEST(test_gap_tuner_shrinks_then_falls_back);
+    RUN_TEST(test_gap_tuner_timeout_backs_off_after_timeouts);
+    RUN_TEST(test_simulator_is_deterministic);
+
+    // Group tests
+    RUN_TEST(test_group_assigns_bits_and_times_out);
+    RUN_TEST(test_group_reports_published_reading_and_drops_destroyed_member);
+    RUN_TEST(test_group_refuses_sensor_of_another_group);
+
+    // Response pump tests
+    RUN_TEST(test_pump_dispatches_only_notified_sensors);
+    RUN_TEST(test_destroyed_sensor_leaves_pump_and_poller);
+
+    // Request correlation tests
+    RUN_TEST(test_unsolicited_response_is_discarded_and_counted);
+
+    // Queued read tests
+    RUN_TEST(test_queued_read_expires_or_is_cancelled);
+
+    // Value verification tests
+    RUN_TEST(test_suspect_value_is_verified_in_next_slot);
+    RUN_TEST(test_failed_or_late_verification_returns_to_schedule);
+
+    // Shared bus tests
+    RUN_TEST(test_shared_bus_serves_slots_from_one_queue);
+#if defined(__linux__)
+    RUN_TEST(test_concurrent_requests_keep_latest_deadline);
+#endif
+
+    // Retained state tests
+    RUN_TEST(test_retained_state_restores_after_soft_reset);
+    RUN_TEST(test_retained_state_saved_once_per_read);
+
+    // Memory placement tests
+    RUN_TEST(test_memory_policy_places_cold_state);
+
+    // Flash write tests
+#if !defined(ESP_PLATFORM)
+    RUN_TEST(test_readings_publish_during_flash_writes);
+#endif
+
+    // Device instance tests
+    RUN_TEST(test_device_instance_reports_no_data_before_first_read);
+    RUN_TEST(test_device_instance_invalid_reading_clears_data_ready);
+
+    // Snapshot tests
+    RUN_TEST(test_snapshot_publish_and_read);
+
+    // Aggregation tests
+    RUN_TEST(test_aggregate_kernel_matches_scalar);
+
+    // Lag compensation tests
+    RUN_TEST(test_lag_compensator_learns_tau_and_leads_raw);
+    RUN_TEST(test_characterizer_fits_emulated_step);
+
+    // Drift detection tests
+    RUN_TEST(test_drift_detector_flags_sensor_leaving_its_peers);
+
+    // Health trend tests
+    RUN_TEST(test_health_monitor_warns_on_rising_rtt_and_errors);
+
+    // Directory tests
+    RUN_TEST(test_directory_resolves_names_and_tags);
+    RUN_TEST(test_perfect_hash_is_collision_free);
+
+    // Transport tests
+    RUN_TEST(test_rtu_crc_and_response_parsing);
+
+#if defined(__linux__)
+    RUN_TEST(test_rtu_tcp_loopback_pipelines_and_resyncs);
+    RUN_TEST(test_gateway_multiplexes_buses_on_one_loop);
+    RUN_TEST(test_gateway_unstarted_destroy_keeps_fds);
+    RUN_TEST(test_stage_executor_keeps_per_sensor_order);
+
+    // History tests
+    RUN_TEST(test_history_commit_recovery_and_scan);
+    RUN_TEST(test_history_downsample_keeps_shape);
+#endif
+
     UNITY_END();
 }
 